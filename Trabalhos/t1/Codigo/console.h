@@ -12,7 +12,10 @@
 typedef struct console_t console_t;
 
 // cria e inicializa a console
-console_t *console_cria(void);
+// se 'com_tela' for false, a console não usa a tela (curses): nada é desenhado,
+//   as mensagens vão só para o arquivo de log e os comandos do operador são
+//   lidos da entrada padrão, sem bloquear
+console_t *console_cria(bool com_tela);
 
 // destrói a console
 void console_destroi(console_t *self);
@@ -20,6 +23,36 @@ void console_destroi(console_t *self);
 // imprime na área geral do console
 int console_printf(char *fmt, ...);
 
+// níveis das mensagens, do mais para o menos importante
+typedef enum {
+  NIVEL_ERRO,       // problemas
+  NIVEL_INFO,       // acontecimentos importantes (criação de processos, etc)
+  NIVEL_DEPURACAO,  // funcionamento interno (escalonamento, chamadas, etc)
+  NIVEL_DETALHE,    // o que acontece a cada interrupção, para cada processo
+  N_NIVEL
+} console_nivel_t;
+
+// nível máximo das mensagens impressas por console_log (use
+//   console_define_nivel para alterar)
+extern console_nivel_t console_nivel;
+
+// imprime na área geral do console, como console_printf, se o nível da
+//   mensagem estiver habilitado
+// o nível é testado antes de avaliar os argumentos ou formatar a mensagem,
+//   uma mensagem desabilitada custa só o teste
+#define console_log(nivel, ...) \
+  do { \
+    if ((nivel) <= console_nivel) console_printf(__VA_ARGS__); \
+  } while (0)
+
+// altera o nível máximo das mensagens impressas (o mesmo que o comando 'V'
+//   do operador); o nível inicial é NIVEL_INFO
+void console_define_nivel(console_nivel_t nivel);
+
+// coloca em *pnivel o nível com o nome (erro, info, depuracao, detalhe) ou
+//   o número 'nome'; retorna false se não existir
+bool console_nivel_por_nome(char *nome, console_nivel_t *pnivel);
+
 // imprime na linha de status
 void console_print_status(console_t *self, char *txt);
 
@@ -38,6 +71,15 @@ char console_comando_externo(console_t *self);
 terminal_t *console_terminal(console_t *self, char id_terminal);
 
 // esta função deve ser chamada periodicamente para que tela funcione
+// a tela é desenhada no máximo FPS_MAX vezes por segundo, e só as partes que
+//   mudaram desde o desenho anterior
 void console_tictac(console_t *self);
 
+// avança os terminais (rolagem e limpeza da saída) em n tictacs, sem ler o
+//   teclado nem mexer na tela (o que console_tictac faz a mais)
+void console_tictac_terminais(console_t *self, int n);
+// retorna quantos tictacs faltam até algum terminal pedir interrupção, ou 0
+//   se nenhum vai pedir (ver terminal_tempo_ate_interrupcao)
+int console_tempo_ate_interrupcao(console_t *self);
+
 #endif // CONSOLE_H
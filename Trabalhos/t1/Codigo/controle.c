@@ -10,27 +10,48 @@
 #include <stdio.h>
 #include <assert.h>
 
+// número de instruções entre verificações dos comandos do operador no modo lote
+#define LOTE_COMANDOS 1000
+
 struct controle_t {
-  cpu_t *cpu;
-  relogio_t *relogio;
+  // a CPU, o relógio e o controlador de interrupções de cada núcleo
+  int n_nucleos;
+  cpu_t *cpu[IRQ_MAX_NUCLEOS];
+  relogio_t *relogio[IRQ_MAX_NUCLEOS];
+  pic_t *pic[IRQ_MAX_NUCLEOS];
   console_t *console;
   enum { executando, passo, parado, fim } estado;
+  controle_modo_t modo;
+  // tempo (pelo relógio) que as CPUs passaram paradas, esperando
+  //   interrupção (somado em todos os núcleos)
+  int t_parada;
 };
 
 // funções auxiliares
+static void controle_laco_interativo(controle_t *self);
+static void controle_laco_lote(controle_t *self);
+static void controle_executa_1(controle_t *self);
+static void controle_interrompe_nucleos(controle_t *self);
+static bool controle_todas_paradas(controle_t *self);
+static int controle_tempo_ocioso(controle_t *self);
+static void controle_avanca_parada(controle_t *self, int n);
+static bool controle_maquina_inerte(controle_t *self);
 static void controle_processa_comandos_da_console(controle_t *self);
 static void controle_atualiza_estado_na_console(controle_t *self);
 
 
-controle_t *controle_cria(cpu_t *cpu, console_t *console, relogio_t *relogio)
+controle_t *controle_cria(cpu_t *cpu, console_t *console, relogio_t *relogio,
+                          pic_t *pic)
 {
   controle_t *self = malloc(sizeof(*self));
   assert(self != NULL);
 
-  self->cpu = cpu;
+  self->n_nucleos = 0;
+  controle_adiciona_nucleo(self, cpu, relogio, pic);
   self->console = console;
-  self->relogio = relogio;
   self->estado = parado;
+  self->modo = controle_interativo;
+  self->t_parada = 0;
 
   return self;
 }
@@ -40,32 +61,169 @@ void controle_destroi(controle_t *self)
   free(self);
 }
 
+void controle_adiciona_nucleo(controle_t *self, cpu_t *cpu, relogio_t *relogio,
+                              pic_t *pic)
+{
+  assert(self->n_nucleos < IRQ_MAX_NUCLEOS);
+  int n = self->n_nucleos++;
+  self->cpu[n] = cpu;
+  self->relogio[n] = relogio;
+  self->pic[n] = pic;
+}
+
+void controle_define_modo(controle_t *self, controle_modo_t modo)
+{
+  self->modo = modo;
+  if (modo == controle_lote) {
+    self->estado = executando;
+  }
+}
+
 void controle_laco(controle_t *self)
+{
+  if (self->modo == controle_interativo) {
+    controle_laco_interativo(self);
+  } else {
+    controle_laco_lote(self);
+  }
+
+  console_printf("Fim da execução.");
+  console_printf("relógio: %d\n", relogio_agora(self->relogio[0]));
+  console_printf("tempo com a CPU parada: %d", self->t_parada);
+  if (self->modo == controle_lote) {
+    // não tem tela, o relatório vai para a saída padrão
+    printf("relógio: %d\n", relogio_agora(self->relogio[0]));
+  }
+}
+
+static void controle_laco_interativo(controle_t *self)
 {
   // executa uma instrução por vez até a console dizer que chega
   do {
     if (self->estado == passo || self->estado == executando) {
-      cpu_executa_1(self->cpu);
-      relogio_tictac(self->relogio);
-
+      controle_executa_1(self);
       if (self->estado == passo) self->estado = parado;
-
-      // enquanto não tem controlador de interrupção, fala direto com o relógio
-      // o dispositivo 3 do relógio contém 1 se o timer expirou
-      int tem_int;
-      relogio_leitura(self->relogio, 3, &tem_int);
-      if (tem_int != 0) {
-        cpu_interrompe(self->cpu, IRQ_RELOGIO);
-      }
     }
     console_tictac(self->console);
 
     controle_processa_comandos_da_console(self);
     controle_atualiza_estado_na_console(self);
   } while (self->estado != fim);
+}
 
-  console_printf("Fim da execução.");
-  console_printf("relógio: %d\n", relogio_agora(self->relogio));
+static void controle_laco_lote(controle_t *self)
+{
+  // os terminais avançam a cada instrução, como no modo interativo, para que
+  //   o SO veja a E/S com a mesma temporização; só os comandos do operador
+  //   são verificados mais raramente
+  // com as CPUs paradas esperando um dispositivo, o tempo avança de uma vez até
+  //   o próximo evento, em vez de uma iteração por instrução
+  int instrucoes = 0;
+  do {
+    if (self->estado == passo || self->estado == executando) {
+      int ocioso = controle_tempo_ocioso(self);
+      if (ocioso > 0) {
+        controle_avanca_parada(self, ocioso);
+      } else {
+        controle_executa_1(self);
+        console_tictac_terminais(self->console, 1);
+      }
+      if (self->estado == passo) self->estado = parado;
+      if (controle_maquina_inerte(self)) {
+        console_printf("CPU parada sem interrupção pendente");
+        self->estado = fim;
+      }
+    }
+    if (++instrucoes % LOTE_COMANDOS == 0 || self->estado != executando) {
+      controle_processa_comandos_da_console(self);
+    }
+  } while (self->estado != fim);
+}
+
+// executa uma instrução em cada núcleo, avança os relógios e verifica se
+//   algum dispositivo pede interrupção
+static void controle_executa_1(controle_t *self)
+{
+  for (int n = 0; n < self->n_nucleos; n++) {
+    if (cpu_parada(self->cpu[n])) self->t_parada++;
+    cpu_executa_1(self->cpu[n]);
+  }
+  for (int n = 0; n < self->n_nucleos; n++) {
+    relogio_tictac(self->relogio[n]);
+  }
+  controle_interrompe_nucleos(self);
+}
+
+// os dispositivos (e os outros núcleos) pedem pelo controlador de
+//   interrupções de cada núcleo, que escolhe a linha; a interrupção que não
+//   for aceita continua pedida, e é tentada de novo após a próxima instrução
+static void controle_interrompe_nucleos(controle_t *self)
+{
+  for (int n = 0; n < self->n_nucleos; n++) {
+    int irq = pic_irq_pendente(self->pic[n]);
+    if (irq != -1) {
+      cpu_interrompe(self->cpu[n], irq);
+    }
+  }
+}
+
+// retorna true se todas as CPUs estão paradas e nenhuma tem interrupção
+//   pendente
+static bool controle_todas_paradas(controle_t *self)
+{
+  for (int n = 0; n < self->n_nucleos; n++) {
+    if (!cpu_parada(self->cpu[n]) || pic_irq_pendente(self->pic[n]) != -1) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// retorna quanto tempo as CPUs vão ficar paradas até o próximo evento de um
+//   dispositivo (o timer de um núcleo expirar ou um terminal pedir
+//   interrupção), ou 0 se alguma não está parada, se já tem interrupção
+//   pendente ou se nenhum dispositivo vai pedir (nesses casos, executa-se
+//   uma instrução por vez)
+static int controle_tempo_ocioso(controle_t *self)
+{
+  if (!controle_todas_paradas(self)) return 0;
+  int tempo = console_tempo_ate_interrupcao(self->console);
+  for (int n = 0; n < self->n_nucleos; n++) {
+    int timer;
+    relogio_leitura(self->relogio[n], 2, &timer);
+    if (timer > 0 && (tempo == 0 || timer < tempo)) tempo = timer;
+  }
+  return tempo;
+}
+
+// avança n unidades de tempo com as CPUs paradas, com o mesmo efeito de n
+//   chamadas a controle_executa_1 seguidas de console_tictac_terminais: o
+//   timer expira (e a interrupção é pedida à CPU) antes de os terminais
+//   avançarem, e o pedido de um terminal só é entregue na instrução seguinte
+// o tempo parado é contado no relógio como sempre, e o SO o vê como tempo
+//   ocioso
+static void controle_avanca_parada(controle_t *self, int n)
+{
+  self->t_parada += n * self->n_nucleos;
+  for (int nucleo = 0; nucleo < self->n_nucleos; nucleo++) {
+    relogio_avanca(self->relogio[nucleo], n);
+  }
+  controle_interrompe_nucleos(self);
+  console_tictac_terminais(self->console, n);
+}
+
+// retorna true se as CPUs estão paradas, nem os relógios nem os terminais
+//   vão gerar interrupção e não tem nenhuma pendente (a única coisa que pode
+//   tirar uma CPU desse estado) -- nada mais vai acontecer
+static bool controle_maquina_inerte(controle_t *self)
+{
+  if (!controle_todas_paradas(self)) return false;
+  for (int n = 0; n < self->n_nucleos; n++) {
+    int timer;
+    relogio_leitura(self->relogio[n], 2, &timer);
+    if (timer != 0) return false;
+  }
+  return console_tempo_ate_interrupcao(self->console) == 0;
 }
  
 
@@ -90,13 +248,20 @@ static void controle_processa_comandos_da_console(controle_t *self)
 
 static void controle_atualiza_estado_na_console(controle_t *self)
 {
-  char status[100];
+  char status[200];
   switch (self->estado) {
     case fim:        strcpy(status, "FIM    | "); break;
     case parado:     strcpy(status, "PARADO | "); break;
     case executando: strcpy(status, "EXEC   | "); break;
     case passo:      strcpy(status, "PASSO  | "); break;
   }
-  cpu_concatena_descricao(self->cpu, status);
+  cpu_concatena_descricao(self->cpu[0], status);
+  // dos outros núcleos, mostra só se estão parados (a linha não tem espaço
+  //   para os registradores de todos)
+  for (int n = 1; n < self->n_nucleos; n++) {
+    char aux[20];
+    sprintf(aux, " | %d:%s", n, cpu_parada(self->cpu[n]) ? "parado" : "exec");
+    strcat(status, aux);
+  }
   console_print_status(self->console, status);
 }
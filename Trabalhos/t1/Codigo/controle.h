@@ -11,10 +11,36 @@ typedef struct controle_t controle_t;
 #include "cpu.h"
 #include "console.h"
 #include "relogio.h"
+#include "pic.h"
 
-controle_t *controle_cria(cpu_t *cpu, console_t *console, relogio_t *relogio);
+// modos de funcionamento do laço principal
+typedef enum {
+  // a console é atualizada e os comandos do operador são atendidos após
+  //   cada instrução (é o modo inicial)
+  controle_interativo,
+  // sem operador: a execução começa sem esperar comando, os comandos (da
+  //   entrada padrão) só são verificados de tempos em tempos, e a simulação
+  //   termina sozinha quando as CPUs estiverem paradas e os timers
+  //   desligados
+  controle_lote,
+} controle_modo_t;
+
+// cria o controlador com um núcleo (o núcleo 0): a CPU, o seu relógio e o
+//   seu controlador de interrupções
+controle_t *controle_cria(cpu_t *cpu, console_t *console, relogio_t *relogio,
+                          pic_t *pic);
 void controle_destroi(controle_t *self);
 
+// acrescenta mais um núcleo, que executa em paralelo com os outros: a cada
+//   passo da simulação, cada núcleo executa uma instrução (em ordem de
+//   número), depois os relógios (que andam juntos) avançam, e então cada
+//   núcleo recebe a interrupção pedida ao seu controlador, se houver
+void controle_adiciona_nucleo(controle_t *self, cpu_t *cpu, relogio_t *relogio,
+                              pic_t *pic);
+
+// define o modo de funcionamento do laço principal
+void controle_define_modo(controle_t *self, controle_modo_t modo);
+
 // o laço principal da simulação
 void controle_laco(controle_t *self);
 
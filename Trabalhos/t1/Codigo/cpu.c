@@ -7,6 +7,7 @@
 #include "cpu.h"
 #include "err.h"
 #include "instrucao.h"
+#include "rastro.h"
 
 #include <stdbool.h>
 #include <stdlib.h>
@@ -28,6 +29,10 @@ struct cpu_t {
   // acesso a dispositivos externos
   mem_t *mem;
   es_t *es;
+  // núcleo desta CPU, e início da área onde o estado é salvo nas
+  //   interrupções (ver irq.h)
+  int nucleo;
+  int end_area;
   // identificação das instruções privilegiadas
   bool privilegiadas[N_OPCODE];
   // função e argumento para implementar instrução CHAMAC
@@ -36,14 +41,17 @@ struct cpu_t {
 };
 
 // CRIAÇÃO {{{1
-cpu_t *cpu_cria(mem_t *mem, es_t *es)
+cpu_t *cpu_cria(mem_t *mem, es_t *es, int nucleo)
 {
+  assert(nucleo >= 0 && nucleo < IRQ_MAX_NUCLEOS);
   cpu_t *self;
   self = malloc(sizeof(*self));
   assert(self != NULL);
 
   self->mem = mem;
   self->es = es;
+  self->nucleo = nucleo;
+  self->end_area = IRQ_END_AREA(nucleo);
   // inicializa registradores
   self->PC = 0;
   self->A = 0;
@@ -77,6 +85,11 @@ void cpu_define_chamaC(cpu_t *self, func_chamaC_t funcaoC, void *argC)
   self->argC = argC;
 }
 
+bool cpu_parada(cpu_t *self)
+{
+  return self->erro == ERR_CPU_PARADA;
+}
+
 // IMPRESSÃO {{{1
 static void imprime_registradores(cpu_t *self, char *str)
 {
@@ -468,9 +481,11 @@ void cpu_executa_1(cpu_t *self)
   // não executa se CPU já estiver em erro
   if (self->erro != ERR_OK) return;
 
+  int pc = self->PC;
   int opcode;
   if (pega_opcode(self, &opcode)) {
     executa_a_instrucao(self, opcode);
+    RASTRO(RASTRO_INSTRUCAO, EV_INSTRUCAO, self->nucleo, pc, opcode, self->modo);
   }
 
   // se a CPU entrou em erro, causa uma interrupção
@@ -496,24 +511,28 @@ bool cpu_interrompe(cpu_t *self, irq_t irq)
   //   físicos e não lógicos, e que se tem permissão para realizar esse
   //   acesso (para quando existir proteção de memória)
   self->modo = supervisor;
-
-  // esta é uma CPU boazinha, salva todo o estado interno da CPU no início da memória
-  poe_mem(self, IRQ_END_PC,          self->PC);
-  poe_mem(self, IRQ_END_A,           self->A);
-  poe_mem(self, IRQ_END_X,           self->X);
-  poe_mem(self, IRQ_END_erro,        self->erro);
-  poe_mem(self, IRQ_END_complemento, self->complemento);
-  poe_mem(self, IRQ_END_modo,        usuario);
+  int pc_interrompido = self->PC;
+
+  // esta é uma CPU boazinha, salva todo o estado interno da CPU na sua área
+  //   da memória
+  int area = self->end_area;
+  poe_mem(self, area + IRQ_END_PC,          self->PC);
+  poe_mem(self, area + IRQ_END_A,           self->A);
+  poe_mem(self, area + IRQ_END_X,           self->X);
+  poe_mem(self, area + IRQ_END_erro,        self->erro);
+  poe_mem(self, area + IRQ_END_complemento, self->complemento);
+  poe_mem(self, area + IRQ_END_modo,        usuario);
 
   // altera o estado da CPU para ela poder executar o tratador de interrupção
   // vai iniciar o tratamento da interrupção no endereço IRQ_END_TRATADOR,
   //   com o A contendo o valor da requisição de interrupção e sem erro
   // se o tratador da interrupção precisar do estado da CPU de antes da
-  //   interrupção, deve acessar o início da memória, onde esse estado foi salvo
+  //   interrupção, deve acessar a área da memória onde esse estado foi salvo
   self->PC = IRQ_END_TRATADOR;
   self->A = irq;
   self->erro = ERR_OK;
 
+  RASTRO(RASTRO_IRQ, EV_IRQ_ENTRA, self->nucleo, irq, pc_interrompido, 0);
   return true;
 }
 
@@ -522,16 +541,18 @@ static void cpu_desinterrompe(cpu_t *self)
   // a interrupção retornou
   // recupera o estado da CPU, para que volte a executar o que foi interrompido
   //   quando a interrupção foi atendida
-  pega_mem(self, IRQ_END_PC,          &self->PC);
-  pega_mem(self, IRQ_END_A,           &self->A);
-  pega_mem(self, IRQ_END_X,           &self->X);
+  int area = self->end_area;
+  pega_mem(self, area + IRQ_END_PC,          &self->PC);
+  pega_mem(self, area + IRQ_END_A,           &self->A);
+  pega_mem(self, area + IRQ_END_X,           &self->X);
   // não dá para pegar o erro nem o modo diretamente porque eles não são int
   int dado;
-  pega_mem(self, IRQ_END_erro,        &dado);
+  pega_mem(self, area + IRQ_END_erro,        &dado);
   self->erro = dado;
-  pega_mem(self, IRQ_END_complemento, &self->complemento);
-  pega_mem(self, IRQ_END_modo,        &dado);
+  pega_mem(self, area + IRQ_END_complemento, &self->complemento);
+  pega_mem(self, area + IRQ_END_modo,        &dado);
   self->modo = dado;
+  RASTRO(RASTRO_IRQ, EV_IRQ_SAI, self->nucleo, self->PC, self->modo, 0);
 }
 
 // vim: foldmethod=marker
@@ -22,7 +22,10 @@ typedef int (*func_chamaC_t)(void *argC, int reg_A);
 
 // cria uma unidade de execução com acesso à memória e ao
 //   controlador de E/S fornecidos
-cpu_t *cpu_cria(mem_t *mem, es_t *es);
+// 'nucleo' é o número da CPU (0 a IRQ_MAX_NUCLEOS-1), que define a área da
+//   memória onde ela salva o seu estado nas interrupções (ver irq.h); várias
+//   CPUs podem compartilhar a mesma memória
+cpu_t *cpu_cria(mem_t *mem, es_t *es, int nucleo);
 
 // destrói a unidade de execução
 void cpu_destroi(cpu_t *self);
@@ -34,7 +37,7 @@ void cpu_destroi(cpu_t *self);
 void cpu_executa_1(cpu_t *self);
 
 // implementa uma interrupção
-// passa para modo supervisor, salva o estado da CPU no início da memória,
+// passa para modo supervisor, salva o estado da CPU na sua área da memória,
 //   altera A para identificar a requisição de interrupção, altera PC para
 //   o endereço do tratador de interrupção
 // retorna true se interrupção foi aceita ou false caso contrário
@@ -44,6 +47,9 @@ bool cpu_interrompe(cpu_t *self, irq_t irq);
 // e o argumento a passar para ela (normalmente, um ponteiro para o SO)
 void cpu_define_chamaC(cpu_t *self, func_chamaC_t func, void *argC);
 
+// retorna true se a CPU está parada (executou PARA), esperando uma interrupção
+bool cpu_parada(cpu_t *self);
+
 // concatena a descrição do estado da CPU no final de str
 void cpu_concatena_descricao(cpu_t *self, char *str);
 
@@ -0,0 +1,224 @@
+// decodifica_rastro.c
+// converte um rastro binário (ver rastro.h) para o formato de eventos do
+//   Chrome (JSON), que pode ser visto em chrome://tracing ou
+//   https://ui.perfetto.dev
+// simulador de computador
+// so24b
+
+// uso: decodifica_rastro arquivo_rastro > rastro.json
+// cada unidade de tempo da simulação (uma instrução) aparece como 1µs
+// os eventos são colocados em linhas separadas:
+//   CPU n: as instruções executadas e as interrupções (do início do tratamento
+//     ao RETI) no núcleo n
+//   SO: as chamadas de sistema, os despachos e as faltas de página (com o
+//     núcleo atendido nos argumentos)
+//   processo N: o estado do processo ao longo do tempo
+
+// INCLUDES {{{1
+
+#include "rastro.h"
+#include "instrucao.h"
+#include "irq.h"
+#include "processo.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+// CONSTANTES {{{1
+
+// identificação das linhas ("threads") no JSON
+#define TID_SO 0
+#define TID_CPU 10    // a CPU do núcleo N fica na linha TID_CPU + N
+#define TID_PROC 100  // processo N fica na linha TID_PROC + N
+#define MAX_PROC 1000 // processos com número maior não têm linha própria
+
+// nomes dos estados dos processos, como em estado_processo_para_string (so.c)
+static char *nomes_estados[ESTADO_N] = {
+  [ESTADO_INICIALIZANDO] = "EXECUTANDO",
+  [ESTADO_PRONTO]        = "PRONTO",
+  [ESTADO_BLOQUEADO]     = "BLOQUEADO",
+  [ESTADO_TERMINADO]     = "MORTO",
+};
+
+// ESTADO {{{1
+
+// o que ficou aberto (com um evento "B" sem o "E" correspondente)
+static bool irq_aberta[IRQ_MAX_NUCLEOS];
+static bool nucleo_visto[IRQ_MAX_NUCLEOS];
+static int estado_aberto[MAX_PROC];  // -1 se nenhum
+static bool proc_visto[MAX_PROC];
+static long ultimo_instante;
+static bool primeiro_evento = true;
+
+// SAÍDA {{{1
+
+// imprime o início de um evento, até antes dos argumentos
+static void inicia_evento(char *nome, char *fase, long ts, int tid)
+{
+  printf("%s\n{\"name\": \"%s\", \"ph\": \"%s\", \"ts\": %ld, \"pid\": 0,"
+         " \"tid\": %d", primeiro_evento ? "" : ",", nome, fase, ts, tid);
+  primeiro_evento = false;
+}
+
+static void evento_sem_args(char *nome, char *fase, long ts, int tid)
+{
+  inicia_evento(nome, fase, ts, tid);
+  printf("}");
+}
+
+static void nomeia_linha(int tid, char *nome)
+{
+  inicia_evento("thread_name", "M", 0, tid);
+  printf(", \"args\": {\"name\": \"%s\"}}", nome);
+}
+
+// retorna a linha do processo, criando se for a primeira vez que aparece
+static int linha_do_processo(int processo)
+{
+  if (processo < 0 || processo >= MAX_PROC) return TID_SO;
+  if (!proc_visto[processo]) {
+    char nome[30];
+    sprintf(nome, "processo %d", processo);
+    nomeia_linha(TID_PROC + processo, nome);
+    proc_visto[processo] = true;
+  }
+  return TID_PROC + processo;
+}
+
+// retorna a linha da CPU do núcleo, criando se for a primeira vez que
+//   aparece; -1 se o núcleo for inválido
+static int linha_do_nucleo(int nucleo)
+{
+  if (nucleo < 0 || nucleo >= IRQ_MAX_NUCLEOS) return -1;
+  if (!nucleo_visto[nucleo]) {
+    char nome[30];
+    sprintf(nome, "CPU %d", nucleo);
+    nomeia_linha(TID_CPU + nucleo, nome);
+    nucleo_visto[nucleo] = true;
+  }
+  return TID_CPU + nucleo;
+}
+
+// DECODIFICAÇÃO {{{1
+
+static void decodifica(rastro_evento_t *ev)
+{
+  long ts = ev->instante;
+  int *arg = ev->arg;
+  int nucleo = ev->nucleo;
+  char nome[50];
+  ultimo_instante = ts;
+  switch (ev->tipo) {
+    case EV_INSTRUCAO: {
+      int tid = linha_do_nucleo(nucleo);
+      if (tid == -1) break;
+      inicia_evento(instrucao_nome(arg[1]), "X", ts, tid);
+      printf(", \"dur\": 1, \"args\": {\"pc\": %d, \"modo\": \"%s\"}}",
+             arg[0], arg[2] == 0 ? "supervisor" : "usuario");
+      break;
+    }
+    case EV_IRQ_ENTRA: {
+      int tid = linha_do_nucleo(nucleo);
+      if (tid == -1) break;
+      if (irq_aberta[nucleo]) evento_sem_args("IRQ", "E", ts, tid);
+      inicia_evento(irq_nome(arg[0]), "B", ts, tid);
+      printf(", \"args\": {\"pc\": %d}}", arg[1]);
+      irq_aberta[nucleo] = true;
+      break;
+    }
+    case EV_IRQ_SAI: {
+      int tid = linha_do_nucleo(nucleo);
+      if (tid == -1 || !irq_aberta[nucleo]) break;
+      inicia_evento("IRQ", "E", ts, tid);
+      printf(", \"args\": {\"pc\": %d, \"modo\": \"%s\"}}", arg[0],
+             arg[1] == 0 ? "supervisor" : "usuario");
+      irq_aberta[nucleo] = false;
+      break;
+    }
+    case EV_CHAMADA:
+      sprintf(nome, "chamada %d", arg[0]);
+      inicia_evento(nome, "i", ts, TID_SO);
+      printf(", \"s\": \"t\", \"args\": {\"processo\": %d, \"nucleo\": %d}}",
+             arg[1], nucleo);
+      break;
+    case EV_ESTADO: {
+      int tid = linha_do_processo(arg[0]);
+      if (tid == TID_SO) break;
+      if (estado_aberto[arg[0]] != -1) evento_sem_args("estado", "E", ts, tid);
+      if (arg[2] >= 0 && arg[2] < ESTADO_N) {
+        sprintf(nome, "%s", nomes_estados[arg[2]]);
+      } else {
+        sprintf(nome, "estado %d", arg[2]);
+      }
+      evento_sem_args(nome, "B", ts, tid);
+      estado_aberto[arg[0]] = arg[2];
+      break;
+    }
+    case EV_DESPACHO:
+      sprintf(nome, "despacha %d", arg[0]);
+      inicia_evento(nome, "i", ts, TID_SO);
+      printf(", \"args\": {\"nucleo\": %d}}", nucleo);
+      break;
+    case EV_FALTA_PAGINA:
+      inicia_evento("falta de página", "i", ts, TID_SO);
+      printf(", \"s\": \"t\", \"args\": {\"processo\": %d, \"endereco\": %d,"
+             " \"pagina\": %d}}", arg[0], arg[1], arg[2]);
+      break;
+    default:
+      fprintf(stderr, "evento de tipo desconhecido: %d\n", ev->tipo);
+  }
+}
+
+// fecha o que ficou aberto no fim do rastro
+static void fecha_abertos(void)
+{
+  for (int n = 0; n < IRQ_MAX_NUCLEOS; n++) {
+    if (irq_aberta[n]) evento_sem_args("IRQ", "E", ultimo_instante, TID_CPU + n);
+  }
+  for (int p = 0; p < MAX_PROC; p++) {
+    if (estado_aberto[p] != -1) {
+      evento_sem_args("estado", "E", ultimo_instante, TID_PROC + p);
+    }
+  }
+}
+
+// PRINCIPAL {{{1
+
+int main(int argc, char *argv[argc])
+{
+  if (argc != 2) {
+    fprintf(stderr, "ERRO: chame como '%s arquivo_rastro'\n", argv[0]);
+    return 1;
+  }
+  FILE *arq = fopen(argv[1], "rb");
+  if (arq == NULL) {
+    fprintf(stderr, "ERRO: não foi possível abrir '%s'\n", argv[1]);
+    return 1;
+  }
+  char assinatura[sizeof(RASTRO_ASSINATURA)] = "";
+  int tam = strlen(RASTRO_ASSINATURA);
+  if (fread(assinatura, 1, tam, arq) != tam
+      || strcmp(assinatura, RASTRO_ASSINATURA) != 0) {
+    fprintf(stderr, "ERRO: '%s' não é um arquivo de rastro\n", argv[1]);
+    return 1;
+  }
+
+  for (int p = 0; p < MAX_PROC; p++) estado_aberto[p] = -1;
+  printf("{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+  nomeia_linha(TID_SO, "SO");
+  rastro_evento_t ev;
+  long n_ev = 0;
+  while (fread(&ev, sizeof(ev), 1, arq) == 1) {
+    decodifica(&ev);
+    n_ev++;
+  }
+  fecha_abertos();
+  printf("\n]}\n");
+  fclose(arq);
+  fprintf(stderr, "%ld eventos\n", n_ev);
+  return 0;
+}
+
+// vim: foldmethod=marker
@@ -27,6 +27,16 @@ typedef enum {
   D_RELOGIO_REAL          = 17,
   D_RELOGIO_TIMER         = 18,
   D_RELOGIO_INTERRUPCAO   = 19,
+  D_PIC_ORIGEM_TECLADO    = 20,
+  D_PIC_ORIGEM_TELA       = 21,
+  D_PIC_PENDENTES         = 22,
+  D_PIC_PROXIMA           = 23,
+  D_PIC_MASCARA           = 24,
+  D_PIC_LINHA             = 25,
+  D_PIC_PRIORIDADE        = 26,
+  D_RELOGIO_ALARME        = 27,
+  D_PIC_ORIGEM_NUCLEO     = 28,
+  D_PIC_ACORDA            = 29,
   N_DISPOSITIVOS
 } dispositivo_id_t;
 
@@ -0,0 +1,110 @@
+#!/bin/bash
+# experimentos.sh
+# executa o simulador em lote para várias configurações do SO e junta as
+#   métricas de todas as execuções em uma tabela
+# simulador de computador
+# so24b
+#
+# uso: ./experimentos.sh [-j execuções_simultâneas]
+# as configurações são todas as combinações dos valores nas variáveis
+#   ESCALONADORES, QUANTUNS, INTERVALOS, MEMORIAS e NUCLEOS (listas separadas
+#   por espaço), que podem ser alteradas no ambiente, por exemplo:
+#     QUANTUNS="2 5 10 20" INTERVALOS="20 50" ./experimentos.sh
+#     NUCLEOS="1 2 4" ./experimentos.sh
+# cada execução é feita em um diretório próprio dentro de experimentos/
+#   (com o log da console e o metricas_final.txt completo); a comparação fica
+#   em experimentos/resultados.csv e experimentos/resultados.md
+# os programas são montados para endereços fixos até 9000, a memória não
+#   pode ser muito menor que o padrão
+
+ESCALONADORES=${ESCALONADORES:-"prioridade round-robin simples"}
+QUANTUNS=${QUANTUNS:-"5"}
+INTERVALOS=${INTERVALOS:-"20"}
+MEMORIAS=${MEMORIAS:-"10000"}
+NUCLEOS=${NUCLEOS:-"1"}
+JOBS=$(nproc 2>/dev/null || echo 1)
+DIR=experimentos
+
+while getopts "j:" opt; do
+  case $opt in
+    j) JOBS=$OPTARG ;;
+    *) echo "uso: $0 [-j execuções_simultâneas]" >&2; exit 1 ;;
+  esac
+done
+
+if [ ! -x ./main ]; then
+  echo "$0: ./main não encontrado, execute 'make' antes" >&2
+  exit 1
+fi
+
+# nome do diretório de uma configuração
+nome_dir() {
+  echo "$DIR/${1}_q${2}_i${3}_m${4}_c${5}"
+}
+
+# executa uma configuração no seu diretório; os programas são ligados, não
+#   copiados
+executa() {
+  local esc=$1 q=$2 i=$3 mem=$4 c=$5
+  local d=$(nome_dir "$@")
+  rm -rf "$d"
+  mkdir -p "$d"
+  for maq in *.maq; do ln -s "../../$maq" "$d/$maq"; done
+  if ! (cd "$d" && ../../main -l -e "$esc" -q "$q" -i "$i" -m "$mem" -c "$c" \
+                   < /dev/null > saida 2>&1); then
+    echo "$0: falhou: $esc, quantum $q, intervalo $i, memória $mem," \
+         "$c núcleos (ver $d/saida)" >&2
+  fi
+}
+export -f executa nome_dir
+export DIR
+
+mkdir -p $DIR
+for esc in $ESCALONADORES; do
+  for q in $QUANTUNS; do
+    for i in $INTERVALOS; do
+      for mem in $MEMORIAS; do
+        for c in $NUCLEOS; do
+          echo "$esc $q $i $mem $c"
+        done
+      done
+    done
+  done
+done > $DIR/configuracoes
+
+xargs -P "$JOBS" -L 1 bash -c 'executa "$@"' _ < $DIR/configuracoes
+
+# extrai de cada metricas_final.txt as métricas do sistema e as médias dos
+#   tempos de resposta e de retorno dos processos, na ordem das configurações
+csv=$DIR/resultados.csv
+md=$DIR/resultados.md
+echo "escalonador,quantum,intervalo,memoria,nucleos,processos,tempo_total,tempo_ocioso,preempcoes,roubados,resposta_media,retorno_medio" > $csv
+while read -r esc q i mem c; do
+  f=$(nome_dir $esc $q $i $mem $c)/metricas_final.txt
+  [ -f "$f" ] || continue
+  awk -F'|' -v cfg="$esc,$q,$i,$mem,$c" '
+    function valor() { v = $3; gsub(/ /, "", v); return v }
+    /NÚMERO DE PROCESSOS/     { procs = valor() }
+    /TEMPO TOTAL DE EXECUÇÃO/ { total = valor() }
+    /TEMPO TOTAL OCIOSO/      { ocioso = valor() }
+    /NÚMERO DE PREEMPÇÕES/ && preempcoes == "" { preempcoes = valor() }
+    /PROCESSOS ROUBADOS/      { roubados = valor() }
+    /TEMPO DE RESPOSTA/       { resposta += valor(); n_resp++ }
+    /TEMPO DE RETORNO/        { retorno += valor(); n_ret++ }
+    END {
+      printf "%s,%s,%s,%s,%s,%s,%.1f,%.1f\n", cfg, procs, total, ocioso,
+             preempcoes, roubados, n_resp ? resposta / n_resp : 0,
+             n_ret ? retorno / n_ret : 0
+    }' "$f" >> $csv
+done < $DIR/configuracoes
+
+{
+  echo "| escalonador | quantum | intervalo | memória | núcleos | processos | tempo total | tempo ocioso | preempções | roubados | resposta média | retorno médio |"
+  echo "|-------------|--------:|----------:|--------:|--------:|----------:|------------:|-------------:|-----------:|---------:|---------------:|--------------:|"
+  tail -n +2 $csv | awk -F, '{
+    printf "| %s | %s | %s | %s | %s | %s | %s | %s | %s | %s | %s | %s |\n",
+           $1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11, $12
+  }'
+} > $md
+
+cat $md
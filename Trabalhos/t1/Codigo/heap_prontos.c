@@ -0,0 +1,155 @@
+#include "heap_prontos.h"
+#include <stdlib.h>
+#include <assert.h>
+
+// capacidade inicial do vetor do heap; dobra quando enche
+#define TAM_INICIAL 16
+
+struct heap_prontos_t {
+    processo_t **vetor;
+    int tam;
+    int capacidade;
+    // contador de inserções, para desempatar prioridades iguais pela ordem de chegada
+    long num_insercoes;
+};
+
+heap_prontos_t *heap_prontos_cria(void)
+{
+    heap_prontos_t *self = malloc(sizeof(*self));
+    assert(self != NULL);
+    self->vetor = malloc(TAM_INICIAL * sizeof(processo_t *));
+    assert(self->vetor != NULL);
+    self->tam = 0;
+    self->capacidade = TAM_INICIAL;
+    self->num_insercoes = 0;
+    return self;
+}
+
+void heap_prontos_destroi(heap_prontos_t *self)
+{
+    free(self->vetor);
+    free(self);
+}
+
+bool heap_prontos_vazio(heap_prontos_t *self)
+{
+    return self->tam == 0;
+}
+
+bool heap_prontos_contem(heap_prontos_t *self, processo_t *proc)
+{
+    return proc->indice_heap >= 0 && proc->indice_heap < self->tam
+        && self->vetor[proc->indice_heap] == proc;
+}
+
+// retorna true se 'a' deve sair do heap antes de 'b'
+static bool antes(processo_t *a, processo_t *b)
+{
+    if (a->prioridade != b->prioridade)
+    {
+        return a->prioridade < b->prioridade;
+    }
+    return a->ordem_heap < b->ordem_heap;
+}
+
+static void coloca(heap_prontos_t *self, int i, processo_t *proc)
+{
+    self->vetor[i] = proc;
+    proc->indice_heap = i;
+}
+
+static void sobe(heap_prontos_t *self, int i)
+{
+    processo_t *proc = self->vetor[i];
+    while (i > 0)
+    {
+        int pai = (i - 1) / 2;
+        if (!antes(proc, self->vetor[pai]))
+        {
+            break;
+        }
+        coloca(self, i, self->vetor[pai]);
+        i = pai;
+    }
+    coloca(self, i, proc);
+}
+
+static void desce(heap_prontos_t *self, int i)
+{
+    processo_t *proc = self->vetor[i];
+    for (;;)
+    {
+        int filho = 2 * i + 1;
+        if (filho >= self->tam)
+        {
+            break;
+        }
+        if (filho + 1 < self->tam && antes(self->vetor[filho + 1], self->vetor[filho]))
+        {
+            filho++;
+        }
+        if (!antes(self->vetor[filho], proc))
+        {
+            break;
+        }
+        coloca(self, i, self->vetor[filho]);
+        i = filho;
+    }
+    coloca(self, i, proc);
+}
+
+void heap_prontos_insere(heap_prontos_t *self, processo_t *proc)
+{
+    assert(!heap_prontos_contem(self, proc));
+    if (self->tam == self->capacidade)
+    {
+        self->capacidade *= 2;
+        self->vetor = realloc(self->vetor, self->capacidade * sizeof(processo_t *));
+        assert(self->vetor != NULL);
+    }
+    proc->ordem_heap = self->num_insercoes++;
+    coloca(self, self->tam, proc);
+    self->tam++;
+    sobe(self, self->tam - 1);
+}
+
+void heap_prontos_remove(heap_prontos_t *self, processo_t *proc)
+{
+    if (!heap_prontos_contem(self, proc))
+    {
+        return;
+    }
+    int i = proc->indice_heap;
+    proc->indice_heap = -1;
+    self->tam--;
+    if (i == self->tam)
+    {
+        return;
+    }
+    // coloca o último no lugar do removido, e acerta a posição dele
+    processo_t *movido = self->vetor[self->tam];
+    coloca(self, i, movido);
+    sobe(self, i);
+    desce(self, movido->indice_heap);
+}
+
+processo_t *heap_prontos_remove_primeiro(heap_prontos_t *self)
+{
+    if (self->tam == 0)
+    {
+        return NULL;
+    }
+    processo_t *proc = self->vetor[0];
+    heap_prontos_remove(self, proc);
+    return proc;
+}
+
+void heap_prontos_atualiza(heap_prontos_t *self, processo_t *proc)
+{
+    if (!heap_prontos_contem(self, proc))
+    {
+        return;
+    }
+    sobe(self, proc->indice_heap);
+    desce(self, proc->indice_heap);
+}
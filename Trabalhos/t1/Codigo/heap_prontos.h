@@ -0,0 +1,35 @@
+#ifndef HEAP_PRONTOS_H
+#define HEAP_PRONTOS_H
+
+#include <stdbool.h>
+#include "processo.h"
+
+// Fila de prioridade dos processos prontos, para o escalonador por prioridade
+// É um heap mínimo indexado: cada processo guarda a sua posição no heap
+//   (campo 'indice_heap'), o que permite retirar ou reposicionar um processo
+//   qualquer em O(log n)
+// O primeiro é o processo de menor valor de prioridade; entre processos com a
+//   mesma prioridade, o que foi inserido antes (como numa fila)
+
+typedef struct heap_prontos_t heap_prontos_t;
+
+heap_prontos_t *heap_prontos_cria(void);
+void heap_prontos_destroi(heap_prontos_t *self);
+
+bool heap_prontos_vazio(heap_prontos_t *self);
+bool heap_prontos_contem(heap_prontos_t *self, processo_t *proc);
+
+// insere o processo no heap (ele não pode estar no heap)
+void heap_prontos_insere(heap_prontos_t *self, processo_t *proc);
+
+// retira e retorna o primeiro processo do heap (NULL se vazio)
+processo_t *heap_prontos_remove_primeiro(heap_prontos_t *self);
+
+// retira o processo do heap; não faz nada se ele não estiver no heap
+void heap_prontos_remove(heap_prontos_t *self, processo_t *proc);
+
+// reposiciona o processo no heap, depois de sua prioridade ter sido alterada
+// não faz nada se ele não estiver no heap
+void heap_prontos_atualiza(heap_prontos_t *self, processo_t *proc);
+
+#endif // HEAP_PRONTOS_H
@@ -11,7 +11,8 @@ static char *nomes[N_IRQ] = {
   [IRQ_SISTEMA] = "Chamada de sistema",
   [IRQ_RELOGIO] = "E/S: relógio",
   [IRQ_TECLADO] = "E/S: teclado",
-  [IRQ_TELA]    = "E/S: console",
+  [IRQ_TELA]    = "E/S: tela",
+  [IRQ_NUCLEO]  = "Outro núcleo",
 };
 
 // retorna o nome da interrupção
@@ -14,17 +14,28 @@ typedef enum {
   IRQ_SISTEMA,       // chamada de sistema
   // interrupções geradas por dispositivos de E/S
   IRQ_RELOGIO,       // interrupção causada pelo relógio
-  // interrupções de E/S ainda não implementadas
-  IRQ_TECLADO,       // interrupção causada pelo teclado
-  IRQ_TELA,          // interrupção causada pela tela
+  // interrupções dos terminais, pedidas pelo controlador de interrupções
+  //   (ver pic.h)
+  IRQ_TECLADO,       // chegou entrada em um terminal
+  IRQ_TELA,          // a saída de um terminal ficou pronta
+  // interrupção pedida por outro núcleo, pelo seu controlador (ver pic.h)
+  IRQ_NUCLEO,
   N_IRQ              // número de interrupções
 } irq_t;
 
 char *irq_nome(irq_t irq);
 
-// endereços na memória onde a CPU salva os valores dos registradores
-//   quando aceita uma interrupção, e de onde recupera esses valores
-//   quando retorna de uma interrupção
+// número máximo de núcleos (CPUs) que compartilham a memória
+#define IRQ_MAX_NUCLEOS 8
+
+// cada núcleo tem a sua área na memória onde a CPU salva os valores dos
+//   registradores quando aceita uma interrupção, e de onde recupera esses
+//   valores quando retorna de uma interrupção
+// as áreas ficam em sequência a partir de IRQ_END_AREAS, depois do tratador
+//   de interrupção; os IRQ_END_* abaixo são as posições dentro da área
+#define IRQ_END_AREAS      20
+#define IRQ_TAM_AREA        6
+#define IRQ_END_AREA(nucleo) (IRQ_END_AREAS + (nucleo) * IRQ_TAM_AREA)
 #define IRQ_END_PC          0
 #define IRQ_END_A           1
 #define IRQ_END_X           2
@@ -32,7 +43,8 @@ char *irq_nome(irq_t irq);
 #define IRQ_END_complemento 4
 #define IRQ_END_modo        5
 
-// endereço para onde desviar quando aceita uma interrupção
+// endereço para onde desviar quando aceita uma interrupção (o mesmo tratador
+//   para todos os núcleos)
 #define IRQ_END_TRATADOR   10
 
 #endif // IRQ_H
@@ -7,105 +7,350 @@
 #include "memoria.h"
 #include "cpu.h"
 #include "relogio.h"
+#include "pic.h"
 #include "console.h"
 #include "terminal.h"
 #include "es.h"
 #include "dispositivos.h"
 #include "so.h"
+#include "rastro.h"
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
 
 // constantes
 #define MEM_TAM 10000        // tamanho da memória principal
+#define N_TERM 4             // número de terminais (A a D)
+#define INTERVALO_ENTRADA 1  // instruções entre caracteres da entrada de arquivo
+#define N_NUCLEOS 1          // número de núcleos (CPUs)
 
 // estrutura com os componentes do computador simulado
+// cada núcleo tem a sua CPU, o seu relógio (com o timer local), o seu
+//   controlador de interrupções e o seu controlador de E/S; a memória e os
+//   terminais são compartilhados
 typedef struct {
   mem_t *mem;
-  cpu_t *cpu;
-  relogio_t *relogio;
+  int n_nucleos;
+  cpu_t *cpu[IRQ_MAX_NUCLEOS];
+  relogio_t *relogio[IRQ_MAX_NUCLEOS];
+  pic_t *pic[IRQ_MAX_NUCLEOS];
+  es_t *es[IRQ_MAX_NUCLEOS];
   console_t *console;
-  es_t *es;
   controle_t *controle;
 } hardware_t;
 
-static void cria_hardware(hardware_t *hw)
-{
-  // cria a memória
-  hw->mem = mem_cria(MEM_TAM);
-
-  // cria dispositivos de E/S
-  hw->console = console_cria();
-  hw->relogio = relogio_cria();
+// configuração da simulação, definida pelos argumentos da linha de comando
+typedef struct {
+  controle_modo_t modo;
+  int mem_tam;
+  int n_nucleos;
+  so_config_t so;
+  // arquivos de entrada e saída de cada terminal (NULL para usar a console)
+  FILE *entrada[N_TERM];
+  int intervalo_entrada[N_TERM];
+  FILE *saida[N_TERM];
+  // nível das mensagens da console
+  console_nivel_t nivel;
+  // arquivo e categorias do rastro (NULL se não tem rastro)
+  char *rastro;
+  unsigned categorias_rastro;
+} config_t;
 
-  // cria o controlador de E/S e registra os dispositivos
-  //   por exemplo, o dispositivo 8 do controlador de E/S (e da CPU) será o
-  //   dispositivo 0 do relógio (que é o contador de instruções)
-  hw->es = es_cria();
+// cria o controlador de E/S do núcleo n e registra os dispositivos
+//   por exemplo, o dispositivo 8 do controlador de E/S (e da CPU) será o
+//   dispositivo 0 do relógio (que é o contador de instruções)
+// os terminais são os mesmos em todos os núcleos; o relógio e o controlador
+//   de interrupções são os do núcleo
+static es_t *cria_es(hardware_t *hw, int n)
+{
+  es_t *es = es_cria();
   // lê teclado, testa teclado, escreve tela, testa tela do terminal A
   terminal_t *terminal;
   terminal = console_terminal(hw->console, 'A');
-  es_registra_dispositivo(hw->es, D_TERM_A_TECLADO    , terminal, 0, terminal_leitura, NULL);
-  es_registra_dispositivo(hw->es, D_TERM_A_TECLADO_OK , terminal, 1, terminal_leitura, NULL);
-  es_registra_dispositivo(hw->es, D_TERM_A_TELA       , terminal, 2, NULL, terminal_escrita);
-  es_registra_dispositivo(hw->es, D_TERM_A_TELA_OK    , terminal, 3, terminal_leitura, NULL);
+  es_registra_dispositivo(es, D_TERM_A_TECLADO    , terminal, 0, terminal_leitura, NULL);
+  es_registra_dispositivo(es, D_TERM_A_TECLADO_OK , terminal, 1, terminal_leitura, NULL);
+  es_registra_dispositivo(es, D_TERM_A_TELA       , terminal, 2, NULL, terminal_escrita);
+  es_registra_dispositivo(es, D_TERM_A_TELA_OK    , terminal, 3, terminal_leitura, NULL);
   // lê teclado, testa teclado, escreve tela, testa tela do terminal B
   terminal = console_terminal(hw->console, 'B');
-  es_registra_dispositivo(hw->es, D_TERM_B_TECLADO    , terminal, 0, terminal_leitura, NULL);
-  es_registra_dispositivo(hw->es, D_TERM_B_TECLADO_OK , terminal, 1, terminal_leitura, NULL);
-  es_registra_dispositivo(hw->es, D_TERM_B_TELA       , terminal, 2, NULL, terminal_escrita);
-  es_registra_dispositivo(hw->es, D_TERM_B_TELA_OK    , terminal, 3, terminal_leitura, NULL);
+  es_registra_dispositivo(es, D_TERM_B_TECLADO    , terminal, 0, terminal_leitura, NULL);
+  es_registra_dispositivo(es, D_TERM_B_TECLADO_OK , terminal, 1, terminal_leitura, NULL);
+  es_registra_dispositivo(es, D_TERM_B_TELA       , terminal, 2, NULL, terminal_escrita);
+  es_registra_dispositivo(es, D_TERM_B_TELA_OK    , terminal, 3, terminal_leitura, NULL);
   // lê teclado, testa teclado, escreve tela, testa tela do terminal C
   terminal = console_terminal(hw->console, 'C');
-  es_registra_dispositivo(hw->es, D_TERM_C_TECLADO    , terminal, 0, terminal_leitura, NULL);
-  es_registra_dispositivo(hw->es, D_TERM_C_TECLADO_OK , terminal, 1, terminal_leitura, NULL);
-  es_registra_dispositivo(hw->es, D_TERM_C_TELA       , terminal, 2, NULL, terminal_escrita);
-  es_registra_dispositivo(hw->es, D_TERM_C_TELA_OK    , terminal, 3, terminal_leitura, NULL);
+  es_registra_dispositivo(es, D_TERM_C_TECLADO    , terminal, 0, terminal_leitura, NULL);
+  es_registra_dispositivo(es, D_TERM_C_TECLADO_OK , terminal, 1, terminal_leitura, NULL);
+  es_registra_dispositivo(es, D_TERM_C_TELA       , terminal, 2, NULL, terminal_escrita);
+  es_registra_dispositivo(es, D_TERM_C_TELA_OK    , terminal, 3, terminal_leitura, NULL);
   // lê teclado, testa teclado, escreve tela, testa tela do terminal D
   terminal = console_terminal(hw->console, 'D');
-  es_registra_dispositivo(hw->es, D_TERM_D_TECLADO    , terminal, 0, terminal_leitura, NULL);
-  es_registra_dispositivo(hw->es, D_TERM_D_TECLADO_OK , terminal, 1, terminal_leitura, NULL);
-  es_registra_dispositivo(hw->es, D_TERM_D_TELA       , terminal, 2, NULL, terminal_escrita);
-  es_registra_dispositivo(hw->es, D_TERM_D_TELA_OK    , terminal, 3, terminal_leitura, NULL);
-  // lê relógio virtual, relógio real
-  es_registra_dispositivo(hw->es, D_RELOGIO_INSTRUCOES, hw->relogio, 0, relogio_leitura, NULL);
-  es_registra_dispositivo(hw->es, D_RELOGIO_REAL      , hw->relogio, 1, relogio_leitura, NULL);
-  es_registra_dispositivo(hw->es, D_RELOGIO_TIMER     , hw->relogio, 2, relogio_leitura, relogio_escrita);
-  es_registra_dispositivo(hw->es, D_RELOGIO_INTERRUPCAO,hw->relogio, 3, relogio_leitura, relogio_escrita);
-
-  // cria a unidade de execução e inicializa com a memória e o controlador de E/S
-  hw->cpu = cpu_cria(hw->mem, hw->es);
-
-  // cria o controlador da CPU e inicializa com a unidade de execução, a console e
-  //   o relógio
-  hw->controle = controle_cria(hw->cpu, hw->console, hw->relogio);
+  es_registra_dispositivo(es, D_TERM_D_TECLADO    , terminal, 0, terminal_leitura, NULL);
+  es_registra_dispositivo(es, D_TERM_D_TECLADO_OK , terminal, 1, terminal_leitura, NULL);
+  es_registra_dispositivo(es, D_TERM_D_TELA       , terminal, 2, NULL, terminal_escrita);
+  es_registra_dispositivo(es, D_TERM_D_TELA_OK    , terminal, 3, terminal_leitura, NULL);
+  // lê relógio virtual, relógio real; lê ou programa o timer (pelo tempo até
+  //   a interrupção ou pelo instante dela), o pedido de interrupção
+  relogio_t *relogio = hw->relogio[n];
+  es_registra_dispositivo(es, D_RELOGIO_INSTRUCOES, relogio, 0, relogio_leitura, NULL);
+  es_registra_dispositivo(es, D_RELOGIO_REAL      , relogio, 1, relogio_leitura, NULL);
+  es_registra_dispositivo(es, D_RELOGIO_TIMER     , relogio, 2, relogio_leitura, relogio_escrita);
+  es_registra_dispositivo(es, D_RELOGIO_INTERRUPCAO,relogio, 3, relogio_leitura, relogio_escrita);
+  es_registra_dispositivo(es, D_RELOGIO_ALARME    , relogio, 4, relogio_leitura, relogio_escrita);
+  // controlador de interrupções: lê (e reconhece) os terminais que pediram
+  //   interrupção de teclado, de tela, os núcleos que pediram interrupção; lê
+  //   as linhas pendentes, a próxima a atender; lê ou altera a máscara, a
+  //   linha selecionada e a sua prioridade; pede interrupção a outro núcleo
+  pic_t *pic = hw->pic[n];
+  es_registra_dispositivo(es, D_PIC_ORIGEM_TECLADO, pic, IRQ_TECLADO, pic_leitura, NULL);
+  es_registra_dispositivo(es, D_PIC_ORIGEM_TELA   , pic, IRQ_TELA, pic_leitura, NULL);
+  es_registra_dispositivo(es, D_PIC_ORIGEM_NUCLEO , pic, IRQ_NUCLEO, pic_leitura, NULL);
+  es_registra_dispositivo(es, D_PIC_PENDENTES     , pic, PIC_PENDENTES, pic_leitura, NULL);
+  es_registra_dispositivo(es, D_PIC_PROXIMA       , pic, PIC_PROXIMA, pic_leitura, NULL);
+  es_registra_dispositivo(es, D_PIC_MASCARA       , pic, PIC_MASCARA, pic_leitura, pic_escrita);
+  es_registra_dispositivo(es, D_PIC_LINHA         , pic, PIC_LINHA, pic_leitura, pic_escrita);
+  es_registra_dispositivo(es, D_PIC_PRIORIDADE    , pic, PIC_PRIORIDADE, pic_leitura, pic_escrita);
+  es_registra_dispositivo(es, D_PIC_ACORDA        , pic, PIC_ACORDA, NULL, pic_escrita);
+  return es;
+}
+
+static void cria_hardware(hardware_t *hw, config_t *cfg)
+{
+  // cria a memória
+  hw->mem = mem_cria(cfg->mem_tam);
+
+  // cria o relógio e o controlador de interrupções de cada núcleo; o relógio
+  //   pede a interrupção do timer ao controlador do seu núcleo
+  hw->n_nucleos = cfg->n_nucleos;
+  for (int n = 0; n < hw->n_nucleos; n++) {
+    hw->pic[n] = pic_cria();
+    pic_liga_nucleos(hw->pic[n], n, hw->pic, hw->n_nucleos);
+    hw->relogio[n] = relogio_cria();
+    relogio_define_pic(hw->relogio[n], hw->pic[n]);
+  }
+
+  // cria dispositivos de E/S
+  // no modo lote não tem operador, a console não usa a tela
+  // os terminais pedem interrupção ao controlador do núcleo 0, identificados
+  //   pelo número (0 para o A)
+  hw->console = console_cria(cfg->modo != controle_lote);
+  console_define_nivel(cfg->nivel);
+  for (int t = 0; t < N_TERM; t++) {
+    terminal_t *terminal = console_terminal(hw->console, 'A' + t);
+    terminal_define_pic(terminal, hw->pic[0], t);
+    if (cfg->entrada[t] != NULL) {
+      terminal_define_entrada(terminal, cfg->entrada[t],
+                              cfg->intervalo_entrada[t]);
+    }
+    if (cfg->saida[t] != NULL) terminal_define_saida(terminal, cfg->saida[t]);
+  }
+
+  // cria o controlador de E/S e a unidade de execução de cada núcleo, esta
+  //   inicializada com a memória (compartilhada) e o controlador de E/S
+  for (int n = 0; n < hw->n_nucleos; n++) {
+    hw->es[n] = cria_es(hw, n);
+    hw->cpu[n] = cpu_cria(hw->mem, hw->es[n], n);
+  }
+
+  // cria o controlador da CPU e inicializa com as unidades de execução, a
+  //   console, os relógios e os controladores de interrupções
+  hw->controle = controle_cria(hw->cpu[0], hw->console, hw->relogio[0],
+                               hw->pic[0]);
+  for (int n = 1; n < hw->n_nucleos; n++) {
+    controle_adiciona_nucleo(hw->controle, hw->cpu[n], hw->relogio[n],
+                             hw->pic[n]);
+  }
+  controle_define_modo(hw->controle, cfg->modo);
 }
 
 static void destroi_hardware(hardware_t *hw)
 {
   controle_destroi(hw->controle);
-  cpu_destroi(hw->cpu);
-  es_destroi(hw->es);
-  relogio_destroi(hw->relogio);
+  for (int n = 0; n < hw->n_nucleos; n++) {
+    cpu_destroi(hw->cpu[n]);
+    es_destroi(hw->es[n]);
+    relogio_destroi(hw->relogio[n]);
+  }
   console_destroi(hw->console);
+  for (int n = 0; n < hw->n_nucleos; n++) {
+    pic_destroi(hw->pic[n]);
+  }
   mem_destroi(hw->mem);
 }
 
-int main()
+// converte 'txt' em um inteiro positivo em '*pval'; mata o programa se não der
+static void le_positivo(char *txt, char *descricao, int *pval)
+{
+  char *fim;
+  *pval = strtol(txt, &fim, 10);
+  if (*fim != '\0' || *pval <= 0) {
+    fprintf(stderr, "ERRO: %s inválido: '%s'\n", descricao, txt);
+    exit(1);
+  }
+}
+
+// interpreta o argumento das opções -E e -S ('t=arquivo', com t de A a D),
+//   abrindo o arquivo com 'modo'; retorna o número do terminal
+// para a entrada, o nome pode terminar com ',intervalo', que é colocado em
+//   '*pintervalo' (se não for NULL)
+static int le_arquivo_terminal(char *arg, char *modo, FILE **parq,
+                               int *pintervalo)
+{
+  int t = toupper(arg[0]) - 'A';
+  if (t < 0 || t >= N_TERM || arg[1] != '=' || arg[2] == '\0') {
+    fprintf(stderr, "ERRO: terminal inválido (deve ser t=arquivo, t de A"
+                    " a D): '%s'\n", arg);
+    exit(1);
+  }
+  char *nome = &arg[2];
+  char *virgula = strrchr(nome, ',');
+  if (pintervalo != NULL && virgula != NULL) {
+    char *fim;
+    int intervalo = strtol(virgula + 1, &fim, 10);
+    if (virgula[1] != '\0' && *fim == '\0' && intervalo >= 0) {
+      *pintervalo = intervalo;
+      *virgula = '\0';
+    }
+  }
+  *parq = fopen(nome, modo);
+  if (*parq == NULL) {
+    fprintf(stderr, "ERRO: não foi possível abrir '%s'\n", nome);
+    exit(1);
+  }
+  return t;
+}
+
+// interpreta os argumentos da linha de comando
+//   -l         modo lote, sem tela; a simulação começa executando e termina
+//              quando a CPU parar sem nada que possa acordá-la (timer
+//              desligado, terminais sem interrupção a pedir)
+//   -m tam     tamanho da memória principal (MEM_TAM se não informado)
+//   -c n       número de núcleos (CPUs) que compartilham a memória, até
+//              IRQ_MAX_NUCLEOS (N_NUCLEOS se não informado)
+//   -i instr   intervalo do relógio (a unidade do quantum), em instruções
+//              (INTERVALO_INTERRUPCAO se não informado)
+//   -q quantum quantum do escalonador, em intervalos do relógio (QUANTUM
+//              se não informado)
+//   -e nome    escalonador do SO (prioridade, round-robin, simples, ou o
+//              número correspondente; ESCALONADOR se não informado)
+//   -E t=arq[,intervalo]
+//              a entrada do terminal t (A a D) vem do arquivo (ou pipe)
+//              'arq', um caractere a cada 'intervalo' instruções
+//              (INTERVALO_ENTRADA se não informado; 0 para o mais rápido
+//              possível)
+//   -S t=arq   a saída do terminal t é copiada para o arquivo 'arq'
+//   -r arq[:categorias]
+//              registra um rastro dos eventos da simulação no arquivo 'arq'
+//              (ver rastro.h), das categorias listadas separadas por vírgula
+//              (instrucao, irq, chamada, processo, memoria; todas menos
+//              instrucao se não informado)
+//   -v nivel   nível das mensagens da console (erro, info, depuracao,
+//              detalhe, ou o número correspondente; info se não informado)
+static void verifica_args(int argc, char *argv[argc], config_t *cfg)
+{
+  for (int t = 0; t < N_TERM; t++) {
+    cfg->entrada[t] = NULL;
+    cfg->intervalo_entrada[t] = INTERVALO_ENTRADA;
+    cfg->saida[t] = NULL;
+  }
+  cfg->nivel = NIVEL_INFO;
+  cfg->rastro = NULL;
+  cfg->categorias_rastro = RASTRO_TODAS & ~RASTRO_INSTRUCAO;
+  cfg->modo = controle_interativo;
+  cfg->mem_tam = MEM_TAM;
+  cfg->n_nucleos = N_NUCLEOS;
+  cfg->so.intervalo_interrupcao = INTERVALO_INTERRUPCAO;
+  cfg->so.quantum = QUANTUM;
+  cfg->so.escalonador = ESCALONADOR;
+  for (int argi = 1; argi < argc; argi++) {
+    if (strcmp(argv[argi], "-l") == 0) {
+      cfg->modo = controle_lote;
+    } else if (strcmp(argv[argi], "-m") == 0 && argi + 1 < argc) {
+      le_positivo(argv[++argi], "tamanho de memória", &cfg->mem_tam);
+    } else if (strcmp(argv[argi], "-c") == 0 && argi + 1 < argc) {
+      le_positivo(argv[++argi], "número de núcleos", &cfg->n_nucleos);
+      if (cfg->n_nucleos > IRQ_MAX_NUCLEOS) {
+        fprintf(stderr, "ERRO: no máximo %d núcleos\n", IRQ_MAX_NUCLEOS);
+        exit(1);
+      }
+    } else if (strcmp(argv[argi], "-i") == 0 && argi + 1 < argc) {
+      le_positivo(argv[++argi], "intervalo do relógio",
+                  &cfg->so.intervalo_interrupcao);
+    } else if (strcmp(argv[argi], "-q") == 0 && argi + 1 < argc) {
+      le_positivo(argv[++argi], "quantum", &cfg->so.quantum);
+    } else if (strcmp(argv[argi], "-e") == 0 && argi + 1 < argc) {
+      argi++;
+      if (!so_escalonador_por_nome(argv[argi], &cfg->so.escalonador)) {
+        fprintf(stderr, "ERRO: escalonador desconhecido: '%s'\n", argv[argi]);
+        exit(1);
+      }
+    } else if (strcmp(argv[argi], "-E") == 0 && argi + 1 < argc) {
+      FILE *arq;
+      int intervalo = INTERVALO_ENTRADA;
+      int t = le_arquivo_terminal(argv[++argi], "r", &arq, &intervalo);
+      if (cfg->entrada[t] != NULL) fclose(cfg->entrada[t]);
+      cfg->entrada[t] = arq;
+      cfg->intervalo_entrada[t] = intervalo;
+    } else if (strcmp(argv[argi], "-S") == 0 && argi + 1 < argc) {
+      FILE *arq;
+      int t = le_arquivo_terminal(argv[++argi], "w", &arq, NULL);
+      if (cfg->saida[t] != NULL) fclose(cfg->saida[t]);
+      cfg->saida[t] = arq;
+    } else if (strcmp(argv[argi], "-v") == 0 && argi + 1 < argc) {
+      argi++;
+      if (!console_nivel_por_nome(argv[argi], &cfg->nivel)) {
+        fprintf(stderr, "ERRO: nível de mensagem desconhecido: '%s'\n",
+                argv[argi]);
+        exit(1);
+      }
+    } else if (strcmp(argv[argi], "-r") == 0 && argi + 1 < argc) {
+      cfg->rastro = argv[++argi];
+      char *dois_pontos = strrchr(cfg->rastro, ':');
+      if (dois_pontos != NULL) {
+        *dois_pontos = '\0';
+        if (!rastro_categorias_por_nome(dois_pontos + 1,
+                                        &cfg->categorias_rastro)) {
+          fprintf(stderr, "ERRO: categoria de rastro desconhecida: '%s'\n",
+                  dois_pontos + 1);
+          exit(1);
+        }
+      }
+    } else {
+      fprintf(stderr, "ERRO: chame como '%s [-l] [-m tam] [-c n] [-i instr]"
+                      " [-q quantum] [-e escalonador] [-E t=arq[,intervalo]]"
+                      " [-S t=arq] [-r arq[:categorias]] [-v nivel]'\n", argv[0]);
+      exit(1);
+    }
+  }
+}
+
+int main(int argc, char *argv[argc])
 {
   hardware_t hw;
+  config_t cfg;
   so_t *so;
 
+  verifica_args(argc, argv, &cfg);
+
   // cria o hardware
-  cria_hardware(&hw);
+  cria_hardware(&hw, &cfg);
+  // os relógios dos núcleos avançam juntos, o do núcleo 0 é a base de tempo
+  //   do rastro de todos
+  if (cfg.rastro != NULL
+      && !rastro_inicia(cfg.rastro, cfg.categorias_rastro, hw.relogio[0])) {
+    console_printf("não foi possível criar o rastro '%s'", cfg.rastro);
+  }
   // cria o sistema operacional
-  so = so_cria(hw.cpu, hw.mem, hw.es, hw.console);
+  so = so_cria(hw.n_nucleos, hw.cpu, hw.mem, hw.es, hw.console, &cfg.so);
   
   // executa o laço principal do controlador
   controle_laco(hw.controle);
 
   // destroi tudo
   so_destroi(so);
+  rastro_termina();
   destroi_hardware(&hw);
 }
 
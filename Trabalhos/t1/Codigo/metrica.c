@@ -2,17 +2,43 @@
 #include "processo.h"
 #include "console.h"
 #include "so.h"
+#include "tabproc.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
 
 // Inicializa as métricas do sistema operacional
 void inicializa_metricas(so_t *self) {
     self->metricas.tempo_total_execucao = 0;
     self->metricas.tempo_total_ocioso = 0;
     self->metricas.num_preempcoes = 0;
+    self->metricas.num_roubos = 0;
 
     for (int i = 0; i < QTD_IRQ; i++) {
         self->metricas.num_interrupcoes[i] = 0;
     }
+
+    self->metricas.terminados = NULL;
+    self->metricas.num_terminados = 0;
+    self->metricas.cap_terminados = 0;
+}
+
+void metricas_registra_terminado(so_t *self, processo_t *proc) {
+    so_metricas_t *m = &self->metricas;
+    if (m->num_terminados == m->cap_terminados) {
+        m->cap_terminados = m->cap_terminados == 0 ? 16 : 2 * m->cap_terminados;
+        m->terminados = realloc(m->terminados, m->cap_terminados * sizeof(metricas_terminado_t));
+        assert(m->terminados != NULL);
+    }
+    metricas_terminado_t *reg = &m->terminados[m->num_terminados++];
+    reg->pid = proc->pid;
+    reg->relogio_termino = self->relogio_atual;
+    reg->metricas = proc->metricas;
+}
+
+void metricas_destroi(so_t *self) {
+    free(self->metricas.terminados);
+    self->metricas.terminados = NULL;
 }
 
 // Salva as métricas relacionadas às interrupções
@@ -27,7 +53,7 @@ static void salva_metricas_interrupcoes(FILE *file, const so_t *self) {
 }
 
 // Salva as métricas de um processo específico
-static void salva_metricas_processo(FILE *file, const processo_t *proc) {
+static void salva_metricas_processo(FILE *file, const metricas_terminado_t *proc) {
     fprintf(file, "\nPROCESSO %d\n", proc->pid);
     fprintf(file, "| %-23s | %-10s |\n", "MÉTRICA", "VALOR");
     fprintf(file, "|------------------------|------------|\n");
@@ -47,11 +73,18 @@ static void salva_metricas_processo(FILE *file, const processo_t *proc) {
     }
 }
 
+// Compara as métricas de dois processos pelo pid, para qsort
+static int compara_pid(const void *a, const void *b) {
+    const metricas_terminado_t *pa = a;
+    const metricas_terminado_t *pb = b;
+    return pa->pid - pb->pid;
+}
+
 // Salva todas as métricas do sistema e processos no arquivo especificado
 void so_salva_metricas(so_t *self, const char *filename) {
     FILE *file = fopen(filename, "w");
     if (!file) {
-        console_printf("Erro ao abrir o arquivo %s para escrita.\n", filename);
+        console_log(NIVEL_ERRO, "Erro ao abrir o arquivo %s para escrita.\n", filename);
         return;
     }
 
@@ -62,14 +95,36 @@ void so_salva_metricas(so_t *self, const char *filename) {
     fprintf(file, "| TEMPO TOTAL DE EXECUÇÃO       | %-10d |\n", self->metricas.tempo_total_execucao);
     fprintf(file, "| TEMPO TOTAL OCIOSO            | %-10d |\n", self->metricas.tempo_total_ocioso);
     fprintf(file, "| NÚMERO DE PREEMPÇÕES          | %-10d |\n", self->metricas.num_preempcoes);
+    fprintf(file, "| NÚMERO DE NÚCLEOS             | %-10d |\n", self->n_nucleos);
+    fprintf(file, "| PROCESSOS ROUBADOS            | %-10d |\n", self->metricas.num_roubos);
 
     salva_metricas_interrupcoes(file, self);
 
     fprintf(file, "\nMÉTRICAS DOS PROCESSOS:\n");
-    for (int i = 0; i < self->numero_processos; i++) {
-        salva_metricas_processo(file, self->processos[i]);
+    // junta os processos vivos e os que terminaram, em ordem de pid
+    int num_vivos = tabproc_tam(self->tabela_processos);
+    int num = num_vivos + self->metricas.num_terminados;
+    metricas_terminado_t *todos = malloc((num > 0 ? num : 1) * sizeof(*todos));
+    assert(todos != NULL);
+    for (int i = 0; i < num_vivos; i++) {
+        processo_t *proc = tabproc_processo(self->tabela_processos, i);
+        todos[i].pid = proc->pid;
+        todos[i].relogio_termino = self->relogio_atual;
+        todos[i].metricas = proc->metricas;
+    }
+    for (int i = 0; i < self->metricas.num_terminados; i++) {
+        metricas_terminado_t *reg = &todos[num_vivos + i];
+        *reg = self->metricas.terminados[i];
+        // desde que terminou, o processo esteve no estado MORTO
+        reg->metricas.estados[ESTADO_TERMINADO].tempo_total +=
+            self->relogio_atual - reg->relogio_termino;
+    }
+    qsort(todos, num, sizeof(*todos), compara_pid);
+    for (int i = 0; i < num; i++) {
+        salva_metricas_processo(file, &todos[i]);
     }
+    free(todos);
 
     fclose(file);
-    console_printf("Métricas salvas no arquivo %s com sucesso.\n", filename);
+    console_log(NIVEL_INFO, "Métricas salvas no arquivo %s com sucesso.\n", filename);
 }
@@ -4,8 +4,21 @@
 #include "so.h"     
 #include "processo.h"
 
+// métricas de um processo que terminou, guardadas quando o seu descritor é
+//   liberado, para o relatório final
+typedef struct metricas_terminado_t {
+    int pid;
+    // relógio quando o processo terminou; o tempo no estado MORTO continua
+    //   contando até o relatório
+    int relogio_termino;
+    processo_metricas_t metricas;
+} metricas_terminado_t;
+
 // Funções de métricas
 void inicializa_metricas(so_t *self);
 void so_salva_metricas(so_t *self, const char *filename);
+// guarda as métricas do processo, que terminou e vai ser liberado
+void metricas_registra_terminado(so_t *self, processo_t *proc);
+void metricas_destroi(so_t *self);
 
 #endif // METRICA_H
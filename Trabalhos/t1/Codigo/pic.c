@@ -0,0 +1,150 @@
+// pic.c
+// controlador de interrupções
+// simulador de computador
+// so24b
+
+#include "pic.h"
+
+#include <stdlib.h>
+#include <assert.h>
+
+struct pic_t {
+  // para cada linha, as origens com pedido pendente (um bit para cada)
+  unsigned origens[N_IRQ];
+  // linhas com algum pedido pendente (bit irq ligado se origens[irq] != 0)
+  unsigned pendentes;
+  // linhas mascaradas
+  unsigned mascara;
+  // prioridade de cada linha, e a linha selecionada para alterá-la
+  int prioridade[N_IRQ];
+  int linha;
+  // o número do núcleo deste controlador e os controladores de todos os
+  //   núcleos, para PIC_ACORDA
+  int nucleo;
+  pic_t **pics;
+  int n_nucleos;
+};
+
+pic_t *pic_cria(void)
+{
+  pic_t *self = malloc(sizeof(*self));
+  assert(self != NULL);
+
+  for (int irq = 0; irq < N_IRQ; irq++) {
+    self->origens[irq] = 0;
+    self->prioridade[irq] = 0;
+  }
+  self->pendentes = 0;
+  self->mascara = 0;
+  self->linha = 0;
+  self->nucleo = 0;
+  self->pics = NULL;
+  self->n_nucleos = 0;
+
+  return self;
+}
+
+void pic_destroi(pic_t *self)
+{
+  free(self);
+}
+
+void pic_liga_nucleos(pic_t *self, int nucleo, pic_t *pics[], int n_nucleos)
+{
+  assert(nucleo >= 0 && nucleo < n_nucleos && n_nucleos <= 32);
+  self->nucleo = nucleo;
+  self->pics = pics;
+  self->n_nucleos = n_nucleos;
+}
+
+void pic_pede(pic_t *self, irq_t irq, int origem)
+{
+  assert(irq >= 0 && irq < N_IRQ && origem >= 0 && origem < 32);
+  self->origens[irq] |= 1u << origem;
+  self->pendentes |= 1u << irq;
+}
+
+void pic_retira(pic_t *self, irq_t irq, int origem)
+{
+  assert(irq >= 0 && irq < N_IRQ && origem >= 0 && origem < 32);
+  self->origens[irq] &= ~(1u << origem);
+  if (self->origens[irq] == 0) self->pendentes &= ~(1u << irq);
+}
+
+int pic_irq_pendente(pic_t *self)
+{
+  // é chamada a cada instrução; quase sempre não tem nada pendente
+  unsigned candidatas = self->pendentes & ~self->mascara;
+  if (candidatas == 0) return -1;
+  int escolhida = -1;
+  for (int irq = 0; irq < N_IRQ; irq++) {
+    if ((candidatas & (1u << irq)) == 0) continue;
+    if (escolhida == -1
+        || self->prioridade[irq] > self->prioridade[escolhida]) {
+      escolhida = irq;
+    }
+  }
+  return escolhida;
+}
+
+// retorna as origens com pedido na linha, e reconhece os pedidos
+static int pic_reconhece(pic_t *self, int irq)
+{
+  int origens = self->origens[irq];
+  self->origens[irq] = 0;
+  self->pendentes &= ~(1u << irq);
+  return origens;
+}
+
+err_t pic_leitura(void *disp, int id, int *pvalor)
+{
+  pic_t *self = disp;
+  if (id >= 0 && id < N_IRQ) {
+    *pvalor = pic_reconhece(self, id);
+    return ERR_OK;
+  }
+  switch (id) {
+    case PIC_PENDENTES:
+      *pvalor = self->pendentes;
+      break;
+    case PIC_PROXIMA:
+      *pvalor = pic_irq_pendente(self);
+      break;
+    case PIC_MASCARA:
+      *pvalor = self->mascara;
+      break;
+    case PIC_LINHA:
+      *pvalor = self->linha;
+      break;
+    case PIC_PRIORIDADE:
+      *pvalor = self->prioridade[self->linha];
+      break;
+    default:
+      return ERR_END_INV;
+  }
+  return ERR_OK;
+}
+
+err_t pic_escrita(void *disp, int id, int valor)
+{
+  pic_t *self = disp;
+  switch (id) {
+    case PIC_MASCARA:
+      self->mascara = valor;
+      break;
+    case PIC_LINHA:
+      if (valor < 0 || valor >= N_IRQ) return ERR_OP_INV;
+      self->linha = valor;
+      break;
+    case PIC_PRIORIDADE:
+      self->prioridade[self->linha] = valor;
+      break;
+    case PIC_ACORDA:
+      if (valor < 0 || valor >= self->n_nucleos) return ERR_OP_INV;
+      pic_pede(self->pics[valor], IRQ_NUCLEO, self->nucleo);
+      break;
+    default:
+      return ERR_END_INV;
+  }
+  return ERR_OK;
+}
@@ -1,5 +1,7 @@
 #include "processo.h"
+#include "tabproc.h"
 #include "console.h"
+#include "rastro.h"
 #include <stdlib.h>
 
 // Função auxiliar para verificar preempção
@@ -13,7 +15,7 @@ processo_t *aloca_processo()
     processo_t *proc = malloc(sizeof(processo_t));
     if (proc == NULL)
     {
-        console_printf("SO: erro ao alocar memória para o novo processo");
+        console_log(NIVEL_ERRO, "SO: erro ao alocar memória para o novo processo");
     }
     return proc;
 }
@@ -38,6 +40,19 @@ void inicializa_processo(processo_t *proc, int pid, int pc)
     }
 
     proc->metricas.estados[ESTADO_PRONTO].quantidade = 1;
+
+    proc->nucleo = 0;
+    proc->na_fila_prontos = false;
+    proc->anterior_pronto = NULL;
+    proc->proximo_pronto = NULL;
+    proc->tabela = NULL;
+    proc->indice_tabela = -1;
+    proc->indice_prontos_tabela = -1;
+    proc->indice_heap = -1;
+    proc->ordem_heap = 0;
+    proc->fila_espera = NULL;
+    proc->proximo_espera = NULL;
+    fila_espera_inicializa(&proc->esperando_fim);
 }
 
 void proc_muda_estado(processo_t *proc, estado_processo_t estado)
@@ -47,7 +62,87 @@ void proc_muda_estado(processo_t *proc, estado_processo_t estado)
         proc->metricas.quantidade_preempcoes++;
     }
 
-    console_printf("Processo PID: %d, estado: %s -> %s\n", proc->pid, estado_processo_para_string(proc->estado), estado_processo_para_string(estado));
+    console_log(NIVEL_DEPURACAO, "Processo PID: %d, estado: %s -> %s\n", proc->pid, estado_processo_para_string(proc->estado), estado_processo_para_string(estado));
     proc->metricas.estados[estado].quantidade++;
+    proc_define_estado(proc, estado);
+}
+
+void proc_define_estado(processo_t *proc, estado_processo_t estado)
+{
+    if (proc->tabela != NULL)
+    {
+        tabproc_muda_estado(proc->tabela, proc, estado);
+    }
+    RASTRO(RASTRO_PROCESSO, EV_ESTADO, proc->nucleo, proc->pid, proc->estado, estado);
     proc->estado = estado;
 }
+
+void fila_espera_inicializa(fila_espera_t *fila)
+{
+    fila->inicio = NULL;
+    fila->fim = NULL;
+}
+
+bool fila_espera_vazia(fila_espera_t *fila)
+{
+    return fila->inicio == NULL;
+}
+
+void fila_espera_insere(fila_espera_t *fila, processo_t *proc)
+{
+    proc->fila_espera = fila;
+    proc->proximo_espera = NULL;
+    if (fila->fim == NULL)
+    {
+        fila->inicio = proc;
+    }
+    else
+    {
+        fila->fim->proximo_espera = proc;
+    }
+    fila->fim = proc;
+}
+
+processo_t *fila_espera_remove_primeiro(fila_espera_t *fila)
+{
+    processo_t *proc = fila->inicio;
+    if (proc == NULL)
+    {
+        return NULL;
+    }
+    fila->inicio = proc->proximo_espera;
+    if (fila->inicio == NULL)
+    {
+        fila->fim = NULL;
+    }
+    proc->fila_espera = NULL;
+    proc->proximo_espera = NULL;
+    return proc;
+}
+
+void fila_espera_remove(fila_espera_t *fila, processo_t *proc)
+{
+    processo_t *anterior = NULL;
+    for (processo_t *atual = fila->inicio; atual != NULL; atual = atual->proximo_espera)
+    {
+        if (atual == proc)
+        {
+            if (anterior == NULL)
+            {
+                fila->inicio = atual->proximo_espera;
+            }
+            else
+            {
+                anterior->proximo_espera = atual->proximo_espera;
+            }
+            if (fila->fim == atual)
+            {
+                fila->fim = anterior;
+            }
+            proc->fila_espera = NULL;
+            proc->proximo_espera = NULL;
+            return;
+        }
+        anterior = atual;
+    }
+}
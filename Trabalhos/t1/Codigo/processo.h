@@ -39,12 +39,44 @@ typedef struct processo_t {
     float prioridade;
     int dado_pendente;
     processo_metricas_t metricas;
+    // núcleo em cuja fila de prontos o processo é colocado (o último em que
+    //   executou)
+    int nucleo;
+    // encadeamento na fila de prontos do SO
+    bool na_fila_prontos;
+    struct processo_t *anterior_pronto;
+    struct processo_t *proximo_pronto;
+    // tabela de processos em que o processo está (NULL se nenhuma), avisada
+    //   das mudanças de estado; posição do processo no vetor dessa tabela e
+    //   no heap de prontos por pid dela (-1 se não estiver)
+    struct tabproc_t *tabela;
+    int indice_tabela;
+    int indice_prontos_tabela;
+    // posição no heap de prontos (-1 se não estiver) e ordem de inserção nele
+    int indice_heap;
+    long ordem_heap;
+    // fila de espera em que o processo está bloqueado (NULL se nenhuma) e o
+    //   próximo processo nessa fila
+    fila_espera_t *fila_espera;
+    struct processo_t *proximo_espera;
+    // processos bloqueados esperando o fim deste
+    fila_espera_t esperando_fim;
 } processo_t;
 
 // Declarações de funções relacionadas a processos
 processo_t *aloca_processo();
 void inicializa_processo(processo_t *proc, int pid, int pc);
 void proc_muda_estado(processo_t *proc, estado_processo_t estado);
+// altera o estado sem contabilizar a mudança nas métricas do processo
+void proc_define_estado(processo_t *proc, estado_processo_t estado);
 const char *estado_processo_para_string(estado_processo_t estado);
 
+// Operações nas filas de espera (todas O(1), menos a remoção de um processo
+//   do meio da fila, que é linear no tamanho dessa fila)
+void fila_espera_inicializa(fila_espera_t *fila);
+bool fila_espera_vazia(fila_espera_t *fila);
+void fila_espera_insere(fila_espera_t *fila, processo_t *proc);
+processo_t *fila_espera_remove_primeiro(fila_espera_t *fila);
+void fila_espera_remove(fila_espera_t *fila, processo_t *proc);
+
 #endif // PROCESSOS_H
@@ -0,0 +1,105 @@
+// rastro.h
+// rastro binário de eventos da simulação
+// simulador de computador
+// so24b
+
+#ifndef RASTRO_H
+#define RASTRO_H
+
+// O rastro registra eventos da simulação (instruções executadas, entrada e
+//   saída de interrupções, chamadas de sistema, mudanças de estado e
+//   despacho de processos, faltas de página), cada um com o instante em que
+//   aconteceu (no relógio da simulação) e o núcleo em que aconteceu, em um
+//   arquivo binário.
+// Os relógios dos núcleos avançam juntos (ver controle.c), então o relógio
+//   de um deles (o do núcleo 0) é a base de tempo dos eventos de todos.
+// Os eventos são colocados em um buffer circular, e gravados no arquivo por
+//   uma thread separada, para que o custo de gravação não fique no caminho da
+//   simulação. Se o buffer encher, a simulação espera a gravação (nenhum
+//   evento é perdido).
+// O arquivo é convertido para o formato de eventos do Chrome (que pode ser
+//   visto em chrome://tracing ou https://ui.perfetto.dev) pelo programa
+//   decodifica_rastro.
+//
+// Os eventos são separados em categorias, que podem ser selecionadas na
+//   compilação (RASTRO_COMPILADAS, uma máscara de bits; o código das
+//   categorias que não estão na máscara é eliminado pelo compilador) e na
+//   execução (rastro_inicia). Os eventos são gerados pela macro RASTRO, que
+//   só avalia os argumentos se a categoria estiver ativa.
+
+#include "relogio.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// categorias de eventos (bits da máscara)
+#define RASTRO_INSTRUCAO 0x01  // cada instrução executada
+#define RASTRO_IRQ       0x02  // entrada e saída de interrupções
+#define RASTRO_CHAMADA   0x04  // chamadas de sistema
+#define RASTRO_PROCESSO  0x08  // mudanças de estado e despacho de processos
+#define RASTRO_MEMORIA   0x10  // faltas de página
+#define RASTRO_TODAS     0x1f
+
+// categorias compiladas (pode ser definido na linha de comando do compilador;
+//   0 elimina todo o rastro)
+#ifndef RASTRO_COMPILADAS
+#define RASTRO_COMPILADAS RASTRO_TODAS
+#endif
+
+// tipos de evento, com o significado dos argumentos
+// o núcleo é o da CPU, para os eventos da CPU, o que o SO está atendendo,
+//   para as chamadas e despachos, e o do processo, para as mudanças de estado
+typedef enum {
+  EV_INSTRUCAO,     // PC, opcode, modo da CPU
+  EV_IRQ_ENTRA,     // irq, PC interrompido
+  EV_IRQ_SAI,       // PC de retorno, modo de retorno
+  EV_CHAMADA,       // id da chamada, processo
+  EV_ESTADO,        // processo, estado anterior, estado novo
+  EV_DESPACHO,      // processo
+  EV_FALTA_PAGINA,  // processo, endereço virtual, página
+  N_EV
+} rastro_tipo_t;
+
+// um evento, como gravado no arquivo (na ordem de bytes da máquina)
+typedef struct {
+  int64_t instante;
+  int16_t tipo;
+  int16_t nucleo;
+  int32_t arg[3];
+} rastro_evento_t;
+
+// o arquivo começa com estes 8 bytes, seguidos dos eventos
+#define RASTRO_ASSINATURA "so24rst2"
+
+// categorias ativas na execução (só para uso da macro RASTRO)
+extern unsigned rastro_categorias;
+
+// true se os eventos da categoria 'cat' estão sendo registrados
+#define rastro_ativo(cat) \
+  ((RASTRO_COMPILADAS & (cat)) != 0 && (rastro_categorias & (cat)) != 0)
+
+// registra um evento do 'tipo', da categoria 'cat', no núcleo 'nucleo', se a
+//   categoria estiver ativa
+#define RASTRO(cat, tipo, nucleo, a, b, c) \
+  do { \
+    if (rastro_ativo(cat)) rastro_registra(tipo, nucleo, a, b, c); \
+  } while (0)
+
+// começa a registrar os eventos das categorias 'categorias' no arquivo
+//   'nome', com o instante de cada um lido de 'relogio' (o de um dos núcleos,
+//   que avançam juntos)
+// retorna false se não conseguir criar o arquivo
+bool rastro_inicia(char *nome, unsigned categorias, relogio_t *relogio);
+
+// grava os eventos pendentes, para de registrar e fecha o arquivo
+void rastro_termina(void);
+
+// registra um evento (use a macro RASTRO)
+void rastro_registra(rastro_tipo_t tipo, int nucleo, int a, int b, int c);
+
+// retorna a máscara de categorias correspondente a uma lista de nomes
+//   separados por vírgula (instrucao, irq, chamada, processo, memoria,
+//   todas), em *pcategorias; retorna false se algum nome não existir
+bool rastro_categorias_por_nome(char *nomes, unsigned *pcategorias);
+
+#endif // RASTRO_H
@@ -11,9 +11,14 @@
 #include "instrucao.h"
 #include "metrica.h"
 #include "processo.h"
+#include "heap_prontos.h"
+#include "tabproc.h"
+#include "rastro.h"
 
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
 
 /**
  * @brief Retorna uma string representando o estado de um processo.
@@ -78,7 +83,7 @@ static void atualiza_metricas_processo(processo_t *self, int dif_tempo) {
     }
 
     // Imprime informações de depuração no console
-    console_printf(
+    console_log(NIVEL_DETALHE,
         "Processo PID: %d, Tempo: %d, Estado: %s\n",
         self->pid,
         self->metricas.estados[self->estado].tempo_total,
@@ -91,7 +96,8 @@ static void atualiza_metricas_processo(processo_t *self, int dif_tempo) {
  * 
  * Essa função realiza as seguintes atualizações:
  * - Incrementa o tempo total de execução do sistema.
- * - Incrementa o tempo ocioso do sistema se nenhum processo estiver em execução.
+ * - Incrementa o tempo ocioso do sistema pelos núcleos sem processo em execução
+ *   (com mais de um núcleo, o tempo ocioso é a soma do tempo ocioso de cada um).
  * - Atualiza as métricas individuais de cada processo.
  * 
  * @param self Ponteiro para o sistema operacional (`so_t`).
@@ -101,16 +107,17 @@ static void atualiza_metricas_sistema(so_t *self, int dif_tempo) {
     // Incrementa o tempo total de execução do sistema
     self->metricas.tempo_total_execucao += dif_tempo;
 
-    // Verifica se o sistema está ocioso (nenhum processo em execução)
-    if (self->processo_corrente == NULL) {
-        self->metricas.tempo_total_ocioso += dif_tempo;
+    // Verifica quais núcleos estão ociosos (nenhum processo em execução)
+    for (int n = 0; n < self->n_nucleos; n++) {
+        if (self->nucleos[n].processo_corrente == NULL) {
+            self->metricas.tempo_total_ocioso += dif_tempo;
+        }
     }
 
-    // Atualiza as métricas para cada processo
-    if (self->numero_processos > 0) { // Evita processamento desnecessário se não houver processos
-        for (int i = 0; i < self->numero_processos; i++) {
-            atualiza_metricas_processo(self->processos[i], dif_tempo);
-        }
+    // Atualiza as métricas para cada processo vivo (os que terminaram têm o
+    //   tempo no estado MORTO calculado no relatório)
+    for (int i = 0; i < tabproc_tam(self->tabela_processos); i++) {
+        atualiza_metricas_processo(tabproc_processo(self->tabela_processos, i), dif_tempo);
     }
 }
 
@@ -129,51 +136,52 @@ static bool copia_str_da_mem(int tam, char str[tam], mem_t *mem, int ender);
 // CRIAÇÃO {{{1
 
 /**
- * @brief Configura e inicializa a fila de processos prontos no sistema operacional.
+ * @brief Inicializa a fila de processos prontos de um núcleo.
  * 
- * Esta função aloca memória para a estrutura `fila_t`, que gerencia os processos prontos
- * para execução. Os ponteiros `inicio` e `fim` da fila são configurados como `NULL` para
- * indicar que a fila está inicialmente vazia.
- * Caso a alocação falhe, registra uma mensagem de erro e marca o sistema operacional
- * como estando em um estado de erro interno.
+ * A fila é intrusiva (os processos são encadeados por campos do próprio
+ * `processo_t`), então não há alocação de memória, nem na inicialização
+ * nem nas inserções e remoções.
  * 
- * @param self Ponteiro para o sistema operacional (`so_t`) que contém a fila de prontos.
+ * @param nucleo Ponteiro para o núcleo (`so_nucleo_t`) que contém a fila de prontos.
  */
-static void configura_fila_prontos(so_t *self) {
-    // Aloca memória para a estrutura da fila de processos prontos
-    self->fila_prontos = malloc(sizeof(fila_t));
-
-    // Verifica se a alocação de memória foi bem-sucedida
-    if (self->fila_prontos == NULL) {
-        // Registra uma mensagem de erro no sistema
-        console_printf("Erro: Não foi possível alocar memória para a fila de processos prontos.");
-
-        // Marca o sistema operacional como com erro interno
-        self->erro_interno = true;
-
-        // Libera a memória alocada para o sistema operacional e retorna
-        free(self);
-        return;
-    }
-
+static void configura_fila_prontos(so_nucleo_t *nucleo) {
     // Inicializa os ponteiros da fila como NULL (fila vazia)
-    self->fila_prontos->inicio = NULL;
-    self->fila_prontos->fim = NULL;
+    nucleo->fila_prontos.inicio = NULL;
+    nucleo->fila_prontos.fim = NULL;
+}
 
-    // Mensagem de depuração
-    console_printf("Erro: Não foi possível alocar memória para a fila de processos prontos.");
+// inicializa o estado do SO de um núcleo, que executa na CPU 'cpu' e acessa
+//   os dispositivos pelo controlador de E/S 'es'
+static void inicializa_nucleo(so_t *self, int id, cpu_t *cpu, es_t *es)
+{
+  so_nucleo_t *nucleo = &self->nucleos[id];
+  nucleo->so = self;
+  nucleo->id = id;
+  nucleo->cpu = cpu;
+  nucleo->es = es;
+  nucleo->processo_corrente = NULL;
+  configura_fila_prontos(nucleo);
+  nucleo->heap_prontos = heap_prontos_cria();
+  nucleo->quantum_proc = self->quantum;
+  nucleo->fim_quantum = 0;
+  nucleo->alarme = 0;
+  nucleo->acordando = false;
 }
 
 static void cpu_inicializa(so_t *self)
 {
-  // quando a CPU executar uma instrução CHAMAC, deve chamar a função
-  //   so_trata_interrupcao, com primeiro argumento um ptr para o SO
-  cpu_define_chamaC(self->cpu, so_trata_interrupcao, self);
+  // quando uma CPU executar uma instrução CHAMAC, deve chamar a função
+  //   so_trata_interrupcao, com primeiro argumento um ptr para o estado do
+  //   SO no núcleo dela (que aponta para o SO)
+  for (int n = 0; n < self->n_nucleos; n++) {
+    cpu_define_chamaC(self->nucleos[n].cpu, so_trata_interrupcao,
+                      &self->nucleos[n]);
+  }
 
   // coloca o tratador de interrupção na memória
   // quando a CPU aceita uma interrupção, passa para modo supervisor,
-  //   salva seu estado à partir do endereço 0, e desvia para o endereço
-  //   IRQ_END_TRATADOR
+  //   salva seu estado na área do seu núcleo (ver irq.h), e desvia para o
+  //   endereço IRQ_END_TRATADOR (o mesmo para todas as CPUs)
   // colocamos no endereço IRQ_END_TRATADOR o programa de tratamento
   //   de interrupção (escrito em asm). esse programa deve conter a
   //   instrução CHAMAC, que vai chamar so_trata_interrupcao (como
@@ -181,16 +189,13 @@ static void cpu_inicializa(so_t *self)
   int ender = so_carrega_programa(self, "trata_int.maq");
   if (ender != IRQ_END_TRATADOR)
   {
-    console_printf("SO: problema na carga do programa de tratamento de interrupção");
+    console_log(NIVEL_ERRO, "SO: problema na carga do programa de tratamento de interrupção");
     self->erro_interno = true;
   }
 
-  // programa o relógio para gerar uma interrupção após INTERVALO_INTERRUPCAO
-  if (es_escreve(self->es, D_RELOGIO_TIMER, INTERVALO_INTERRUPCAO) != ERR_OK)
-  {
-    console_printf("SO: problema na programação do timer");
-    self->erro_interno = true;
-  }
+  // o relógio não é programado aqui: o timer é de disparo único, e é
+  //   programado a cada despacho para quando o SO precisar dele (ver
+  //   so_programa_relogio)
 }
 
 /**
@@ -201,39 +206,48 @@ static void cpu_inicializa(so_t *self)
  * de entrada/saída e métricas. Caso qualquer etapa falhe, a memória alocada
  * é liberada e `NULL` é retornado.
  * 
- * @param cpu Ponteiro para a CPU do sistema.
- * @param mem Ponteiro para a memória principal do sistema.
- * @param es Ponteiro para os dispositivos de entrada/saída.
+ * @param n_nucleos Número de núcleos (CPUs) do sistema.
+ * @param cpu A CPU de cada núcleo.
+ * @param mem Ponteiro para a memória principal do sistema, compartilhada pelos núcleos.
+ * @param es O controlador dos dispositivos de entrada/saída de cada núcleo.
  * @param console Ponteiro para o console de depuração.
+ * @param config Configuração (intervalo do relógio, quantum e escalonador).
  * 
  * @return Ponteiro para a estrutura do sistema operacional ou `NULL` se a criação falhar.
  */
-so_t *so_cria(cpu_t *cpu, mem_t *mem, es_t *es, console_t *console) {
+so_t *so_cria(int n_nucleos, cpu_t *cpu[n_nucleos], mem_t *mem,
+              es_t *es[n_nucleos], console_t *console, so_config_t *config) {
     // Aloca memória para o sistema operacional
     so_t *self = malloc(sizeof(*self));
     if (self == NULL) {
-        console_printf("Erro: Falha ao alocar memória para o sistema operacional.");
+        console_log(NIVEL_ERRO, "Erro: Falha ao alocar memória para o sistema operacional.");
         return NULL;
     }
 
     // Inicializa os componentes básicos do SO
-    self->cpu = cpu;
     self->mem = mem;
-    self->es = es;
     self->console = console;
     self->erro_interno = false;
-    self->processo_corrente = NULL;
     self->pid_atual = 1;
-    self->quantum_proc = QUANTUM;
+    self->intervalo_interrupcao = config->intervalo_interrupcao;
+    self->quantum = config->quantum;
     self->numero_processos = 0;
     self->relogio_atual = -1;
+    self->escalonador = config->escalonador;
 
-    // Inicializa a fila de processos prontos
-    configura_fila_prontos(self);
-    if (self->erro_interno) {
-        console_printf("Erro: Falha ao configurar a fila de processos prontos.");
-        free(self);
-        return NULL;
+    // Inicializa o estado de cada núcleo, com a sua fila de processos prontos
+    self->n_nucleos = n_nucleos;
+    for (int n = 0; n < n_nucleos; n++) {
+        inicializa_nucleo(self, n, cpu[n], es[n]);
+    }
+    // até a primeira interrupção, o SO age pelo núcleo 0
+    self->nucleo = &self->nucleos[0];
+    self->tabela_processos = tabproc_cria();
+
+    // Inicializa as filas de espera pelos terminais
+    for (int t = 0; t < NUM_TERMINAIS; t++) {
+        fila_espera_inicializa(&self->espera_teclado[t]);
+        fila_espera_inicializa(&self->espera_tela[t]);
     }
 
     // Inicializa métricas
@@ -242,14 +256,20 @@ so_t *so_cria(cpu_t *cpu, mem_t *mem, es_t *es, console_t *console) {
     // Inicializa a CPU
   cpu_inicializa(self);
     if (self->erro_interno) {
-    console_printf("Erro: Falha ao inicializar a CPU.");
-    free(self->fila_prontos); // Libera a memória da fila de processos prontos
+    console_log(NIVEL_ERRO, "Erro: Falha ao inicializar a CPU.");
+    for (int n = 0; n < n_nucleos; n++) {
+      heap_prontos_destroi(self->nucleos[n].heap_prontos);
+    }
+    tabproc_destroi(self->tabela_processos);
     free(self);               // Libera o próprio objeto do sistema operacional
     return NULL;
   } 
 
     // Mensagem de sucesso
-    console_printf("Info: Sistema operacional criado com sucesso.");
+    console_log(NIVEL_INFO, "Info: Sistema operacional criado com sucesso.");
+    console_log(NIVEL_INFO, "Info: escalonador %s, quantum %d, intervalo do relógio %d, %d núcleo(s)",
+                so_nome_escalonador(self->escalonador), self->quantum,
+                self->intervalo_interrupcao, self->n_nucleos);
 
     return self;
 }
@@ -268,34 +288,50 @@ void so_destroi(so_t *self) {
         return; // Proteção contra ponteiro nulo
     }
 
-    // Redefine o tratador de interrupções da CPU
-    cpu_define_chamaC(self->cpu, NULL, NULL);
-
-    // Libera a memória alocada para os processos
-    if (self->processos != NULL) {
-        for (int i = 0; i < self->numero_processos; i++) {
-            if (self->processos[i] != NULL) {
-                free(self->processos[i]);
-            }
-        }
-        free(self->processos);
+    // Redefine o tratador de interrupções das CPUs e libera as filas de
+    //   prontos de cada núcleo
+    for (int n = 0; n < self->n_nucleos; n++) {
+        cpu_define_chamaC(self->nucleos[n].cpu, NULL, NULL);
+        heap_prontos_destroi(self->nucleos[n].heap_prontos);
     }
 
-    // Libera a memória da fila de processos prontos
-    if (self->fila_prontos != NULL) {
-        no_fila_t *no_atual = self->fila_prontos->inicio;
-        while (no_atual != NULL) {
-            no_fila_t *no_proximo = no_atual->proximo;
-            free(no_atual); // Libera o nó atual
-            no_atual = no_proximo;
-        }
-        free(self->fila_prontos); // Libera a estrutura da fila
+    // Libera a memória alocada para os processos
+    for (int i = 0; i < tabproc_tam(self->tabela_processos); i++) {
+        free(tabproc_processo(self->tabela_processos, i));
     }
+    tabproc_destroi(self->tabela_processos);
+    metricas_destroi(self);
 
     // Libera a memória do sistema operacional
     free(self);
 
-    console_printf("Info: Sistema operacional destruído com sucesso.");
+    console_log(NIVEL_INFO, "Info: Sistema operacional destruído com sucesso.");
+}
+
+// nomes dos escalonadores, indexados pelo número (o mesmo usado nos nomes
+//   dos arquivos metrica_escalonador_*.txt)
+static char *nomes_escalonadores[] = {
+    [1] = "prioridade",
+    [2] = "round-robin",
+    [3] = "simples",
+};
+#define N_ESCALONADORES (sizeof(nomes_escalonadores) / sizeof(nomes_escalonadores[0]))
+
+char *so_nome_escalonador(int escalonador) {
+    if (escalonador < 1 || escalonador >= N_ESCALONADORES) return "DESCONHECIDO";
+    return nomes_escalonadores[escalonador];
+}
+
+bool so_escalonador_por_nome(char *nome, int *pescalonador) {
+    for (int e = 1; e < N_ESCALONADORES; e++) {
+        char numero[12];
+        sprintf(numero, "%d", e);
+        if (strcmp(nome, nomes_escalonadores[e]) == 0 || strcmp(nome, numero) == 0) {
+            *pescalonador = e;
+            return true;
+        }
+    }
+    return false;
 }
 
 // TRATAMENTO DE INTERRUPÇÃO {{{1
@@ -303,12 +339,17 @@ void so_destroi(so_t *self) {
 // funções auxiliares para o tratamento de interrupção
 static void salva_estado_cpu_no_processo(so_t *self);
 static void so_trata_irq(so_t *self, int irq);
-static void so_trata_pendencias(so_t *self);
+static void so_trata_irqs_pendentes(so_t *self, int irq_atendida);
 static void so_escalona(so_t *self, int escalonador);
 static void escalonador_simples(so_t *self);
 static void escalonador_round_robin(so_t *self);
 static void escalonador_prioridade(so_t *self);
 static int so_despacha(so_t *self);
+static void so_atualiza_quantum(so_t *self);
+static void so_programa_relogio(so_t *self);
+static void so_termina_processo(so_t *self, processo_t *proc);
+static void so_acorda_nucleos(so_t *self);
+static void so_interrompe_nucleo(so_t *self, so_nucleo_t *nucleo);
 
 /**
  * @brief Finaliza as operações do sistema operacional.
@@ -325,27 +366,27 @@ static int so_despacha(so_t *self);
 static int finaliza_sistema(so_t *self) {
     // Verifica se o ponteiro do sistema operacional é válido
     if (self == NULL) {
-        console_printf("Erro: Ponteiro do sistema operacional é nulo.\n");
+        console_log(NIVEL_ERRO, "Erro: Ponteiro do sistema operacional é nulo.\n");
         return 1; // Retorna imediatamente para evitar comportamento inesperado
     }
 
     // Desativa o timer
-    err_t e1 = es_escreve(self->es, D_RELOGIO_TIMER, 0);
+    err_t e1 = es_escreve(self->nucleo->es, D_RELOGIO_TIMER, 0);
 
     // Desativa o sinalizador de interrupção
-    err_t e2 = es_escreve(self->es, D_RELOGIO_INTERRUPCAO, 0);
+    err_t e2 = es_escreve(self->nucleo->es, D_RELOGIO_INTERRUPCAO, 0);
 
     // Verifica se ambas as operações foram bem-sucedidas
     if (e1 != ERR_OK || e2 != ERR_OK) {
-        console_printf("SO: Não foi possível desligar o timer ou o sinalizador de interrupção!\n");
+        console_log(NIVEL_ERRO, "SO: Não foi possível desligar o timer ou o sinalizador de interrupção!\n");
         self->erro_interno = true; // Marca erro interno
     } else {
-        console_printf("SO: Timer e sinalizador de interrupção desativados com sucesso.\n");
+        console_log(NIVEL_INFO, "SO: Timer e sinalizador de interrupção desativados com sucesso.\n");
     }
 
     // Salva as métricas finais no arquivo especificado
     so_salva_metricas(self, "metricas_final.txt");
-    console_printf("SO: Métricas finais salvas no arquivo 'metricas_final.txt'.\n");
+    console_log(NIVEL_INFO, "SO: Métricas finais salvas no arquivo 'metricas_final.txt'.\n");
 
     // Retorna 1 indicando que a função foi concluída
     return 1;
@@ -366,9 +407,9 @@ static void atualiza_metricas_com_relogio(so_t *self) {
     int r_anterior = self->relogio_atual;
 
     // Lê o valor atual do relógio de instruções
-    if (es_le(self->es, D_RELOGIO_INSTRUCOES, &self->relogio_atual) != ERR_OK) {
+    if (es_le(self->nucleo->es, D_RELOGIO_INSTRUCOES, &self->relogio_atual) != ERR_OK) {
         // Imprime uma mensagem de erro se a leitura falhar
-        console_printf("SO: erro na leitura do relógio\n");
+        console_log(NIVEL_ERRO, "SO: erro na leitura do relógio\n");
         return;
     }
 
@@ -391,17 +432,25 @@ static void atualiza_metricas_com_relogio(so_t *self) {
 //   a instrução CHAMAC
 // a instrução CHAMAC só deve ser executada pelo tratador de interrupção
 //
-// o primeiro argumento é um ponteiro para o SO, o segundo é a identificação
-//   da interrupção
+// o primeiro argumento é um ponteiro para o estado do SO no núcleo cuja CPU
+//   executou o CHAMAC, o segundo é a identificação da interrupção
+// cada entrada no SO executa por inteiro durante uma instrução (o CHAMAC) de
+//   um núcleo, então as entradas de núcleos diferentes não se sobrepõem
 // o valor retornado por esta função é colocado no registrador A, e pode ser
 //   testado pelo código que está após o CHAMAC. No tratador de interrupção em
 //   assembly esse valor é usado para decidir se a CPU deve retornar da interrupção
 //   (e executar o código de usuário) ou executar PARA e ficar suspensa até receber
 //   outra interrupção
 static int so_trata_interrupcao(void *argC, int reg_A) {
-    so_t *self = argC;
+    so_nucleo_t *nucleo = argC;
+    so_t *self = nucleo->so;
     irq_t irq = reg_A;
 
+    // O SO passa a agir pelo núcleo que foi interrompido; se tinha sido
+    //   acordado por outro, já foi
+    self->nucleo = nucleo;
+    nucleo->acordando = false;
+
     // Incrementa a contagem de interrupções do tipo atual
     self->metricas.num_interrupcoes[irq]++;
 
@@ -411,23 +460,34 @@ static int so_trata_interrupcao(void *argC, int reg_A) {
     // Atualiza métricas do sistema
     atualiza_metricas_com_relogio(self);
 
+    // Atualiza o quantum restante do processo corrente pelo relógio
+    so_atualiza_quantum(self);
+
     // Trata a interrupção com base no tipo de IRQ
-    so_trata_irq(self, irq);
+    // (a E/S pendente é atendida nas interrupções dos terminais, não é
+    //   verificada a cada interrupção)
+    // a chamada de sistema ou o erro de um processo que foi morto (por outro
+    //   núcleo) enquanto executava neste núcleo não é atendido
+    if ((irq == IRQ_SISTEMA || irq == IRQ_ERR_CPU)
+        && nucleo->processo_corrente == NULL) {
+        console_log(NIVEL_DEPURACAO, "SO: núcleo %d: %s de processo que já morreu",
+                    nucleo->id, irq_nome(irq));
+    } else {
+        so_trata_irq(self, irq);
+    }
 
-    // Processa pendências independentes da interrupção
-    so_trata_pendencias(self);
+    // Trata as outras interrupções pendentes no controlador, sem sair do SO
+    so_trata_irqs_pendentes(self, irq);
 
     // Escolhe o próximo processo a executar
-    so_escalona(self, ESCALONADOR);
-
-    // Verifica se ainda há processos ativos
-    bool processos_ativos = false;
-    for (int i = 0; i < self->numero_processos; i++) {
-        if (self->processos[i]->estado != ESTADO_TERMINADO) {
-            processos_ativos = true;
-            break; // Encontrou um processo ativo, pode parar a verificação
-        }
-    }
+    so_escalona(self, self->escalonador);
+
+    // Acorda núcleos ociosos se sobraram processos prontos
+    so_acorda_nucleos(self);
+
+    // Verifica se ainda há processos ativos, pelos contadores da tabela
+    bool processos_ativos = tabproc_tam(self->tabela_processos)
+        - tabproc_num_no_estado(self->tabela_processos, ESTADO_TERMINADO) > 0;
 
     // Executa ou finaliza o sistema com base na verificação
     if (processos_ativos) {
@@ -437,6 +497,14 @@ static int so_trata_interrupcao(void *argC, int reg_A) {
     }
 }
 
+// retorna o endereço na memória onde a CPU do núcleo sendo atendido salvou o
+//   registrador 'campo' (um dos IRQ_END_*) ao aceitar a interrupção, e de onde
+//   vai recuperá-lo no retorno
+static int end_estado_salvo(so_t *self, int campo)
+{
+  return IRQ_END_AREA(self->nucleo->id) + campo;
+}
+
 /**
  * @brief Salva o estado da CPU no processo corrente.
  * 
@@ -451,21 +519,21 @@ static int so_trata_interrupcao(void *argC, int reg_A) {
  */
 static void salva_estado_cpu_no_processo(so_t *self) {
     // Verifica se há um processo corrente
-    if (self->processo_corrente == NULL) {
+    if (self->nucleo->processo_corrente == NULL) {
         return; // Nenhuma operação necessária
     }
 
     // Lê e armazena o valor do PC (program counter) no processo corrente
-    if (mem_le(self->mem, IRQ_END_PC, &self->processo_corrente->pc) != ERR_OK) {
-        console_printf("SO: erro ao salvar o PC no processo corrente.\n");
+    if (mem_le(self->mem, end_estado_salvo(self, IRQ_END_PC), &self->nucleo->processo_corrente->pc) != ERR_OK) {
+        console_log(NIVEL_ERRO, "SO: erro ao salvar o PC no processo corrente.\n");
     }
 
     // Lê e armazena os registradores de propósito geral no processo corrente
-    if (mem_le(self->mem, IRQ_END_A, &self->processo_corrente->reg[0]) != ERR_OK) {
-        console_printf("SO: erro ao salvar o registrador A no processo corrente.\n");
+    if (mem_le(self->mem, end_estado_salvo(self, IRQ_END_A), &self->nucleo->processo_corrente->reg[0]) != ERR_OK) {
+        console_log(NIVEL_ERRO, "SO: erro ao salvar o registrador A no processo corrente.\n");
     }
-    if (mem_le(self->mem, IRQ_END_X, &self->processo_corrente->reg[1]) != ERR_OK) {
-        console_printf("SO: erro ao salvar o registrador X no processo corrente.\n");
+    if (mem_le(self->mem, end_estado_salvo(self, IRQ_END_X), &self->nucleo->processo_corrente->reg[1]) != ERR_OK) {
+        console_log(NIVEL_ERRO, "SO: erro ao salvar o registrador X no processo corrente.\n");
     }
 }
 
@@ -478,100 +546,157 @@ static int calcular_endereco_dispositivo(int disp, int terminal)
     return disp + terminal * MULTIPLICADOR_TERMINAL;
 }
 
+// o escalonador por prioridade (1) usa o heap como fila de prontos, os
+//   outros usam a fila
+static bool usa_heap_prontos(so_t *self)
+{
+  return self->escalonador == 1;
+}
+
+// insere o processo no final da fila de prontos do seu núcleo
+// não faz nada se ele já estiver na fila
 static void insere_na_fila_prontos(so_t *self, processo_t *proc)
 {
-  no_fila_t *novo_no = malloc(sizeof(no_fila_t));
-  if (novo_no == NULL)
+  so_nucleo_t *nucleo = &self->nucleos[proc->nucleo];
+  fila_t *fila = &nucleo->fila_prontos;
+  if (usa_heap_prontos(self))
   {
-    console_printf("SO: erro ao alocar memória para a fila de processos prontos");
-    self->erro_interno = true;
+    if (!heap_prontos_contem(nucleo->heap_prontos, proc))
+    {
+      heap_prontos_insere(nucleo->heap_prontos, proc);
+    }
     return;
   }
-  novo_no->processo = proc;
-  novo_no->proximo = NULL;
+  if (proc->na_fila_prontos)
+  {
+    return;
+  }
+  proc->na_fila_prontos = true;
+  proc->anterior_pronto = fila->fim;
+  proc->proximo_pronto = NULL;
 
-  if (self->fila_prontos->fim == NULL)
+  if (fila->fim == NULL)
   {
-    self->fila_prontos->inicio = novo_no;
+    fila->inicio = proc;
   }
   else
   {
-    self->fila_prontos->fim->proximo = novo_no;
+    fila->fim->proximo_pronto = proc;
   }
-  self->fila_prontos->fim = novo_no;
+  fila->fim = proc;
 }
 
-static void so_trata_pendencias(so_t *self)
+// retira o processo da fila de prontos do seu núcleo, de qualquer posição
+// não faz nada se ele não estiver na fila
+static void remove_processo_da_fila_prontos(so_t *self, processo_t *proc)
 {
-  for (int i = 0; self->processos[i] != NULL; i++)
+  so_nucleo_t *nucleo = &self->nucleos[proc->nucleo];
+  fila_t *fila = &nucleo->fila_prontos;
+  if (usa_heap_prontos(self))
   {
-    processo_t *proc = self->processos[i];
+    heap_prontos_remove(nucleo->heap_prontos, proc);
+    return;
+  }
+  if (!proc->na_fila_prontos)
+  {
+    return;
+  }
+  if (proc->anterior_pronto == NULL)
+  {
+    fila->inicio = proc->proximo_pronto;
+  }
+  else
+  {
+    proc->anterior_pronto->proximo_pronto = proc->proximo_pronto;
+  }
+  if (proc->proximo_pronto == NULL)
+  {
+    fila->fim = proc->anterior_pronto;
+  }
+  else
+  {
+    proc->proximo_pronto->anterior_pronto = proc->anterior_pronto;
+  }
+  proc->na_fila_prontos = false;
+  proc->anterior_pronto = NULL;
+  proc->proximo_pronto = NULL;
+}
 
-    if (proc->estado == ESTADO_BLOQUEADO)
-    {
-      int terminal = obter_terminal_por_pid(proc->pid);
-      int dispositivo_teclado = calcular_endereco_dispositivo(D_TERM_A_TECLADO_OK, terminal);
-      int dispositivo_tela = calcular_endereco_dispositivo(D_TERM_A_TELA_OK, terminal);
+// bloqueia o processo, colocando-o na fila de espera do recurso que ele espera
+static void so_bloqueia_processo(so_t *self, processo_t *proc,
+                                 motivo_bloq_processo_t motivo, fila_espera_t *fila)
+{
+  proc_muda_estado(proc, ESTADO_BLOQUEADO);
+  proc->motivo_bloqueio = motivo;
+  fila_espera_insere(fila, proc);
+  console_log(NIVEL_DEPURACAO, "SO: processo %d bloqueado no núcleo %d", proc->pid, self->nucleo->id);
+}
 
-      int estado_teclado, estado_tela;
+// desbloqueia um processo que já foi retirado da sua fila de espera
+static void so_desbloqueia_processo(so_t *self, processo_t *proc)
+{
+  proc_muda_estado(proc, ESTADO_PRONTO);
+  insere_na_fila_prontos(self, proc);
+  console_log(NIVEL_DEPURACAO, "SO: processo %d desbloqueado e inserido na fila de prontos", proc->pid);
+}
 
-      switch (proc->motivo_bloqueio)
-      {
-      case BLOQUEIO_POR_LEITURA:
-        // se o dispositivo de teclado está pronto, le
-        if (es_le(self->es, dispositivo_teclado, &estado_teclado) == ERR_OK && estado_teclado != 0)
-        {
-          proc_muda_estado(proc, ESTADO_PRONTO);
-        }
-        break;
-      case BLOQUEIO_POR_ESCRITA:
-        // se o dispositivo de tela está pronto, escreve
-        if (es_le(self->es, dispositivo_tela, &estado_tela) == ERR_OK && estado_tela != 0)
-        {
-          if (es_escreve(self->es, calcular_endereco_dispositivo(D_TERM_A_TELA, terminal), proc->dado_pendente) == ERR_OK)
-          {
-            proc_muda_estado(proc, ESTADO_PRONTO);
-          }
-        }
-        break;
-      case BLOQUEIO_POR_ESPERA_DE_PROC:
-        // verifica se o processo esperado já morreu
-        for (int j = 0; self->processos[j] != NULL; j++)
-        {
-          if (self->processos[j]->pid == proc->reg[0] && self->processos[j]->estado == ESTADO_TERMINADO)
-          {
-            proc_muda_estado(proc, ESTADO_PRONTO);
-            break;
-          }
-        }
-        break;
-      default:
-        break;
-      }
+// desbloqueia os processos esperando pelo teclado do terminal, se ele estiver pronto
+static void desbloqueia_espera_teclado(so_t *self, int terminal)
+{
+  fila_espera_t *fila = &self->espera_teclado[terminal];
+  int dispositivo_teclado_ok = calcular_endereco_dispositivo(D_TERM_A_TECLADO_OK, terminal);
+  int dispositivo_teclado = calcular_endereco_dispositivo(D_TERM_A_TECLADO, terminal);
+  int estado_teclado;
+  while (!fila_espera_vazia(fila)
+         && es_le(self->nucleo->es, dispositivo_teclado_ok, &estado_teclado) == ERR_OK
+         && estado_teclado != 0)
+  {
+    // completa o SO_LE do processo: o dado lido é o retorno da chamada
+    if (es_le(self->nucleo->es, dispositivo_teclado, &fila->inicio->reg[0]) != ERR_OK)
+    {
+      break;
+    }
+    so_desbloqueia_processo(self, fila_espera_remove_primeiro(fila));
+  }
+}
 
-      if (proc->estado == ESTADO_PRONTO)
-      {
-        insere_na_fila_prontos(self, proc);
-        console_printf("SO: processo %d desbloqueado e inserido na fila de prontos", proc->pid);
-      }
+// escreve o dado pendente dos processos esperando pela tela do terminal,
+//   enquanto ela estiver pronta, e os desbloqueia
+static void desbloqueia_espera_tela(so_t *self, int terminal)
+{
+  fila_espera_t *fila = &self->espera_tela[terminal];
+  int dispositivo_tela_ok = calcular_endereco_dispositivo(D_TERM_A_TELA_OK, terminal);
+  int dispositivo_tela = calcular_endereco_dispositivo(D_TERM_A_TELA, terminal);
+  int estado_tela;
+  while (!fila_espera_vazia(fila)
+         && es_le(self->nucleo->es, dispositivo_tela_ok, &estado_tela) == ERR_OK
+         && estado_tela != 0)
+  {
+    if (es_escreve(self->nucleo->es, dispositivo_tela, fila->inicio->dado_pendente) != ERR_OK)
+    {
+      break;
     }
+    so_desbloqueia_processo(self, fila_espera_remove_primeiro(fila));
   }
 }
+
 static void atualiza_estado_processo_corrente(so_t *self)
 {
-  if (self->processo_corrente != NULL)
+  if (self->nucleo->processo_corrente != NULL)
   {
-    console_printf("SO: escalonando, processo corrente %d, estado %s", self->processo_corrente->pid, estado_processo_para_string(self->processo_corrente->estado));
-    if (self->processo_corrente->estado == ESTADO_PRONTO)
-      self->processo_corrente->estado = ESTADO_INICIALIZANDO;
+    console_log(NIVEL_DEPURACAO, "SO: escalonando, processo corrente %d, estado %s", self->nucleo->processo_corrente->pid, estado_processo_para_string(self->nucleo->processo_corrente->estado));
+    if (self->nucleo->processo_corrente->estado == ESTADO_PRONTO)
+      proc_define_estado(self->nucleo->processo_corrente, ESTADO_INICIALIZANDO);
   }
 }
 
 static void atualiza_prioridade(so_t *self)
 {
-  if (self->processo_corrente != NULL)
+  if (self->nucleo->processo_corrente != NULL)
   {
-    self->processo_corrente->prioridade = self->processo_corrente->prioridade + (QUANTUM - self->quantum_proc) / (float)QUANTUM / 2;
+    self->nucleo->processo_corrente->prioridade = self->nucleo->processo_corrente->prioridade + (self->quantum - self->nucleo->quantum_proc) / (float)self->quantum / 2;
+    // se estiver na fila de prontos, a sua posição pode ter mudado
+    heap_prontos_atualiza(self->nucleo->heap_prontos, self->nucleo->processo_corrente);
   }
 }
 
@@ -594,58 +719,40 @@ static void so_escalona(so_t *self, int escalonador)
     break;
     self->erro_interno = true;
   }
-  if (self->processo_corrente != NULL)
-    console_printf("SO: escalonado, processo corrente %d, estado %s", self->processo_corrente->pid, estado_processo_para_string(self->processo_corrente->estado));
+  if (self->nucleo->processo_corrente != NULL)
+    console_log(NIVEL_DEPURACAO, "SO: escalonado, processo corrente %d, estado %s", self->nucleo->processo_corrente->pid, estado_processo_para_string(self->nucleo->processo_corrente->estado));
 }
 
 static void so_executa_proc(so_t *self, processo_t *proc)
 {
-  if (self->processo_corrente != NULL && proc != NULL)
-    console_printf("--SO: processo %d, estado %s, processo_so %d, estado %s", proc->pid, estado_processo_para_string(proc->estado), self->processo_corrente->pid, estado_processo_para_string(self->processo_corrente->estado));
+  if (self->nucleo->processo_corrente != NULL && proc != NULL)
+    console_log(NIVEL_DEPURACAO, "--SO: processo %d, estado %s, processo_so %d, estado %s", proc->pid, estado_processo_para_string(proc->estado), self->nucleo->processo_corrente->pid, estado_processo_para_string(self->nucleo->processo_corrente->estado));
 
   if (
-      self->processo_corrente != NULL &&
-      self->processo_corrente != proc &&
-      self->processo_corrente->estado == ESTADO_INICIALIZANDO)
+      self->nucleo->processo_corrente != NULL &&
+      self->nucleo->processo_corrente != proc &&
+      self->nucleo->processo_corrente->estado == ESTADO_INICIALIZANDO)
   {
-    proc_muda_estado(self->processo_corrente, ESTADO_PRONTO);
+    proc_muda_estado(self->nucleo->processo_corrente, ESTADO_PRONTO);
     self->metricas.num_preempcoes++;
-    console_printf("SO: processo %d preempedido", self->processo_corrente->pid);
+    console_log(NIVEL_DEPURACAO, "SO: processo %d preempedido", self->nucleo->processo_corrente->pid);
   }
 
   if (proc != NULL && proc->estado != ESTADO_INICIALIZANDO)
   {
-    console_printf("SO: processo %d executando", proc->pid);
+    console_log(NIVEL_DEPURACAO, "SO: processo %d executando", proc->pid);
     proc_muda_estado(proc, ESTADO_INICIALIZANDO);
   }
 
-  self->processo_corrente = proc;
-  self->quantum_proc = QUANTUM;
-}
-
-/**
- * @brief Procura por um processo em um estado específico na lista de processos.
- * 
- * Essa função percorre a lista de processos e retorna o primeiro processo
- * que está no estado especificado. Caso nenhum processo esteja no estado buscado,
- * retorna `NULL`.
- * 
- * @param self Ponteiro para o sistema operacional (`so_t`).
- * @param estado O estado que estamos procurando (ex.: ESTADO_PRONTO, ESTADO_BLOQUEADO).
- * 
- * @return Ponteiro para o processo encontrado no estado especificado ou `NULL` se nenhum processo for encontrado.
- */
-static processo_t *obtem_processo_por_estado(so_t *self, estado_processo_t estado) {
-    // Percorre a lista de processos no SO
-    for (int i = 0; self->processos[i] != NULL; i++) {
-        // Verifica se o processo atual está no estado desejado
-        if (self->processos[i]->estado == estado) {
-            // Retorna o processo encontrado
-            return self->processos[i];
-        }
-    }
-    // Se nenhum processo no estado especificado foi encontrado, retorna NULL
-    return NULL;
+  // o processo passa a ser do núcleo em que executa (e volta para a fila de
+  //   prontos dele)
+  if (proc != NULL)
+  {
+    proc->nucleo = self->nucleo->id;
+  }
+  self->nucleo->processo_corrente = proc;
+  self->nucleo->quantum_proc = self->quantum;
+  self->nucleo->fim_quantum = self->relogio_atual + self->quantum * self->intervalo_interrupcao;
 }
 
 /**
@@ -653,51 +760,75 @@ static processo_t *obtem_processo_por_estado(so_t *self, estado_processo_t estad
  *
  * Este escalonador utiliza uma abordagem simples: seleciona o próximo processo
  * pronto para execução e o escalona. Caso não haja processos prontos, verifica se
- * há processos bloqueados. Se nenhum processo estiver disponível, o sistema operacional
+ * há processos bloqueados ou executando em outro núcleo; nesse caso o núcleo fica
+ * ocioso. Se nenhum processo estiver disponível, o sistema operacional
  * é configurado para parar, sinalizando que todos os processos finalizaram.
  *
  * @param sistema_operacional Ponteiro para o sistema operacional (SO).
  */
 static void escalonador_simples(so_t *sistema_operacional) {
     // Verifica se o processo corrente está executando
-    if (sistema_operacional->processo_corrente != NULL &&
-        sistema_operacional->processo_corrente->estado == ESTADO_INICIALIZANDO) {
+    if (sistema_operacional->nucleo->processo_corrente != NULL &&
+        sistema_operacional->nucleo->processo_corrente->estado == ESTADO_INICIALIZANDO) {
         return; // Processo atual continua executando
     }
 
-    // Obtém o próximo processo pronto para execução
-    processo_t *proximo_processo = obtem_processo_por_estado(sistema_operacional, ESTADO_PRONTO);
+    // Obtém o próximo processo pronto para execução: o de menor PID, que a
+    // tabela de processos mantém no topo de um heap
+    processo_t *proximo_processo = tabproc_primeiro_pronto(sistema_operacional->tabela_processos);
     if (proximo_processo != NULL) {
         so_executa_proc(sistema_operacional, proximo_processo);
         return; // Processo pronto encontrado e escalado
     }
 
-    // Verifica se há processos bloqueados
-    if (obtem_processo_por_estado(sistema_operacional, ESTADO_BLOQUEADO)) {
-        sistema_operacional->processo_corrente = NULL; // Nenhum processo pronto, mantém estado atual
+    // Verifica se há processos bloqueados, ou executando em outro núcleo (o
+    // deste não está executando)
+    tabproc_t *tabela = sistema_operacional->tabela_processos;
+    if (tabproc_num_no_estado(tabela, ESTADO_BLOQUEADO) > 0
+        || tabproc_num_no_estado(tabela, ESTADO_INICIALIZANDO) > 0) {
+        sistema_operacional->nucleo->processo_corrente = NULL; // Nenhum processo pronto, núcleo fica ocioso
     } else {
         // Nenhum processo restante, o sistema operacional será finalizado
-        console_printf("SO: todos os processos finalizaram, CPU parando");
+        console_log(NIVEL_INFO, "SO: todos os processos finalizaram, CPU parando");
         sistema_operacional->erro_interno = true;
     }
 }
 
-static processo_t *remove_primeiro_processo_fila(fila_t *fila)
+// retira e retorna o primeiro processo da fila de prontos (ou do heap) do
+//   núcleo sendo atendido
+// se a fila do núcleo estiver vazia, pega o primeiro da fila de outro núcleo
+//   (o próximo em número que tiver processo pronto), que passa a ser deste
+//   núcleo ao executar; retorna NULL se não tem processo pronto em nenhum
+static processo_t *remove_primeiro_processo_fila(so_t *self)
 {
-  if (fila->inicio == NULL)
+  for (int i = 0; i < self->n_nucleos; i++)
   {
-    return NULL;
-  }
-
-  no_fila_t *no = fila->inicio;
-  processo_t *proc = no->processo;
-  fila->inicio = no->proximo;
-  if (fila->inicio == NULL)
-  {
-    fila->fim = NULL;
+    so_nucleo_t *nucleo = &self->nucleos[(self->nucleo->id + i) % self->n_nucleos];
+    processo_t *proc;
+    if (usa_heap_prontos(self))
+    {
+      proc = heap_prontos_remove_primeiro(nucleo->heap_prontos);
+    }
+    else
+    {
+      proc = nucleo->fila_prontos.inicio;
+      if (proc != NULL)
+      {
+        remove_processo_da_fila_prontos(self, proc);
+      }
+    }
+    if (proc != NULL)
+    {
+      if (nucleo != self->nucleo)
+      {
+        self->metricas.num_roubos++;
+        console_log(NIVEL_DEPURACAO, "SO: núcleo %d pegou o processo %d do núcleo %d",
+                    self->nucleo->id, proc->pid, nucleo->id);
+      }
+      return proc;
+    }
   }
-  free(no);
-  return proc;
+  return NULL;
 }
 
 /**
@@ -712,72 +843,27 @@ static processo_t *remove_primeiro_processo_fila(fila_t *fila)
  */
 static void escalonador_round_robin(so_t *sistema_operacional) {
     // Verifica se o processo corrente está executando e ainda possui quantum restante
-    if (sistema_operacional->processo_corrente != NULL &&
-        sistema_operacional->processo_corrente->estado == ESTADO_INICIALIZANDO &&
-        sistema_operacional->quantum_proc > 0) {
+    if (sistema_operacional->nucleo->processo_corrente != NULL &&
+        sistema_operacional->nucleo->processo_corrente->estado == ESTADO_INICIALIZANDO &&
+        sistema_operacional->nucleo->quantum_proc > 0) {
         return; // Processo atual continua executando
     }
 
     // Se o processo corrente esgotou seu quantum, move-o para o final da fila de prontos
-    if (sistema_operacional->processo_corrente != NULL &&
-        sistema_operacional->processo_corrente->estado == ESTADO_INICIALIZANDO) {
-        insere_na_fila_prontos(sistema_operacional, sistema_operacional->processo_corrente);
+    if (sistema_operacional->nucleo->processo_corrente != NULL &&
+        sistema_operacional->nucleo->processo_corrente->estado == ESTADO_INICIALIZANDO) {
+        insere_na_fila_prontos(sistema_operacional, sistema_operacional->nucleo->processo_corrente);
     }
 
-    // Verifica se há processos na fila de prontos
-    if (sistema_operacional->fila_prontos->inicio != NULL) {
-        // Remove o próximo processo da fila e o escalona para execução
-        processo_t *proximo_processo = remove_primeiro_processo_fila(sistema_operacional->fila_prontos);
+    // Remove o próximo processo da fila (deste núcleo ou de outro) e o
+    //   escalona para execução, se houver
+    processo_t *proximo_processo = remove_primeiro_processo_fila(sistema_operacional);
+    if (proximo_processo != NULL) {
         so_executa_proc(sistema_operacional, proximo_processo);
     } else {
         // Se não há processos prontos, define o processo corrente como NULL
-        sistema_operacional->processo_corrente = NULL;
-    }
-}
-
-/**
- * @brief Busca e remove o nó com o processo de maior prioridade na fila.
- * 
- * Essa função percorre a fila de processos prontos para encontrar o nó
- * contendo o processo com a maior prioridade (menor valor numérico).
- * Após encontrar, remove o nó da fila e ajusta os ponteiros de início e fim.
- * 
- * @param fila Ponteiro para a estrutura da fila.
- * @return Ponteiro para o nó contendo o processo de maior prioridade.
- */
-static no_fila_t *remover_processo_maior_prioridade(fila_t *fila) {
-    if (fila->inicio == NULL) {
-        return NULL; // Fila vazia
-    }
-
-    no_fila_t *no_anterior = NULL;
-    no_fila_t *no_maior_prioridade = fila->inicio;
-    no_fila_t *no_maior_prioridade_anterior = NULL;
-    no_fila_t *no_atual = fila->inicio;
-
-    // Percorre a fila para encontrar o nó com maior prioridade
-    while (no_atual != NULL) {
-        if (no_atual->processo->prioridade < no_maior_prioridade->processo->prioridade) {
-            no_maior_prioridade = no_atual;
-            no_maior_prioridade_anterior = no_anterior;
-        }
-        no_anterior = no_atual;
-        no_atual = no_atual->proximo;
-    }
-
-    // Remove o nó de maior prioridade da fila
-    if (no_maior_prioridade_anterior != NULL) {
-        no_maior_prioridade_anterior->proximo = no_maior_prioridade->proximo;
-    } else {
-        fila->inicio = no_maior_prioridade->proximo;
+        sistema_operacional->nucleo->processo_corrente = NULL;
     }
-
-    // Ajusta o ponteiro do fim da fila, se necessário
-    if (no_maior_prioridade == fila->fim) {
-        fila->fim = no_maior_prioridade_anterior;
-    }
-
-    return no_maior_prioridade;
 }
 
 /**
@@ -792,73 +878,161 @@ static no_fila_t *remover_processo_maior_prioridade(fila_t *fila) {
  */
 static void escalonador_prioridade(so_t *sistema_operacional) {
     // Verifica se há um processo corrente e imprime detalhes
-    if (sistema_operacional->processo_corrente != NULL) {
-        console_printf(
+    if (sistema_operacional->nucleo->processo_corrente != NULL) {
+        console_log(NIVEL_DEPURACAO,
             "Processo Corrente: %d, Estado: %s",
-            sistema_operacional->processo_corrente->pid,
-            estado_processo_para_string(sistema_operacional->processo_corrente->estado)
+            sistema_operacional->nucleo->processo_corrente->pid,
+            estado_processo_para_string(sistema_operacional->nucleo->processo_corrente->estado)
         );
     }
 
     // Se o processo corrente está em execução e ainda possui quantum restante, mantém a execução
-    if (sistema_operacional->processo_corrente != NULL &&
-        sistema_operacional->processo_corrente->estado == ESTADO_INICIALIZANDO &&
-        sistema_operacional->quantum_proc > 0) {
+    if (sistema_operacional->nucleo->processo_corrente != NULL &&
+        sistema_operacional->nucleo->processo_corrente->estado == ESTADO_INICIALIZANDO &&
+        sistema_operacional->nucleo->quantum_proc > 0) {
         return;
     }
 
     // Se o processo corrente terminou seu quantum, insere-o de volta na fila de prontos
-    if (sistema_operacional->processo_corrente != NULL &&
-        sistema_operacional->processo_corrente->estado == ESTADO_INICIALIZANDO) {
-        insere_na_fila_prontos(sistema_operacional, sistema_operacional->processo_corrente);
+    if (sistema_operacional->nucleo->processo_corrente != NULL &&
+        sistema_operacional->nucleo->processo_corrente->estado == ESTADO_INICIALIZANDO) {
+        insere_na_fila_prontos(sistema_operacional, sistema_operacional->nucleo->processo_corrente);
     }
 
-    // Verifica se há processos prontos na fila
-    if (sistema_operacional->fila_prontos->inicio != NULL) {
-        // Obtém o nó do processo com maior prioridade
-        no_fila_t *nodo_maior_prioridade = remover_processo_maior_prioridade(sistema_operacional->fila_prontos);
+    // Obtém o processo com maior prioridade (menor valor) do heap deste
+    //   núcleo (ou de outro, se estiver vazio), em O(log n)
+    processo_t *processo_maior_prioridade = remove_primeiro_processo_fila(sistema_operacional);
+    if (processo_maior_prioridade != NULL) {
 
         // Imprime informações sobre o processo a ser escalado
-        if (sistema_operacional->processo_corrente != NULL && nodo_maior_prioridade->processo != NULL) {
-            console_printf(
+        if (sistema_operacional->nucleo->processo_corrente != NULL) {
+            console_log(NIVEL_DEPURACAO,
                 "SO: Escalonando processo de maior prioridade, PID: %d, Estado: %s",
-                nodo_maior_prioridade->processo->pid,
-                estado_processo_para_string(nodo_maior_prioridade->processo->estado)
+                processo_maior_prioridade->pid,
+                estado_processo_para_string(processo_maior_prioridade->estado)
             );
-            console_printf(
+            console_log(NIVEL_DEPURACAO,
                 "SO: Processo anterior, PID: %d, Estado: %s",
-                sistema_operacional->processo_corrente->pid,
-                estado_processo_para_string(sistema_operacional->processo_corrente->estado)
+                sistema_operacional->nucleo->processo_corrente->pid,
+                estado_processo_para_string(sistema_operacional->nucleo->processo_corrente->estado)
             );
         }
 
         // Executa o processo de maior prioridade
-        so_executa_proc(sistema_operacional, nodo_maior_prioridade->processo);
-
-        // Libera o nó da fila (somente estrutura, não o processo)
-        free(nodo_maior_prioridade);
+        so_executa_proc(sistema_operacional, processo_maior_prioridade);
     } else {
         // Se não há processos na fila, define o processo corrente como NULL
-        sistema_operacional->processo_corrente = NULL;
+        sistema_operacional->nucleo->processo_corrente = NULL;
     }
 }
 
 static int so_despacha(so_t *self)
 {
-  if (self->processo_corrente == NULL)
+  so_programa_relogio(self);
+
+  if (self->nucleo->processo_corrente == NULL)
   {
     return 1;
   }
 
-  mem_escreve(self->mem, IRQ_END_PC, self->processo_corrente->pc);
-  mem_escreve(self->mem, IRQ_END_A, self->processo_corrente->reg[0]);
-  mem_escreve(self->mem, IRQ_END_X, self->processo_corrente->reg[1]);
+  mem_escreve(self->mem, end_estado_salvo(self, IRQ_END_PC), self->nucleo->processo_corrente->pc);
+  mem_escreve(self->mem, end_estado_salvo(self, IRQ_END_A), self->nucleo->processo_corrente->reg[0]);
+  mem_escreve(self->mem, end_estado_salvo(self, IRQ_END_X), self->nucleo->processo_corrente->reg[1]);
 
-  console_printf("SO: despachando processo %d", self->processo_corrente->pid);
+  console_log(NIVEL_DEPURACAO, "SO: despachando processo %d", self->nucleo->processo_corrente->pid);
+  RASTRO(RASTRO_PROCESSO, EV_DESPACHO, self->nucleo->id, self->nucleo->processo_corrente->pid, 0, 0);
 
   return 0;
 }
 
+// o quantum restante (em intervalos do relógio, arredondado para cima) é
+//   calculado pelo tempo que falta até o fim do quantum, em vez de ser
+//   decrementado a cada interrupção do relógio
+static void so_atualiza_quantum(so_t *self)
+{
+  if (self->nucleo->fim_quantum == 0) return;
+  int resta = self->nucleo->fim_quantum - self->relogio_atual;
+  if (resta <= 0) {
+    self->nucleo->quantum_proc = 0;
+  } else {
+    self->nucleo->quantum_proc = (resta + self->intervalo_interrupcao - 1) / self->intervalo_interrupcao;
+  }
+}
+
+// programa o timer para a próxima vez que o SO precisa dele: o fim do
+//   quantum do processo que vai executar
+// sem processo para executar, ou com o escalonador simples (que não tem
+//   preempção), o timer fica desligado -- a CPU parada só é acordada pela E/S,
+//   sem interrupções do relógio só para contar tempo ocioso
+// o timer só é reprogramado quando muda o instante
+static void so_programa_relogio(so_t *self)
+{
+  int instante = 0;
+  if (self->nucleo->processo_corrente != NULL && self->escalonador != 3) {
+    instante = self->nucleo->fim_quantum;
+  }
+  if (instante == self->nucleo->alarme) return;
+  if (es_escreve(self->nucleo->es, D_RELOGIO_ALARME, instante) != ERR_OK) {
+    console_log(NIVEL_ERRO, "SO: problema na programação do timer");
+    self->erro_interno = true;
+    return;
+  }
+  self->nucleo->alarme = instante;
+}
+
+// atende, em ordem de prioridade, as interrupções de E/S que estiverem
+//   pendentes no controlador de interrupções, na mesma entrada no SO (em vez
+//   de uma entrada para cada)
+// cada linha é atendida no máximo uma vez por entrada (incluindo a que
+//   causou a entrada, 'irq_atendida'); se pedir de novo, vai causar outra
+static void so_trata_irqs_pendentes(so_t *self, int irq_atendida)
+{
+  unsigned atendidas = 1u << irq_atendida;
+  int irq;
+  while (es_le(self->nucleo->es, D_PIC_PROXIMA, &irq) == ERR_OK && irq != -1
+         && (atendidas & (1u << irq)) == 0)
+  {
+    atendidas |= 1u << irq;
+    self->metricas.num_interrupcoes[irq]++;
+    so_trata_irq(self, irq);
+  }
+}
+
+// pede interrupção (IRQ_NUCLEO) aos núcleos ociosos, para que peguem os
+//   processos prontos que sobraram na fila de outro núcleo; acorda no máximo
+//   tantos núcleos quantos são os processos prontos
+static void so_acorda_nucleos(so_t *self)
+{
+  int prontos = tabproc_num_no_estado(self->tabela_processos, ESTADO_PRONTO);
+  for (int i = 1; i < self->n_nucleos && prontos > 0; i++)
+  {
+    so_nucleo_t *nucleo = &self->nucleos[(self->nucleo->id + i) % self->n_nucleos];
+    if (nucleo->processo_corrente != NULL)
+    {
+      continue;
+    }
+    so_interrompe_nucleo(self, nucleo);
+    prontos--;
+  }
+}
+
+// pede ao controlador de interrupções do núcleo sendo atendido uma
+//   interrupção para outro núcleo, se já não foi pedida
+static void so_interrompe_nucleo(so_t *self, so_nucleo_t *nucleo)
+{
+  if (nucleo->acordando)
+  {
+    return;
+  }
+  if (es_escreve(self->nucleo->es, D_PIC_ACORDA, nucleo->id) != ERR_OK)
+  {
+    console_log(NIVEL_ERRO, "SO: problema no pedido de interrupção ao núcleo %d", nucleo->id);
+    self->erro_interno = true;
+    return;
+  }
+  nucleo->acordando = true;
+}
+
 // TRATAMENTO DE UMA IRQ {{{1
 
 // funções auxiliares para tratar cada tipo de interrupção
@@ -866,6 +1040,9 @@ static void so_trata_irq_reset(so_t *self);
 static void so_trata_irq_chamada_sistema(so_t *self);
 static void so_trata_irq_err_cpu(so_t *self);
 static void so_trata_irq_relogio(so_t *self);
+static void so_trata_irq_teclado(so_t *self);
+static void so_trata_irq_tela(so_t *self);
+static void so_trata_irq_nucleo(so_t *self);
 static void so_trata_irq_desconhecida(so_t *self, int irq);
 
 static void so_trata_irq(so_t *self, int irq)
@@ -885,6 +1062,15 @@ static void so_trata_irq(so_t *self, int irq)
   case IRQ_RELOGIO:
     so_trata_irq_relogio(self);
     break;
+  case IRQ_TECLADO:
+    so_trata_irq_teclado(self);
+    break;
+  case IRQ_TELA:
+    so_trata_irq_tela(self);
+    break;
+  case IRQ_NUCLEO:
+    so_trata_irq_nucleo(self);
+    break;
   default:
     so_trata_irq_desconhecida(self, irq);
   }
@@ -899,15 +1085,17 @@ static processo_t *so_cria_processo(so_t *self, char *nome_do_executavel)
   }
 
   int pc = so_carrega_programa(self, nome_do_executavel);
-  console_printf("SO: processo %d criado com PC=%d", self->pid_atual, pc);
+  console_log(NIVEL_INFO, "SO: processo %d criado com PC=%d", self->pid_atual, pc);
   if (pc == -1)
   {
-    console_printf("SO: erro ao carregar o programa '%s'", nome_do_executavel);
+    console_log(NIVEL_ERRO, "SO: erro ao carregar o programa '%s'", nome_do_executavel);
     free(proc);
     return NULL;
   }
 
   inicializa_processo(proc, self->pid_atual++, pc);
+  // o processo começa na fila do núcleo que o criou
+  proc->nucleo = self->nucleo->id;
   self->numero_processos++;
 
   return proc;
@@ -916,59 +1104,55 @@ static processo_t *so_cria_processo(so_t *self, char *nome_do_executavel)
 // interrupção gerada uma única vez, quando a CPU inicializa
 static void so_trata_irq_reset(so_t *self)
 {
-  // cria um processo para o init
-  processo_t *init_proc = so_cria_processo(self, "init.maq");
-  if (init_proc == NULL)
+  // só o núcleo 0 inicia o sistema; os outros começam ociosos, e são
+  //   acordados quando houver processo pronto para eles (ver so_acorda_nucleos)
+  if (self->nucleo->id != 0)
   {
-    console_printf("SO: problema na carga do programa inicial");
-    self->erro_interno = true;
     return;
   }
 
-  // adiciona o processo init à lista de processos
-  self->processos = malloc(sizeof(processo_t *));
-  if (self->processos == NULL)
+  // cria um processo para o init
+  processo_t *init_proc = so_cria_processo(self, "init.maq");
+  if (init_proc == NULL)
   {
-    console_printf("SO: problema na criação da lista de processos");
+    console_log(NIVEL_ERRO, "SO: problema na carga do programa inicial");
     self->erro_interno = true;
-    free(init_proc);
     return;
   }
-  self->processos[0] = init_proc;
-  self->processo_corrente = init_proc;
+
+  // adiciona o processo init à tabela de processos
+  tabproc_insere(self->tabela_processos, init_proc);
+  self->nucleo->processo_corrente = init_proc;
+  // o init não passa por so_executa_proc, o quantum dele começa aqui
+  self->nucleo->quantum_proc = self->quantum;
+  self->nucleo->fim_quantum = self->relogio_atual + self->quantum * self->intervalo_interrupcao;
 
   // altera o PC para o endereço de carga
-  mem_escreve(self->mem, IRQ_END_PC, init_proc->pc);
+  mem_escreve(self->mem, end_estado_salvo(self, IRQ_END_PC), init_proc->pc);
   // passa o processador para modo usuário
-  // mem_escreve(self->mem, IRQ_END_modo, usuario);
+  // mem_escreve(self->mem, end_estado_salvo(self, IRQ_END_modo), usuario);
 }
 
 /**
- * @brief Verifica e desbloqueia processos esperando pela morte de outro processo.
+ * @brief Desbloqueia os processos esperando pela morte de outro processo.
  *
- * Esta função percorre a lista de processos para identificar aqueles que estão bloqueados
- * aguardando a finalização de um processo específico (identificado por `pid_morto`).
- * Ao encontrar tais processos, altera seu estado para "PRONTO" e registra a ação no log.
+ * Os processos que chamaram SO_ESPERA_PROC para o processo que morreu estão na
+ * fila de espera dele; todos são desbloqueados e registrados no log.
  *
  * @param sistema_operacional Ponteiro para o sistema operacional.
- * @param pid_morto Identificador do processo que foi finalizado.
+ * @param processo_morto Processo que foi finalizado.
  */
-static void verifica_processos_em_espera(so_t *sistema_operacional, int pid_morto) {
-    for (int i = 0; sistema_operacional->processos[i] != NULL; i++) {
-        processo_t *processo_atual = sistema_operacional->processos[i];
-
-        // Verifica se o processo está bloqueado aguardando
-        if (processo_atual->estado == ESTADO_BLOQUEADO) {
-            // Altera o estado do processo para PRONTO
-            processo_atual->estado = ESTADO_PRONTO;
-
-            // Log informativo
-            console_printf(
-                "[INFO] Processo desbloqueado: PID=%d. Motivo: término do processo PID=%d.\n",
-                processo_atual->pid,
-                pid_morto
-            );
-        }
+static void verifica_processos_em_espera(so_t *sistema_operacional, processo_t *processo_morto) {
+    processo_t *processo_atual;
+    while ((processo_atual = fila_espera_remove_primeiro(&processo_morto->esperando_fim)) != NULL) {
+        so_desbloqueia_processo(sistema_operacional, processo_atual);
+
+        // Log informativo
+        console_log(NIVEL_DEPURACAO,
+            "[INFO] Processo desbloqueado: PID=%d. Motivo: término do processo PID=%d.\n",
+            processo_atual->pid,
+            processo_morto->pid
+        );
     }
 }
 
@@ -976,20 +1160,18 @@ static void verifica_processos_em_espera(so_t *sistema_operacional, int pid_mort
 static void so_trata_irq_err_cpu(so_t *self)
 {
   int err_int;
-  mem_le(self->mem, IRQ_END_erro, &err_int);
+  mem_le(self->mem, end_estado_salvo(self, IRQ_END_erro), &err_int);
   err_t err = err_int;
-  console_printf("SO: erro na CPU: %s", err_nome(err));
+  console_log(NIVEL_ERRO, "SO: erro na CPU: %s", err_nome(err));
 
-  if (self->processo_corrente != NULL)
+  if (self->nucleo->processo_corrente != NULL)
   {
-    console_printf("SO: matando processo %d devido a erro na CPU", self->processo_corrente->pid);
-    self->processo_corrente->estado = BLOQUEIO_POR_LEITURA;
-    verifica_processos_em_espera(self, self->processo_corrente->pid);
-    self->processo_corrente = NULL;
+    console_log(NIVEL_ERRO, "SO: matando processo %d devido a erro na CPU", self->nucleo->processo_corrente->pid);
+    so_termina_processo(self, self->nucleo->processo_corrente);
   }
   else
   {
-    console_printf("SO: erro na CPU sem processo corrente");
+    console_log(NIVEL_ERRO, "SO: erro na CPU sem processo corrente");
   }
 
   self->erro_interno = true;
@@ -998,27 +1180,76 @@ static void so_trata_irq_err_cpu(so_t *self)
 // interrupção gerada quando o timer expira
 static void so_trata_irq_relogio(so_t *self)
 {
-  // rearma o interruptor do relógio e reinicializa o timer para a próxima interrupção
-  err_t e1, e2;
-  e1 = es_escreve(self->es, D_RELOGIO_INTERRUPCAO, 0); // desliga o sinalizador de interrupção
-  e2 = es_escreve(self->es, D_RELOGIO_TIMER, INTERVALO_INTERRUPCAO);
-  if (e1 != ERR_OK || e2 != ERR_OK)
+  // desliga o sinalizador de interrupção; o timer se desprogramou ao gerar a
+  //   interrupção, e só é programado de novo no despacho
+  if (es_escreve(self->nucleo->es, D_RELOGIO_INTERRUPCAO, 0) != ERR_OK)
+  {
+    console_log(NIVEL_ERRO, "SO: problema da reinicialização do timer");
+    self->erro_interno = true;
+  }
+  self->nucleo->alarme = 0;
+  // o quantum já foi atualizado pelo relógio na entrada no SO (a interrupção
+  //   é no fim do quantum, então ele acabou)
+  console_log(NIVEL_DETALHE, "Quantum: %d", self->nucleo->quantum_proc);
+}
+
+// lê do controlador de interrupções (e reconhece) os terminais que pediram a
+//   interrupção, um bit para cada; retorna 0 em caso de erro
+static int so_terminais_que_pediram(so_t *self, dispositivo_id_t dispositivo)
+{
+  int origens;
+  if (es_le(self->nucleo->es, dispositivo, &origens) != ERR_OK)
   {
-    console_printf("SO: problema da reinicialização do timer");
+    console_log(NIVEL_ERRO, "SO: problema no acesso ao controlador de interrupções");
     self->erro_interno = true;
+    return 0;
+  }
+  return origens;
+}
+
+// interrupção gerada quando chega entrada em terminais que estavam sem
+// só os processos esperando por esses terminais são desbloqueados; os outros
+//   terminais não são consultados
+static void so_trata_irq_teclado(so_t *self)
+{
+  int origens = so_terminais_que_pediram(self, D_PIC_ORIGEM_TECLADO);
+  for (int terminal = 0; terminal < NUM_TERMINAIS; terminal++)
+  {
+    if (origens & (1 << terminal)) desbloqueia_espera_teclado(self, terminal);
   }
-  // decrementando o quantum
-  if (self->quantum_proc > 0)
+}
+
+// interrupção gerada quando a saída de terminais volta a aceitar caracteres
+// escreve o dado pendente dos processos esperando por esses terminais
+static void so_trata_irq_tela(so_t *self)
+{
+  int origens = so_terminais_que_pediram(self, D_PIC_ORIGEM_TELA);
+  for (int terminal = 0; terminal < NUM_TERMINAIS; terminal++)
   {
-    self->quantum_proc--;
+    if (origens & (1 << terminal)) desbloqueia_espera_tela(self, terminal);
   }
-  console_printf("Quantum: %d", self->quantum_proc);
+}
+
+// interrupção pedida por outro núcleo, para que este escolha um processo
+//   (ver so_interrompe_nucleo); só reconhece o pedido, a escolha é feita pelo
+//   escalonador, como em toda entrada no SO
+static void so_trata_irq_nucleo(so_t *self)
+{
+  int origens;
+  if (es_le(self->nucleo->es, D_PIC_ORIGEM_NUCLEO, &origens) != ERR_OK)
+  {
+    console_log(NIVEL_ERRO, "SO: problema no acesso ao controlador de interrupções");
+    self->erro_interno = true;
+    return;
+  }
+  console_log(NIVEL_DETALHE, "SO: núcleo %d interrompido pelos núcleos %#x",
+              self->nucleo->id, origens);
 }
 
 // foi gerada uma interrupção para a qual o SO não está preparado
 static void so_trata_irq_desconhecida(so_t *self, int irq)
 {
-  console_printf("SO: não sei tratar IRQ %d (%s)", irq, irq_nome(irq));
+  console_log(NIVEL_ERRO, "SO: não sei tratar IRQ %d (%s)", irq, irq_nome(irq));
   self->erro_interno = true;
 }
 
@@ -1034,13 +1265,15 @@ static void so_trata_irq_chamada_sistema(so_t *self)
   // a identificação da chamada está no registrador A
   // t1: com processos, o reg A tá no descritor do processo corrente
   int id_chamada;
-  if (mem_le(self->mem, IRQ_END_A, &id_chamada) != ERR_OK)
+  if (mem_le(self->mem, end_estado_salvo(self, IRQ_END_A), &id_chamada) != ERR_OK)
   {
-    console_printf("SO: erro no acesso ao id da chamada de sistema");
+    console_log(NIVEL_ERRO, "SO: erro no acesso ao id da chamada de sistema");
     self->erro_interno = true;
     return;
   }
-  console_printf("SO: chamada de sistema %d", id_chamada);
+  console_log(NIVEL_DEPURACAO, "SO: chamada de sistema %d", id_chamada);
+  RASTRO(RASTRO_CHAMADA, EV_CHAMADA, self->nucleo->id, id_chamada,
+         self->nucleo->processo_corrente != NULL ? self->nucleo->processo_corrente->pid : -1, 0);
   switch (id_chamada)
   {
   case SO_LE:
@@ -1060,7 +1293,7 @@ static void so_trata_irq_chamada_sistema(so_t *self)
 
     break;
   default:
-    console_printf("SO: chamada de sistema desconhecida (%d)", id_chamada);
+    console_log(NIVEL_ERRO, "SO: chamada de sistema desconhecida (%d)", id_chamada);
     // t1: deveria matar o processo
     so_chamada_mata_proc(self);
   }
@@ -1079,11 +1312,9 @@ static void so_trata_irq_chamada_sistema(so_t *self)
  * @return O índice do terminal correspondente (0 a NUM_TERMINAIS - 1).
  */
 static int obter_terminal_por_pid(int pid) {
-    const int NUM_TERMINAIS = 4; // Número total de terminais disponíveis
-
     // Verifica se o PID é válido
     if (pid <= 0) {
-        console_printf("[ERRO] PID inválido: %d. Deve ser maior que zero.\n", pid);
+        console_log(NIVEL_ERRO, "[ERRO] PID inválido: %d. Deve ser maior que zero.\n", pid);
         return -1; // Retorna -1 para indicar erro
     }
 
@@ -1091,58 +1322,59 @@ static int obter_terminal_por_pid(int pid) {
     int terminal = (pid - 1) % NUM_TERMINAIS;
 
     // Log de depuração (opcional)
-    console_printf("[INFO] PID=%d associado ao terminal=%d.\n", pid, terminal);
+    console_log(NIVEL_DETALHE, "[INFO] PID=%d associado ao terminal=%d.\n", pid, terminal);
 
     return terminal;
 }
 
 static void so_chamada_le(so_t *self)
 {
-  int terminal = obter_terminal_por_pid(self->processo_corrente->pid);
+  int terminal = obter_terminal_por_pid(self->nucleo->processo_corrente->pid);
   int dispositivo = calcular_endereco_dispositivo(D_TERM_A_TECLADO, terminal);
   int dispositivo_ok = calcular_endereco_dispositivo(D_TERM_A_TECLADO_OK, terminal);
 
   int estado;
-  if (es_le(self->es, dispositivo_ok, &estado) != ERR_OK)
+  if (es_le(self->nucleo->es, dispositivo_ok, &estado) != ERR_OK)
   {
-    console_printf("SO: problema no acesso ao estado do teclado");
+    console_log(NIVEL_ERRO, "SO: problema no acesso ao estado do teclado");
     self->erro_interno = true;
     return;
   }
 
   if (estado == 0)
   {
-    // dispositivo ocupado, bloquear o processo
-    proc_muda_estado(self->processo_corrente, ESTADO_BLOQUEADO);
-    self->processo_corrente->motivo_bloqueio = BLOQUEIO_POR_LEITURA; // definindo motivo do bloqueio
+    // dispositivo ocupado, bloquear o processo na fila do teclado
+    so_bloqueia_processo(self, self->nucleo->processo_corrente, BLOQUEIO_POR_LEITURA,
+                         &self->espera_teclado[terminal]);
     return;
   }
 
   int dado;
-  if (es_le(self->es, dispositivo, &dado) != ERR_OK)
+  if (es_le(self->nucleo->es, dispositivo, &dado) != ERR_OK)
   {
-    console_printf("SO: problema no acesso ao teclado do terminal %d", terminal);
+    console_log(NIVEL_ERRO, "SO: problema no acesso ao teclado do terminal %d", terminal);
     self->erro_interno = true;
     return;
   }
 
-  mem_escreve(self->mem, IRQ_END_A, dado);
+  // o despacho restaura o reg A a partir do descritor do processo
+  self->nucleo->processo_corrente->reg[0] = dado;
 }
 /// implementação da chamada se sistema SO_ESCR
 // escreve o valor do reg X na saída corrente do processo
 static void so_chamada_escr(so_t *self)
 {
 
-  int terminal = obter_terminal_por_pid(self->processo_corrente->pid);
+  int terminal = obter_terminal_por_pid(self->nucleo->processo_corrente->pid);
 
   int dispositivo_tela = calcular_endereco_dispositivo(D_TERM_A_TELA, terminal);
   int dispositivo_tela_ok = calcular_endereco_dispositivo(D_TERM_A_TELA_OK, terminal);
 
   // verifica o estado do dispositivo de tela
   int estado;
-  if (es_le(self->es, dispositivo_tela_ok, &estado) != ERR_OK)
+  if (es_le(self->nucleo->es, dispositivo_tela_ok, &estado) != ERR_OK)
   {
-    console_printf("SO: problema no acesso ao estado da tela do terminal %d", terminal);
+    console_log(NIVEL_ERRO, "SO: problema no acesso ao estado da tela do terminal %d", terminal);
     self->erro_interno = true;
     return;
   }
@@ -1150,102 +1382,43 @@ static void so_chamada_escr(so_t *self)
   // se o dispositivo está ocupado, salva o dado pendente e bloqueia o processo
   if (estado == 0)
   {
-    if (mem_le(self->mem, IRQ_END_X, &self->processo_corrente->dado_pendente) != ERR_OK)
+    if (mem_le(self->mem, end_estado_salvo(self, IRQ_END_X), &self->nucleo->processo_corrente->dado_pendente) != ERR_OK)
     {
-      console_printf("SO: problema ao ler o valor do registrador X");
+      console_log(NIVEL_ERRO, "SO: problema ao ler o valor do registrador X");
       self->erro_interno = true;
       return;
     }
-    proc_muda_estado(self->processo_corrente, ESTADO_BLOQUEADO);
-    self->processo_corrente->motivo_bloqueio = BLOQUEIO_POR_ESCRITA; // definindo motivo do bloqueio
+    so_bloqueia_processo(self, self->nucleo->processo_corrente, BLOQUEIO_POR_ESCRITA,
+                         &self->espera_tela[terminal]);
     return;
   }
 
   // lê o valor do registrador X
   int dado;
-  if (mem_le(self->mem, IRQ_END_X, &dado) != ERR_OK)
+  if (mem_le(self->mem, end_estado_salvo(self, IRQ_END_X), &dado) != ERR_OK)
   {
     self->erro_interno = true;
     return;
   }
 
-  if (es_escreve(self->es, dispositivo_tela, dado) != ERR_OK)
+  if (es_escreve(self->nucleo->es, dispositivo_tela, dado) != ERR_OK)
   {
     return;
   }
 
-  mem_escreve(self->mem, IRQ_END_A, 0);
-}
-
-/**
- * @brief Adiciona um novo processo à lista de processos do SO.
- *
- * Esta função insere um processo na lista dinâmica de processos do sistema
- * operacional, realocando memória conforme necessário. Caso ocorra um erro
- * durante a realocação, o processo não é adicionado e a memória alocada para
- * ele é liberada.
- *
- * @param self Ponteiro para o sistema operacional.
- * @param novo_proc Ponteiro para o processo a ser adicionado.
- */
-static void adiciona_processo_na_lista(so_t *self, processo_t *novo_proc) {
-    // Validação inicial de argumentos
-    if (self == NULL || novo_proc == NULL) {
-        console_printf("[ERRO] Argumento inválido em adiciona_processo_na_lista.\n");
-        return;
-    }
-
-    // Verifica se a lista de processos está inicializada
-    if (self->processos == NULL) {
-        console_printf("[INFO] Inicializando a lista de processos.\n");
-
-        // Aloca espaço inicial para dois ponteiros (um para o processo e outro para o terminador NULL)
-        self->processos = malloc(2 * sizeof(processo_t *));
-        if (self->processos == NULL) {
-            console_printf("[ERRO] Falha ao inicializar a lista de processos.\n");
-            free(novo_proc);
-            return;
-        }
-
-        // Inicializa a lista com o novo processo e terminador NULL
-        self->processos[0] = novo_proc;
-        self->processos[1] = NULL;
-        return;
-    }
-
-    // Calcula o número atual de processos
-    int i = 0;
-    while (self->processos[i] != NULL) {
-        i++;
-    }
-
-    // Realoca a lista para adicionar mais um processo
-    processo_t **nova_lista = realloc(self->processos, (i + 2) * sizeof(processo_t *));
-    if (nova_lista == NULL) {
-        console_printf("[ERRO] Falha ao realocar a lista de processos.\n");
-        free(novo_proc); // Libera o processo não adicionado
-        return;
-    }
-
-    // Atualiza a lista e adiciona o novo processo
-    self->processos = nova_lista;
-    self->processos[i] = novo_proc;
-    self->processos[i + 1] = NULL;
-
-    console_printf("[INFO] Processo PID=%d adicionado com sucesso.\n", novo_proc->pid);
+  mem_escreve(self->mem, end_estado_salvo(self, IRQ_END_A), 0);
 }
 
-
 // implementação da chamada se sistema SO_CRIA_PROC
 // cria um processo
 static void so_chamada_cria_proc(so_t *self)
 {
   int ender_nome;
-  if (mem_le(self->mem, IRQ_END_X, &ender_nome) != ERR_OK)
+  if (mem_le(self->mem, end_estado_salvo(self, IRQ_END_X), &ender_nome) != ERR_OK)
   {
-    console_printf("SO: erro ao acessar o endereço do nome do arquivo");
+    console_log(NIVEL_ERRO, "SO: erro ao acessar o endereço do nome do arquivo");
     self->erro_interno = true;
-    mem_escreve(self->mem, IRQ_END_A, -1);
+    mem_escreve(self->mem, end_estado_salvo(self, IRQ_END_A), -1);
     return;
   }
 
@@ -1253,8 +1426,8 @@ static void so_chamada_cria_proc(so_t *self)
   char nome[100];
   if (!copia_str_da_mem(100, nome, self->mem, ender_nome))
   {
-    console_printf("SO: erro ao copiar o nome do arquivo da memória");
-    mem_escreve(self->mem, IRQ_END_A, -1);
+    console_log(NIVEL_ERRO, "SO: erro ao copiar o nome do arquivo da memória");
+    mem_escreve(self->mem, end_estado_salvo(self, IRQ_END_A), -1);
     return;
   }
 
@@ -1263,98 +1436,89 @@ static void so_chamada_cria_proc(so_t *self)
 
   if (novo_proc == NULL)
   {
-    console_printf("SO: erro ao criar o novo processo");
-    mem_escreve(self->mem, IRQ_END_A, -1);
+    console_log(NIVEL_ERRO, "SO: erro ao criar o novo processo");
+    mem_escreve(self->mem, end_estado_salvo(self, IRQ_END_A), -1);
     return;
   }
 
-  // adiciona o novo processo à lista de processos
-  adiciona_processo_na_lista(self, novo_proc);
+  // adiciona o novo processo à tabela de processos
+  tabproc_insere(self->tabela_processos, novo_proc);
 
   // adiciona o novo processo à fila de prontos
   insere_na_fila_prontos(self, novo_proc);
 
-  int i = 0;
-  while (self->processos[i] != NULL)
-  {
-    console_printf("Lista de processos: %d", self->processos[i]->pid);
-    i++;
-  }
+  console_log(NIVEL_DEPURACAO, "SO: %d processos vivos", tabproc_tam(self->tabela_processos));
 
-  self->processo_corrente->reg[0] = novo_proc->pid;
+  self->nucleo->processo_corrente->reg[0] = novo_proc->pid;
 }
-static void remove_processo_da_lista(so_t *self, int pid)
+// termina o processo: tira ele das filas em que estiver, desbloqueia quem
+//   estava esperando por ele e libera o seu descritor (e o seu lugar na
+//   tabela), guardando as métricas dele para o relatório
+static void so_termina_processo(so_t *self, processo_t *proc)
 {
-  no_fila_t *anterior = NULL;
-  no_fila_t *atual = self->fila_prontos->inicio;
-  while (atual != NULL)
+  if (proc->fila_espera != NULL)
   {
-    if (atual->processo->pid == pid)
+    fila_espera_remove(proc->fila_espera, proc);
+  }
+  proc_muda_estado(proc, ESTADO_TERMINADO);
+  // se o processo está executando em outro núcleo, esse núcleo fica sem
+  //   processo, e é interrompido para escolher outro
+  so_nucleo_t *nucleo = &self->nucleos[proc->nucleo];
+  if (nucleo->processo_corrente == proc)
+  {
+    nucleo->processo_corrente = NULL;
+    if (nucleo != self->nucleo)
     {
-      if (anterior == NULL)
-      {
-        self->fila_prontos->inicio = atual->proximo;
-      }
-      else
-      {
-        anterior->proximo = atual->proximo;
-      }
-      if (atual == self->fila_prontos->fim)
-      {
-        self->fila_prontos->fim = anterior;
-      }
-      free(atual);
-      break;
+      so_interrompe_nucleo(self, nucleo);
     }
-    anterior = atual;
-    atual = atual->proximo;
   }
+
+  // remove processo da fila de prontos
+  remove_processo_da_fila_prontos(self, proc);
+
+  verifica_processos_em_espera(self, proc);
+
+  metricas_registra_terminado(self, proc);
+  tabproc_remove(self->tabela_processos, proc);
+  free(proc);
+}
+
+// retorna true se o pid é de um processo que já existiu e terminou (os pids
+//   são dados em sequência, e os processos que terminam saem da tabela)
+static bool pid_de_processo_terminado(so_t *self, int pid)
+{
+  return pid > 0 && pid < self->pid_atual
+      && tabproc_busca(self->tabela_processos, pid) == NULL;
 }
 
 // implementação da chamada se sistema SO_MATA_PROC
 // mata o processo com pid X (ou o processo corrente se X é 0)
 static void so_chamada_mata_proc(so_t *self)
 {
-  int pid = self->processo_corrente->reg[1];
+  int pid = self->nucleo->processo_corrente->reg[1];
 
-  console_printf("SO: matando processo com PID %d", pid);
+  console_log(NIVEL_INFO, "SO: matando processo com PID %d", pid);
 
   if (pid == 0)
   {
-    pid = self->processo_corrente->pid;
+    pid = self->nucleo->processo_corrente->pid;
   }
 
-  for (int i = 0; self->processos[i] != NULL; i++)
+  processo_t *proc = tabproc_busca(self->tabela_processos, pid);
+  if (proc != NULL)
   {
-    if (self->processos[i]->pid == pid)
-    {
-      proc_muda_estado(self->processos[i], ESTADO_TERMINADO);
-      if (self->processo_corrente->pid == pid)
-      {
-        self->processo_corrente = NULL;
-      }
-      mem_escreve(self->mem, IRQ_END_A, 0);
-
-      // remove processo da fila de prontos
-      remove_processo_da_lista(self, pid);
-
-      return;
-    }
+    so_termina_processo(self, proc);
+    mem_escreve(self->mem, end_estado_salvo(self, IRQ_END_A), 0);
+    return;
   }
 
-  mem_escreve(self->mem, IRQ_END_A, -1);
+  // matar um processo que já terminou não é erro
+  mem_escreve(self->mem, end_estado_salvo(self, IRQ_END_A), pid_de_processo_terminado(self, pid) ? 0 : -1);
 }
 
 static processo_t *encontra_processo_por_pid(so_t *self, int pid)
 {
-  for (int i = 0; self->processos[i] != NULL; i++)
-  {
-    if (self->processos[i]->pid == pid)
-    {
-      return self->processos[i];
-    }
-  }
-  return NULL;
+  return tabproc_busca(self->tabela_processos, pid);
 }
 
 // implementação da chamada se sistema SO_ESPERA_PROC
@@ -1371,43 +1535,50 @@ static processo_t *encontra_processo_por_pid(so_t *self, int pid)
  */
 static void so_chamada_espera_proc(so_t *self) {
     // Obtém o PID do processo que o processo corrente deseja esperar
-    int pid = self->processo_corrente->reg[1];
+    int pid = self->nucleo->processo_corrente->reg[1];
 
     // Verifica se o processo corrente está tentando esperar por si mesmo
-    if (pid == self->processo_corrente->pid) {
-        console_printf("[ERRO] Processo PID=%d não pode esperar por si mesmo.\n", pid);
-        mem_escreve(self->mem, IRQ_END_A, -1);
+    if (pid == self->nucleo->processo_corrente->pid) {
+        console_log(NIVEL_ERRO, "[ERRO] Processo PID=%d não pode esperar por si mesmo.\n", pid);
+        mem_escreve(self->mem, end_estado_salvo(self, IRQ_END_A), -1);
         return;
     }
 
     // Busca o processo pelo PID
     processo_t *proc_esperado = encontra_processo_por_pid(self, pid);
 
+    // Verifica se o processo já terminou (e saiu da tabela)
+    if (proc_esperado == NULL && pid_de_processo_terminado(self, pid)) {
+        console_log(NIVEL_DEPURACAO, "[INFO] Processo PID=%d já terminou. Nenhuma espera necessária.\n", pid);
+        mem_escreve(self->mem, end_estado_salvo(self, IRQ_END_A), 0);
+        return;
+    }
+
     // Verifica se o processo foi encontrado
     if (proc_esperado == NULL) {
-        console_printf("[ERRO] Processo esperado com PID=%d não encontrado.\n", pid);
-        mem_escreve(self->mem, IRQ_END_A, -1);
+        console_log(NIVEL_ERRO, "[ERRO] Processo esperado com PID=%d não encontrado.\n", pid);
+        mem_escreve(self->mem, end_estado_salvo(self, IRQ_END_A), -1);
         return;
     }
 
     // Verifica se o processo já está terminado
     if (proc_esperado->estado == ESTADO_TERMINADO) {
-        console_printf("[INFO] Processo PID=%d já terminou. Nenhuma espera necessária.\n", pid);
-        mem_escreve(self->mem, IRQ_END_A, 0);
+        console_log(NIVEL_DEPURACAO, "[INFO] Processo PID=%d já terminou. Nenhuma espera necessária.\n", pid);
+        mem_escreve(self->mem, end_estado_salvo(self, IRQ_END_A), 0);
         return;
     }
 
-    // Bloqueia o processo corrente e define o motivo do bloqueio
-    proc_muda_estado(self->processo_corrente, ESTADO_BLOQUEADO);
-    self->processo_corrente->motivo_bloqueio = BLOQUEIO_POR_ESPERA_DE_PROC;
+    // Bloqueia o processo corrente na fila dos que esperam o fim do processo
+    so_bloqueia_processo(self, self->nucleo->processo_corrente, BLOQUEIO_POR_ESPERA_DE_PROC,
+                         &proc_esperado->esperando_fim);
 
     // Armazena o PID do processo que está sendo esperado
-    self->processo_corrente->reg[0] = pid;
+    self->nucleo->processo_corrente->reg[0] = pid;
 
     // Retorna sucesso ao processo chamador
-    console_printf("[INFO] Processo PID=%d agora está aguardando o término do processo PID=%d.\n",
-                   self->processo_corrente->pid, pid);
-    mem_escreve(self->mem, IRQ_END_A, 0);
+    console_log(NIVEL_DEPURACAO, "[INFO] Processo PID=%d agora está aguardando o término do processo PID=%d.\n",
+                self->nucleo->processo_corrente->pid, pid);
+    mem_escreve(self->mem, end_estado_salvo(self, IRQ_END_A), 0);
 }
 
 // CARGA DE PROGRAMA {{{1
@@ -1420,7 +1591,7 @@ static int so_carrega_programa(so_t *self, char *nome_do_executavel)
   programa_t *prog = prog_cria(nome_do_executavel);
   if (prog == NULL)
   {
-    console_printf("Erro na leitura do programa '%s'\n", nome_do_executavel);
+    console_log(NIVEL_ERRO, "Erro na leitura do programa '%s'\n", nome_do_executavel);
     return -1;
   }
 
@@ -1431,13 +1602,13 @@ static int so_carrega_programa(so_t *self, char *nome_do_executavel)
   {
     if (mem_escreve(self->mem, end, prog_dado(prog, end)) != ERR_OK)
     {
-      console_printf("Erro na carga da memória, endereco %d\n", end);
+      console_log(NIVEL_ERRO, "Erro na carga da memória, endereco %d\n", end);
       return -1;
     }
   }
 
   prog_destroi(prog);
-  console_printf("SO: carga de '%s' em %d-%d", nome_do_executavel, end_ini, end_fim);
+  console_log(NIVEL_INFO, "SO: carga de '%s' em %d-%d", nome_do_executavel, end_ini, end_fim);
   return end_ini;
 }
 
@@ -9,38 +9,89 @@
 // Declaração antecipada para evitar dependência circular
 typedef struct processo_t processo_t;
 
+// valores padrão da configuração (ver so_config_t)
 #define INTERVALO_INTERRUPCAO 20
 #define QUANTUM 5
 #define ESCALONADOR 2 // 1 para prioridade, 2 round-robin, 3 para simples
-#define QTD_IRQ 6     // qtd de interrupção
-
-typedef struct no_fila_t {
-    processo_t *processo;
-    struct no_fila_t *proximo;
-} no_fila_t;
+#define QTD_IRQ N_IRQ // qtd de interrupção
+#define NUM_TERMINAIS 4 // terminais disponíveis para os processos
 
+// fila de processos prontos; os processos são encadeados pelos campos
+//   'anterior_pronto' e 'proximo_pronto' do processo_t, sem alocação de
+//   memória, e podem ser removidos de qualquer posição em O(1)
 typedef struct {
-    no_fila_t *inicio;
-    no_fila_t *fim;
+    processo_t *inicio;
+    processo_t *fim;
 } fila_t;
 
+// fila de processos bloqueados à espera de um recurso (um dispositivo ou o
+//   fim de um processo); os processos são encadeados pelo campo
+//   'proximo_espera' do processo_t, sem alocação de memória
+typedef struct {
+    processo_t *inicio;
+    processo_t *fim;
+} fila_espera_t;
+
+// configuração do SO, que pode ser alterada sem recompilar (ver main.c)
+typedef struct {
+    int intervalo_interrupcao; // unidade do quantum, em instruções
+    int quantum;               // em intervalos do relógio
+    int escalonador;           // 1 para prioridade, 2 round-robin, 3 simples
+} so_config_t;
+
 typedef struct {
     int tempo_total_execucao;
     int tempo_total_ocioso;
     int num_interrupcoes[QTD_IRQ];
     int num_preempcoes;
+    // processos que um núcleo pegou da fila de prontos de outro
+    int num_roubos;
+    // métricas dos processos que já terminaram (ver metrica.h)
+    struct metricas_terminado_t *terminados;
+    int num_terminados;
+    int cap_terminados;
 } so_metricas_t;
 
-typedef struct so_t {
+// o estado do SO que é de cada núcleo (CPU)
+// cada núcleo tem a sua fila de prontos (a fila ou o heap, conforme o
+//   escalonador); um processo pronto fica na fila do núcleo em que executou
+//   por último (campo 'nucleo' do processo_t), e o núcleo que fica sem
+//   processos pega um da fila de outro
+typedef struct so_nucleo_t {
+    struct so_t *so;
+    int id;
     cpu_t *cpu;
-    mem_t *mem;
     es_t *es;
-    console_t *console;
-    bool erro_interno;
     processo_t *processo_corrente;
-    processo_t **processos;
-    fila_t *fila_prontos;
+    fila_t fila_prontos;
+    // fila de prontos do escalonador por prioridade (ver heap_prontos.h)
+    struct heap_prontos_t *heap_prontos;
     int quantum_proc;
+    // instante em que termina o quantum do processo corrente
+    int fim_quantum;
+    // instante para o qual o timer está programado, 0 se desligado
+    int alarme;
+    // foi pedida uma interrupção ao núcleo (IRQ_NUCLEO) que ele ainda não
+    //   atendeu
+    bool acordando;
+} so_nucleo_t;
+
+typedef struct so_t {
+    mem_t *mem;
+    console_t *console;
+    bool erro_interno;
+    int n_nucleos;
+    so_nucleo_t nucleos[IRQ_MAX_NUCLEOS];
+    // o núcleo que entrou no SO (o que está sendo atendido)
+    so_nucleo_t *nucleo;
+    // processos vivos (os terminados são retirados da tabela e liberados)
+    struct tabproc_t *tabela_processos;
+    int escalonador;
+    int intervalo_interrupcao;
+    int quantum;
+    // processos bloqueados esperando o teclado e a tela de cada terminal
+    fila_espera_t espera_teclado[NUM_TERMINAIS];
+    fila_espera_t espera_tela[NUM_TERMINAIS];
     int pid_atual;
     so_metricas_t metricas;
     int numero_processos;
@@ -48,9 +99,18 @@ typedef struct so_t {
 } so_t;
 
 // Declarações de funções do sistema operacional
-so_t *so_cria(cpu_t *cpu, mem_t *mem, es_t *es, console_t *console);
+// o SO executa nos 'n_nucleos' núcleos, cada um com a sua CPU e o seu
+//   controlador de E/S, que compartilham a memória
+so_t *so_cria(int n_nucleos, cpu_t *cpu[n_nucleos], mem_t *mem,
+              es_t *es[n_nucleos], console_t *console, so_config_t *config);
 void so_destroi(so_t *self);
 
+// retorna o nome do escalonador (prioridade, round-robin ou simples)
+char *so_nome_escalonador(int escalonador);
+// coloca em '*pescalonador' o escalonador de nome 'nome' (ou número, em texto)
+// retorna false se não existir escalonador com esse nome
+bool so_escalonador_por_nome(char *nome, int *pescalonador);
+
 
 // Chamadas de sistema
 // Uma chamada de sistema é realizada colocando a identificação da
@@ -0,0 +1,284 @@
+#include "tabproc.h"
+#include <stdlib.h>
+#include <assert.h>
+
+// capacidade inicial do vetor de processos; o índice tem o dobro
+#define TAM_INICIAL 8
+
+struct tabproc_t {
+    // vetor denso com os processos
+    processo_t **processos;
+    int tam;
+    int capacidade;
+    // índice por pid: hash com endereçamento aberto e sondagem linear,
+    //   com tamanho potência de 2 e pelo menos o dobro do número de processos
+    processo_t **indice;
+    int tam_indice;
+    // número de processos em cada estado
+    int num_no_estado[ESTADO_N];
+    // heap mínimo por pid dos processos prontos, com a mesma capacidade do
+    //   vetor de processos
+    processo_t **prontos;
+    int num_prontos;
+};
+
+tabproc_t *tabproc_cria(void)
+{
+    tabproc_t *self = malloc(sizeof(*self));
+    assert(self != NULL);
+    self->processos = malloc(TAM_INICIAL * sizeof(processo_t *));
+    assert(self->processos != NULL);
+    self->tam = 0;
+    self->capacidade = TAM_INICIAL;
+    self->tam_indice = 2 * TAM_INICIAL;
+    self->indice = calloc(self->tam_indice, sizeof(processo_t *));
+    assert(self->indice != NULL);
+    self->prontos = malloc(TAM_INICIAL * sizeof(processo_t *));
+    assert(self->prontos != NULL);
+    self->num_prontos = 0;
+    for (int i = 0; i < ESTADO_N; i++)
+    {
+        self->num_no_estado[i] = 0;
+    }
+    return self;
+}
+
+void tabproc_destroi(tabproc_t *self)
+{
+    free(self->processos);
+    free(self->indice);
+    free(self->prontos);
+    free(self);
+}
+
+// ÍNDICE POR PID {{{1
+
+static int posicao_inicial(tabproc_t *self, int pid)
+{
+    // os pids são sequenciais, já se espalham bem pelo índice
+    return pid & (self->tam_indice - 1);
+}
+
+static void indice_insere(tabproc_t *self, processo_t *proc)
+{
+    int mascara = self->tam_indice - 1;
+    int i = posicao_inicial(self, proc->pid);
+    while (self->indice[i] != NULL)
+    {
+        i = (i + 1) & mascara;
+    }
+    self->indice[i] = proc;
+}
+
+static int indice_posicao(tabproc_t *self, int pid)
+{
+    int mascara = self->tam_indice - 1;
+    for (int i = posicao_inicial(self, pid); self->indice[i] != NULL; i = (i + 1) & mascara)
+    {
+        if (self->indice[i]->pid == pid)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void indice_remove(tabproc_t *self, processo_t *proc)
+{
+    int mascara = self->tam_indice - 1;
+    int vazio = indice_posicao(self, proc->pid);
+    assert(vazio >= 0);
+    self->indice[vazio] = NULL;
+    // puxa para trás os elementos seguintes que não estão na sua posição
+    //   inicial e que não seriam mais encontrados com o buraco
+    for (int i = (vazio + 1) & mascara; self->indice[i] != NULL; i = (i + 1) & mascara)
+    {
+        int ini = posicao_inicial(self, self->indice[i]->pid);
+        // distâncias (circulares) da posição inicial até o buraco e até i
+        int ate_vazio = (vazio - ini) & mascara;
+        int ate_i = (i - ini) & mascara;
+        if (ate_vazio < ate_i)
+        {
+            self->indice[vazio] = self->indice[i];
+            self->indice[i] = NULL;
+            vazio = i;
+        }
+    }
+}
+
+static void indice_aumenta(tabproc_t *self)
+{
+    free(self->indice);
+    self->tam_indice *= 2;
+    self->indice = calloc(self->tam_indice, sizeof(processo_t *));
+    assert(self->indice != NULL);
+    for (int i = 0; i < self->tam; i++)
+    {
+        indice_insere(self, self->processos[i]);
+    }
+}
+
+// HEAP DE PRONTOS POR PID {{{1
+
+static void prontos_coloca(tabproc_t *self, int i, processo_t *proc)
+{
+    self->prontos[i] = proc;
+    proc->indice_prontos_tabela = i;
+}
+
+static void prontos_sobe(tabproc_t *self, int i)
+{
+    processo_t *proc = self->prontos[i];
+    while (i > 0)
+    {
+        int pai = (i - 1) / 2;
+        if (self->prontos[pai]->pid < proc->pid)
+        {
+            break;
+        }
+        prontos_coloca(self, i, self->prontos[pai]);
+        i = pai;
+    }
+    prontos_coloca(self, i, proc);
+}
+
+static void prontos_desce(tabproc_t *self, int i)
+{
+    processo_t *proc = self->prontos[i];
+    for (;;)
+    {
+        int filho = 2 * i + 1;
+        if (filho >= self->num_prontos)
+        {
+            break;
+        }
+        if (filho + 1 < self->num_prontos && self->prontos[filho + 1]->pid < self->prontos[filho]->pid)
+        {
+            filho++;
+        }
+        if (proc->pid < self->prontos[filho]->pid)
+        {
+            break;
+        }
+        prontos_coloca(self, i, self->prontos[filho]);
+        i = filho;
+    }
+    prontos_coloca(self, i, proc);
+}
+
+static void prontos_insere(tabproc_t *self, processo_t *proc)
+{
+    // cabe: o heap tem a capacidade do vetor de processos
+    prontos_coloca(self, self->num_prontos++, proc);
+    prontos_sobe(self, self->num_prontos - 1);
+}
+
+static void prontos_remove(tabproc_t *self, processo_t *proc)
+{
+    int i = proc->indice_prontos_tabela;
+    assert(i >= 0 && i < self->num_prontos && self->prontos[i] == proc);
+    proc->indice_prontos_tabela = -1;
+    self->num_prontos--;
+    if (i == self->num_prontos)
+    {
+        return;
+    }
+    // coloca o último no lugar do removido, e acerta a posição dele
+    processo_t *movido = self->prontos[self->num_prontos];
+    prontos_coloca(self, i, movido);
+    prontos_sobe(self, i);
+    prontos_desce(self, movido->indice_prontos_tabela);
+}
+
+// OPERAÇÕES {{{1
+
+void tabproc_insere(tabproc_t *self, processo_t *proc)
+{
+    assert(tabproc_busca(self, proc->pid) == NULL);
+    if (self->tam == self->capacidade)
+    {
+        self->capacidade *= 2;
+        self->processos = realloc(self->processos, self->capacidade * sizeof(processo_t *));
+        assert(self->processos != NULL);
+        self->prontos = realloc(self->prontos, self->capacidade * sizeof(processo_t *));
+        assert(self->prontos != NULL);
+    }
+    proc->indice_tabela = self->tam;
+    self->processos[self->tam++] = proc;
+    if (2 * self->tam > self->tam_indice)
+    {
+        indice_aumenta(self);
+    }
+    else
+    {
+        indice_insere(self, proc);
+    }
+    proc->tabela = self;
+    self->num_no_estado[proc->estado]++;
+    if (proc->estado == ESTADO_PRONTO)
+    {
+        prontos_insere(self, proc);
+    }
+}
+
+void tabproc_remove(tabproc_t *self, processo_t *proc)
+{
+    int i = proc->indice_tabela;
+    assert(i >= 0 && i < self->tam && self->processos[i] == proc);
+    indice_remove(self, proc);
+    self->tam--;
+    if (i < self->tam)
+    {
+        self->processos[i] = self->processos[self->tam];
+        self->processos[i]->indice_tabela = i;
+    }
+    self->num_no_estado[proc->estado]--;
+    if (proc->estado == ESTADO_PRONTO)
+    {
+        prontos_remove(self, proc);
+    }
+    proc->tabela = NULL;
+    proc->indice_tabela = -1;
+}
+
+processo_t *tabproc_busca(tabproc_t *self, int pid)
+{
+    int i = indice_posicao(self, pid);
+    return i < 0 ? NULL : self->indice[i];
+}
+
+int tabproc_tam(tabproc_t *self)
+{
+    return self->tam;
+}
+
+processo_t *tabproc_processo(tabproc_t *self, int i)
+{
+    return self->processos[i];
+}
+
+int tabproc_num_no_estado(tabproc_t *self, estado_processo_t estado)
+{
+    return self->num_no_estado[estado];
+}
+
+processo_t *tabproc_primeiro_pronto(tabproc_t *self)
+{
+    return self->num_prontos == 0 ? NULL : self->prontos[0];
+}
+
+void tabproc_muda_estado(tabproc_t *self, processo_t *proc, estado_processo_t estado)
+{
+    self->num_no_estado[proc->estado]--;
+    self->num_no_estado[estado]++;
+    if (proc->estado == ESTADO_PRONTO && estado != ESTADO_PRONTO)
+    {
+        prontos_remove(self, proc);
+    }
+    else if (proc->estado != ESTADO_PRONTO && estado == ESTADO_PRONTO)
+    {
+        prontos_insere(self, proc);
+    }
+}
+
+// vim: foldmethod=marker
@@ -0,0 +1,48 @@
+#ifndef TABPROC_H
+#define TABPROC_H
+
+#include "processo.h"
+
+// Tabela de processos do SO
+// Os descritores dos processos ficam num vetor denso (sem buracos), que cresce
+//   geometricamente; o lugar de um processo retirado da tabela é ocupado pelo
+//   último do vetor, e reaproveitado pelo próximo inserido.
+// Um índice (hash com endereçamento aberto) dá a posição de um processo a
+//   partir do seu pid em O(1).
+// A tabela mantém também o número de processos em cada estado, e um heap
+//   mínimo por pid dos processos prontos; para isso, as mudanças de estado
+//   devem ser feitas com proc_muda_estado ou proc_define_estado.
+
+typedef struct tabproc_t tabproc_t;
+
+tabproc_t *tabproc_cria(void);
+
+// destrói a tabela (não libera os processos que estiverem nela)
+void tabproc_destroi(tabproc_t *self);
+
+// insere o processo na tabela; não pode haver outro com o mesmo pid
+void tabproc_insere(tabproc_t *self, processo_t *proc);
+
+// retira o processo da tabela (não libera o processo)
+void tabproc_remove(tabproc_t *self, processo_t *proc);
+
+// retorna o processo com o pid, ou NULL se não estiver na tabela
+processo_t *tabproc_busca(tabproc_t *self, int pid);
+
+// número de processos na tabela, e o processo na posição i (0 <= i < tam)
+// a ordem dos processos muda quando um processo é retirado da tabela
+int tabproc_tam(tabproc_t *self);
+processo_t *tabproc_processo(tabproc_t *self, int i);
+
+// número de processos da tabela que estão no estado
+int tabproc_num_no_estado(tabproc_t *self, estado_processo_t estado);
+
+// retorna o processo pronto de menor pid (o mais antigo), ou NULL se não
+//   tiver processo pronto na tabela, em O(1)
+processo_t *tabproc_primeiro_pronto(tabproc_t *self);
+
+// registra que o processo vai passar para o estado; chamada por
+//   proc_define_estado, antes de alterar o estado do processo
+void tabproc_muda_estado(tabproc_t *self, processo_t *proc, estado_processo_t estado);
+
+#endif // TABPROC_H
@@ -6,19 +6,97 @@
 #include "terminal.h"
 
 #include <stdlib.h>
-#include <string.h>
 #include <assert.h>
 
-// TERMINAL
+// FILA DE CARACTERES {{{1
+
+// fila circular de caracteres, usada para a entrada e a saída do terminal
+// cada caractere é guardado em duas posições do buffer (i e i + cap), para
+//   que o conteúdo esteja sempre contíguo a partir de buf[ini], e é mantido
+//   um '\0' depois do último: a console desenha direto do buffer, como
+//   string, e inserir ou remover nas pontas não move os outros caracteres
+typedef struct {
+  char *buf;  // 2 * cap + 1 caracteres
+  int cap;
+  int ini;    // posição do primeiro caractere (0 a cap-1)
+  int tam;    // número de caracteres na fila
+  unsigned versao;  // muda a cada alteração do conteúdo
+} fila_car_t;
+
+static void fila_inicializa(fila_car_t *f, int cap)
+{
+  f->buf = malloc(2 * cap + 1);
+  assert(f->buf != NULL);
+  f->cap = cap;
+  f->ini = 0;
+  f->tam = 0;
+  f->buf[0] = '\0';
+  f->versao = 0;
+}
+
+static void fila_esvazia(fila_car_t *f)
+{
+  f->versao++;
+  f->ini = 0;
+  f->tam = 0;
+  f->buf[0] = '\0';
+}
+
+// altera o caractere na posição 'pos' da fila (0 é o primeiro)
+static void fila_altera(fila_car_t *f, int pos, char ch)
+{
+  int i = (f->ini + pos) % f->cap;
+  f->versao++;
+  f->buf[i] = ch;
+  f->buf[i + f->cap] = ch;
+}
+
+// insere no final da fila, que não pode estar cheia
+static void fila_insere(fila_car_t *f, char ch)
+{
+  assert(f->tam < f->cap);
+  fila_altera(f, f->tam, ch);
+  f->tam++;
+  f->buf[f->ini + f->tam] = '\0';
+}
+
+// remove e retorna o primeiro caractere da fila, que não pode estar vazia
+static char fila_remove(fila_car_t *f)
+{
+  assert(f->tam > 0);
+  char ch = f->buf[f->ini];
+  f->versao++;
+  f->ini = (f->ini + 1) % f->cap;
+  f->tam--;
+  f->buf[f->ini + f->tam] = '\0';
+  return ch;
+}
+
+// remove o último caractere da fila, que não pode estar vazia
+static void fila_remove_ultimo(fila_car_t *f)
+{
+  assert(f->tam > 0);
+  f->versao++;
+  f->tam--;
+  f->buf[f->ini + f->tam] = '\0';
+}
+
+// retorna o conteúdo da fila, como string (no próprio buffer, não alterar)
+static char *fila_txt(fila_car_t *f)
+{
+  return &f->buf[f->ini];
+}
+
+// TERMINAL {{{1
 
 // dados para cada terminal
 struct terminal_t {
   // número de caracteres que cabem em uma linha
   int tam_linha;
   // texto já digitado no terminal, esperando para ser lido
-  char *entrada;
+  fila_car_t entrada;
   // texto sendo mostrado na saída do terminal
-  char *saida;
+  fila_car_t saida;
   // normal: aceitando novos caracteres na saída
   // rolando: removendo um caractere no início para gerar espaço.
   //   move um caractere por vez para a esquerda, até chegar no final
@@ -32,6 +110,17 @@ struct terminal_t {
   enum { normal, rolando, limpando } estado_saida;
   // posicao do caractere que está sendo movido durante uma rolagem
   int pos_rolagem;
+  // arquivo de onde vem a entrada (NULL se vem da console), o intervalo
+  //   em tictacs entre caracteres e quantos tictacs passaram desde o último
+  FILE *arq_entrada;
+  int intervalo_entrada;
+  int t_entrada;
+  // arquivo onde a saída é copiada (NULL se não é)
+  FILE *arq_saida;
+  // controlador onde são pedidas as interrupções (NULL se não pede) e o
+  //   número que identifica o terminal nos pedidos
+  pic_t *pic;
+  int origem;
 };
 
 
@@ -40,48 +129,99 @@ terminal_t *terminal_cria(int tam_linha)
   terminal_t *self = malloc(sizeof(*self));
   assert(self != NULL);
 
-  self->saida = malloc(tam_linha + 1);
-  self->entrada = malloc(tam_linha + 1);
-  assert(self->saida != NULL && self->entrada != NULL);
+  fila_inicializa(&self->entrada, tam_linha);
+  fila_inicializa(&self->saida, tam_linha);
 
   self->tam_linha = tam_linha;
-  strcpy(self->entrada, "");
-  strcpy(self->saida, "");
   self->estado_saida = normal;
+  self->arq_entrada = NULL;
+  self->intervalo_entrada = 0;
+  self->t_entrada = 0;
+  self->arq_saida = NULL;
+  self->pic = NULL;
+  self->origem = 0;
 
   return self;
 }
 
 void terminal_destroi(terminal_t *self)
 {
-  free(self->entrada);
-  free(self->saida);
+  if (self->arq_entrada != NULL) fclose(self->arq_entrada);
+  if (self->arq_saida != NULL) fclose(self->arq_saida);
+  free(self->entrada.buf);
+  free(self->saida.buf);
   free(self);
 }
 
 static bool terminal_entrada_vazia(terminal_t *self)
 {
-  return self->entrada[0] == '\0';
+  return self->entrada.tam == 0;
 }
 
 static char terminal_le_char(terminal_t *self)
 {
-  char *p = self->entrada;
-  char ch = p[0];
-  if (ch != '\0') {
-    memmove(&p[0], &p[1], strlen(p));
-  }
-  return ch;
+  if (terminal_entrada_vazia(self)) return '\0';
+  return fila_remove(&self->entrada);
+}
+
+static bool terminal_entrada_cheia(terminal_t *self)
+{
+  return self->entrada.tam >= self->tam_linha-2;
+}
+
+// pede uma interrupção na linha 'irq', se estiver ligado a um controlador
+static void terminal_interrompe(terminal_t *self, irq_t irq)
+{
+  if (self->pic != NULL) pic_pede(self->pic, irq, self->origem);
 }
 
 void terminal_insere_char(terminal_t *self, char ch)
 {
-  char *p = self->entrada;
-  int tam = strlen(p);
   // se não cabe, ignora silenciosamente
-  if (tam >= self->tam_linha-2) return;
-  p[tam] = ch;
-  p[tam+1] = '\0';
+  if (terminal_entrada_cheia(self)) return;
+  bool estava_vazia = terminal_entrada_vazia(self);
+  fila_insere(&self->entrada, ch);
+  // quem espera a entrada só precisa saber quando ela deixa de estar vazia
+  if (estava_vazia) terminal_interrompe(self, IRQ_TECLADO);
+}
+
+void terminal_define_entrada(terminal_t *self, FILE *arq, int intervalo)
+{
+  if (self->arq_entrada != NULL) fclose(self->arq_entrada);
+  self->arq_entrada = arq;
+  self->intervalo_entrada = intervalo;
+  self->t_entrada = 0;
+}
+
+void terminal_define_pic(terminal_t *self, pic_t *pic, int origem)
+{
+  self->pic = pic;
+  self->origem = origem;
+}
+
+void terminal_define_saida(terminal_t *self, FILE *arq)
+{
+  if (self->arq_saida != NULL) fclose(self->arq_saida);
+  self->arq_saida = arq;
+  // a cópia é gravada linha a linha, para poder ser acompanhada durante a
+  //   execução (com tail -f, por exemplo)
+  setvbuf(arq, NULL, _IOLBF, 0);
+}
+
+// insere na entrada até n caracteres do arquivo de entrada (ou quantos couberem)
+static void terminal_le_arquivo(terminal_t *self, int n)
+{
+  for (; n > 0 && !terminal_entrada_cheia(self); n--) {
+    int ch = fgetc(self->arq_entrada);
+    if (ch == EOF) {
+      fclose(self->arq_entrada);
+      self->arq_entrada = NULL;
+      return;
+    }
+    // o terminal guarda a entrada como string
+    if (ch == '\0') continue;
+    terminal_insere_char(self, ch);
+  }
 }
 
 static bool terminal_pode_imprimir(terminal_t *self)
@@ -92,54 +232,71 @@ static bool terminal_pode_imprimir(terminal_t *self)
 static void terminal_imprime(terminal_t *self, char ch)
 {
   if (terminal_pode_imprimir(self)) {
+    if (self->arq_saida != NULL) fputc(ch, self->arq_saida);
     if (ch == '\n') {
       self->estado_saida = limpando;
       return;
     }
-    int tam = strlen(self->saida);
-    self->saida[tam] = ch;
-    tam++;
-    self->saida[tam] = '\0';
-    if (tam >= self->tam_linha - 1) {
+    fila_insere(&self->saida, ch);
+    if (self->saida.tam >= self->tam_linha - 1) {
       self->estado_saida = rolando;
       self->pos_rolagem = 0;
     }
   }
 }
 
-void terminal_limpa_saida(terminal_t *self)
+// a saída volta a aceitar caracteres
+static void terminal_saida_pronta(terminal_t *self)
 {
-  self->saida[0] = '\0';
   self->estado_saida = normal;
+  terminal_interrompe(self, IRQ_TELA);
+}
+
+void terminal_limpa_saida(terminal_t *self)
+{
+  fila_esvazia(&self->saida);
+  if (self->estado_saida != normal) terminal_saida_pronta(self);
 }
 
 static void terminal_atualiza_rolagem(terminal_t *self)
 {
   // remove o caractere na posição de rolagem e avança
   // se chegou no final da string, terminou a rolagem
-  char *p = self->saida;
-  p[self->pos_rolagem] = p[self->pos_rolagem + 1];
-  if (p[self->pos_rolagem] != '\0') {
+  fila_car_t *f = &self->saida;
+  if (self->pos_rolagem + 1 < f->tam) {
+    fila_altera(f, self->pos_rolagem, fila_txt(f)[self->pos_rolagem + 1]);
     self->pos_rolagem++;
-    p[self->pos_rolagem] = ' ';
+    fila_altera(f, self->pos_rolagem, ' ');
   } else {
-    self->estado_saida = normal;
+    fila_remove_ultimo(f);
+    terminal_saida_pronta(self);
   }
 }
 
 static void terminal_atualiza_limpeza(terminal_t *self)
 {
   // remove um caractere do início da string; volta ao estado normal se era o último
-  char *p = self->saida;
-  int tam = strlen(p);
-  memmove(p, p+1, tam);
-  if (tam <= 1) {
-    self->estado_saida = normal;
+  if (self->saida.tam > 0) fila_remove(&self->saida);
+  if (self->saida.tam == 0) {
+    terminal_saida_pronta(self);
   }
 }
 
+// avança a entrada vinda de arquivo em n tictacs: a cada 'intervalo_entrada'
+//   tictacs chega um caractere, que só é inserido se couber
+static void terminal_atualiza_entrada(terminal_t *self, int n)
+{
+  if (self->intervalo_entrada == 0) {
+    terminal_le_arquivo(self, self->tam_linha);
+    return;
+  }
+  self->t_entrada += n;
+  terminal_le_arquivo(self, self->t_entrada / self->intervalo_entrada);
+  self->t_entrada %= self->intervalo_entrada;
+}
+
 // altera a string de saída em 1 caractere, se estiver rolando ou limpando
-void terminal_tictac(terminal_t *self)
+static void terminal_atualiza_saida(terminal_t *self)
 {
   switch (self->estado_saida) {
     case normal: 
@@ -153,16 +310,67 @@ void terminal_tictac(terminal_t *self)
   }
 }
 
+// avança a saída e, se vem de arquivo, a entrada
+void terminal_tictac(terminal_t *self)
+{
+  if (self->arq_entrada != NULL) terminal_atualiza_entrada(self, 1);
+  terminal_atualiza_saida(self);
+}
+
+void terminal_avanca(terminal_t *self, int n)
+{
+  // a entrada só depende de quantos tictacs passaram (a CPU não lê no meio)
+  if (self->arq_entrada != NULL) terminal_atualiza_entrada(self, n);
+  // depois que a saída volta ao normal, os tictacs não têm efeito
+  for (; n > 0 && self->estado_saida != normal; n--) {
+    terminal_atualiza_saida(self);
+  }
+}
+
+int terminal_tempo_ate_interrupcao(terminal_t *self)
+{
+  if (self->pic == NULL) return 0;
+  int t = 0;
+  // a rolagem anda uma posição por tictac e termina no seguinte; a limpeza
+  //   remove um caractere por tictac (e leva um com a linha já vazia)
+  switch (self->estado_saida) {
+    case normal:
+      break;
+    case rolando:
+      t = self->saida.tam - self->pos_rolagem;
+      break;
+    case limpando:
+      t = self->saida.tam > 0 ? self->saida.tam : 1;
+      break;
+  }
+  // só a chegada na entrada vazia pede interrupção
+  if (self->arq_entrada != NULL && terminal_entrada_vazia(self)) {
+    int t_entrada = 1;
+    if (self->intervalo_entrada > 0) {
+      t_entrada = self->intervalo_entrada - self->t_entrada;
+    }
+    if (t == 0 || t_entrada < t) t = t_entrada;
+  }
+  return t;
+}
+
 char *terminal_txt_entrada(terminal_t *self)
 {
-  return self->entrada;
+  return fila_txt(&self->entrada);
 }
 
 char *terminal_txt_saida(terminal_t *self)
 {
-  return self->saida;
+  return fila_txt(&self->saida);
 }
 
+unsigned terminal_versao(terminal_t *self)
+{
+  return self->entrada.versao + self->saida.versao;
+}
+
+// DISPOSITIVOS {{{1
+
 // Operações de leitura e escrita no terminal, chamadas pelo controlador de E/S
 // Para o controlador, cada terminal é composto por 4 dispositivos:
 //   leitura, estado da leitura, escrita, estado da escrita
@@ -216,3 +424,5 @@ err_t terminal_escrita(void *disp, int id, int valor)
   }
   return ERR_OK;
 }
+
+// vim: foldmethod=marker
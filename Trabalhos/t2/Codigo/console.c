@@ -14,6 +14,9 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <ctype.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
 #include <assert.h>
 
 // CONSTANTES {{{1
@@ -36,6 +39,15 @@
 #define LINHA_CONSOLE (LINHA_STATUS + N_LIN_STATUS)
 #define LINHA_ENTRADA (LINHA_CONSOLE + N_LIN_CONSOLE)
 
+// número de linhas da console guardadas (as que saíram da tela podem ser
+//   vistas com o comando R do operador)
+#define N_HIST_CONSOLE 500
+// tamanho máximo de uma mensagem impressa na console
+#define TAM_MSG (N_LIN_CONSOLE * (N_COL+1))
+
+// número máximo de desenhos da tela por segundo (em console_tictac)
+#define FPS_MAX 60
+
 // números de comandos para o controlador que podem ser guardados na console
 #define N_CMD_EXT 10
 
@@ -46,16 +58,37 @@ struct console_t {
   int cor_txt[N_TERM];
   int cor_cursor[N_TERM];
   char txt_status[N_COL+1];
-  char txt_console[N_LIN_CONSOLE][N_COL+1];
+  // as linhas da console, em um buffer circular: a próxima linha vai em
+  //   'fim_console', sobrescrevendo a mais antiga se tiver 'N_HIST_CONSOLE'
+  char txt_console[N_HIST_CONSOLE][N_COL+1];
+  int fim_console;
+  int n_console;
+  // quantas linhas antes da última está a última linha mostrada na tela
+  int rolagem_console;
   char txt_entrada[N_COL+1];
   char fila_de_comandos_externos[N_CMD_EXT];
   FILE *arquivo_de_log;
+  // false se a console não usa a tela (comandos vêm da entrada padrão)
+  bool com_tela;
+  // flags originais da entrada padrão, para restaurar na destruição
+  int flags_entrada;
+  // o que mudou desde o último desenho da tela (dos terminais, a versão
+  //   que foi desenhada), e quando foi esse desenho (em segundos)
+  unsigned versao_desenhada[N_TERM];
+  bool mudou_status;
+  bool mudou_console;
+  bool mudou_entrada;
+  double t_desenho;
 };
 
 // CRIAÇÃO {{{1
 
+console_nivel_t console_nivel = NIVEL_INFO;
+
+static void console_marca_tudo(console_t *self);
+
 static console_t *console_global; // gambiarra para simplificar o uso de prints na console
-console_t *console_cria(void)
+console_t *console_cria(bool com_tela)
 {
   console_t *self = malloc(sizeof(*self));
   assert(self != NULL);
@@ -71,14 +104,25 @@ console_t *console_cria(void)
       self->cor_cursor[t] = COR_CURSOR_IMPAR;
     }
   }
-  for (int l = 0; l < N_LIN_CONSOLE; l++) {
-    strcpy(self->txt_console[l], "");
-  }
+  self->fim_console = 0;
+  self->n_console = 0;
+  self->rolagem_console = 0;
   strcpy(self->txt_entrada, "");
   self->fila_de_comandos_externos[0] = '\0';
   self->arquivo_de_log = fopen("log_da_console", "w");
-
-  tela_init();
+  self->com_tela = com_tela;
+  console_marca_tudo(self);
+  self->t_desenho = 0;
+
+  if (com_tela) {
+    tela_init();
+  } else {
+    // sem tela, os comandos são lidos da entrada padrão, sem bloquear
+    self->flags_entrada = fcntl(STDIN_FILENO, F_GETFL);
+    if (self->flags_entrada != -1) {
+      fcntl(STDIN_FILENO, F_SETFL, self->flags_entrada | O_NONBLOCK);
+    }
+  }
 
   return self;
 }
@@ -87,14 +131,19 @@ static void console_desenha(console_t *self);
 
 void console_destroi(console_t *self)
 {
-  console_desenha(self);
   if (self->arquivo_de_log != NULL) fclose(self->arquivo_de_log);
-  tela_puts(COR_OCUPADO, "  digite ENTER para sair  ");
-  tela_atualiza();
-  while (tela_tecla() != '\n') {
-    ;
+  if (self->com_tela) {
+    console_marca_tudo(self);
+    console_desenha(self);
+    tela_puts(COR_OCUPADO, "  digite ENTER para sair  ");
+    tela_atualiza();
+    while (tela_tecla() != '\n') {
+      ;
+    }
+    tela_fim();
+  } else if (self->flags_entrada != -1) {
+    fcntl(STDIN_FILENO, F_SETFL, self->flags_entrada);
   }
-  tela_fim();
 
   for (int t = 0; t < N_TERM; t++) {
     terminal_destroi(self->term[t]);
@@ -149,12 +198,15 @@ static void limpa_saida_do_terminal(console_t *self, char id_terminal)
 
 static void insere_string_na_console(console_t *self, char *s)
 {
-  for(int l=0; l<N_LIN_CONSOLE-1; l++) {
-    strncpy(self->txt_console[l], self->txt_console[l+1], N_COL);
-    self->txt_console[l][N_COL] = '\0'; // quem definiu strncpy é estúpido!
-  }
-  strncpy(self->txt_console[N_LIN_CONSOLE-1], s, N_COL);
-  self->txt_console[N_LIN_CONSOLE-1][N_COL] = '\0'; // grrrr
+  // a linha nova ocupa o lugar da mais antiga, as outras não mudam
+  char *linha = self->txt_console[self->fim_console];
+  strncpy(linha, s, N_COL);
+  linha[N_COL] = '\0'; // quem definiu strncpy é estúpido!
+  self->fim_console = (self->fim_console + 1) % N_HIST_CONSOLE;
+  if (self->n_console < N_HIST_CONSOLE) self->n_console++;
+  // se o operador está vendo linhas antigas, continua vendo as mesmas
+  if (self->rolagem_console > 0) self->rolagem_console++;
+  self->mudou_console = true;
   if (self->arquivo_de_log != NULL) {
     fprintf(self->arquivo_de_log, "%s\n", s);
   }
@@ -178,7 +230,12 @@ static void insere_strings_na_console(console_t *self, char *s)
 void console_print_status(console_t *self, char *txt)
 {
   // imprime alinhado a esquerda ("-"), max N_COL chars ("*")
-  sprintf(self->txt_status, "%-*s", N_COL, txt);
+  char novo[N_COL+1];
+  snprintf(novo, sizeof(novo), "%-*s", N_COL, txt);
+  if (strcmp(novo, self->txt_status) != 0) {
+    strcpy(self->txt_status, novo);
+    self->mudou_status = true;
+  }
 }
 
 int console_printf(char *formato, ...)
@@ -187,7 +244,7 @@ int console_printf(char *formato, ...)
   // Se não sabe como é isso, dá uma olhada em:
   // https://www.geeksforgeeks.org/variadic-functions-in-c/
   console_t *self = console_global; // gambiarra para simplificar o uso de prints na console
-  char s[sizeof(self->txt_console)];
+  char s[TAM_MSG];
   va_list arg;
   va_start(arg, formato);
   int r = vsnprintf(s, sizeof(s), formato, arg);
@@ -195,6 +252,34 @@ int console_printf(char *formato, ...)
   return r;
 }
 
+// NÍVEL DAS MENSAGENS {{{1
+
+static char *nomes_niveis[N_NIVEL] = {
+  [NIVEL_ERRO]      = "erro",
+  [NIVEL_INFO]      = "info",
+  [NIVEL_DEPURACAO] = "depuracao",
+  [NIVEL_DETALHE]   = "detalhe",
+};
+
+void console_define_nivel(console_nivel_t nivel)
+{
+  if (nivel < NIVEL_ERRO) nivel = NIVEL_ERRO;
+  if (nivel >= N_NIVEL) nivel = N_NIVEL - 1;
+  console_nivel = nivel;
+}
+
+bool console_nivel_por_nome(char *nome, console_nivel_t *pnivel)
+{
+  for (int n = 0; n < N_NIVEL; n++) {
+    if (strcmp(nome, nomes_niveis[n]) == 0
+        || (isdigit(nome[0]) && nome[1] == '\0' && nome[0] - '0' == n)) {
+      *pnivel = n;
+      return true;
+    }
+  }
+  return false;
+}
+
 // ENTRADA {{{1
 
 static void insere_comando_externo(console_t *self, char c)
@@ -223,6 +308,8 @@ static void interpreta_linha_entrada(console_t *self)
   // Etstr entra a string 'str' no terminal 't'  ex: eb30
   // Zt    esvazia a saída do terminal 't'  ex: za
   // Dn    altera o tempo de espera do teclado  ex: d0  -> modo turbo
+  // Vn    altera o nível das mensagens (0 a 3, ver console.h)  ex: v2
+  // Rn    mostra a console n linhas antes do fim  ex: r40  (r volta ao fim)
   // P     para a execução
   // 1     executa uma instrução
   // C     continua a execução
@@ -241,7 +328,15 @@ static void interpreta_linha_entrada(console_t *self)
       break;
     case 'D':
       val = atoi(&linha[1]);
-      tela_espera(val);
+      console_define_espera(self, val);
+      break;
+    case 'R':
+      val = atoi(&linha[1]);
+      self->rolagem_console = val > 0 ? val : 0;
+      self->mudou_console = true;
+      break;
+    case 'V':
+      console_define_nivel(atoi(&linha[1]));
       break;
     case 'P':
     case '1':
@@ -255,10 +350,21 @@ static void interpreta_linha_entrada(console_t *self)
   strcpy(self->txt_entrada, "");
 }
 
+// retorna o próximo caractere digitado pelo operador, ou 0 se não houver
+static char le_tecla(console_t *self)
+{
+  if (self->com_tela) return tela_tecla();
+  char ch;
+  if (read(STDIN_FILENO, &ch, 1) != 1) return 0;
+  return ch;
+}
+
 // lê e guarda um caractere do teclado; interpreta linha se for 'enter'
 static void verifica_entrada(console_t *self)
 {
-  char ch = tela_tecla();
+  char ch = le_tecla(self);
+  if (ch == 0) return;
+  self->mudou_entrada = true;
 
   int l = strlen(self->txt_entrada);
 
@@ -282,6 +388,14 @@ char console_comando_externo(console_t *self)
 
 // DESENHO {{{1
 
+// retorna o tempo real, em segundos
+static double console_tempo_real(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
 static void desenha_linha_terminal(char *txt, int linha, int cor_txt, int cor_cursor)
 {
   tela_posiciona(linha, 0);
@@ -294,6 +408,9 @@ static void desenha_terminais(console_t *self)
 {
   for (int t = 0; t < N_TERM; t++) {
     terminal_t *terminal = self->term[t];
+    unsigned versao = terminal_versao(terminal);
+    if (versao == self->versao_desenhada[t]) continue;
+    self->versao_desenhada[t] = versao;
     int cor_txt = self->cor_txt[t];
     int cor_cursor = self->cor_cursor[t];
     int linha = LINHA_TERM + t * 2;
@@ -304,6 +421,8 @@ static void desenha_terminais(console_t *self)
 
 static void desenha_status(console_t *self)
 {
+  if (!self->mudou_status) return;
+  self->mudou_status = false;
   tela_posiciona(LINHA_STATUS, 0);
   tela_puts(COR_STATUS, self->txt_status);
   tela_limpa_linha();
@@ -311,9 +430,25 @@ static void desenha_status(console_t *self)
 
 static void desenha_console(console_t *self)
 {
+  if (!self->mudou_console) return;
+  self->mudou_console = false;
+  // não rola para antes da linha mais antiga
+  int rolagem = self->rolagem_console;
+  if (rolagem > self->n_console - N_LIN_CONSOLE) {
+    rolagem = self->n_console - N_LIN_CONSOLE;
+  }
+  if (rolagem < 0) rolagem = 0;
+  // as linhas são desenhadas direto do buffer circular
   for (int l=0; l<N_LIN_CONSOLE; l++) {
+    // quantas linhas antes da última está a linha l da tela
+    int antes = N_LIN_CONSOLE - 1 - l + rolagem;
+    char *txt = "";
+    if (antes < self->n_console) {
+      int i = (self->fim_console - 1 - antes + N_HIST_CONSOLE) % N_HIST_CONSOLE;
+      txt = self->txt_console[i];
+    }
     tela_posiciona(LINHA_CONSOLE + l, 0);
-    tela_puts(COR_CONSOLE, self->txt_console[l]);
+    tela_puts(COR_CONSOLE, txt);
     tela_limpa_linha();
   }
 }
@@ -321,6 +456,8 @@ static void desenha_console(console_t *self)
 static void desenha_entrada(console_t *self)
 {
   char txt_fixo[] = "P=para C=continua 1=passo F=fim  Ets=entra Zt=zera";
+  if (!self->mudou_entrada) return;
+  self->mudou_entrada = false;
   tela_posiciona(LINHA_ENTRADA, 0);
   tela_puts(COR_ENTRADA, ""); // gambiarra para limpar na cor certa
   tela_limpa_linha();
@@ -330,15 +467,50 @@ static void desenha_entrada(console_t *self)
   tela_puts(COR_ENTRADA, self->txt_entrada);
 }
 
+// faz com que tudo seja redesenhado no próximo desenho
+static void console_marca_tudo(console_t *self)
+{
+  for (int t = 0; t < N_TERM; t++) {
+    self->versao_desenhada[t] = terminal_versao(self->term[t]) - 1;
+  }
+  self->mudou_status = true;
+  self->mudou_console = true;
+  self->mudou_entrada = true;
+}
+
+// redesenha só as partes da tela que mudaram desde o último desenho
 static void console_desenha(console_t *self)
 {
+  if (!self->com_tela) return;
   desenha_terminais(self);
   desenha_status(self);
   desenha_console(self);
   desenha_entrada(self);
 
-  // faz aparecer tudo que foi desenhado
+  // deixa o cursor na linha de entrada e faz aparecer tudo que foi desenhado
+  //   (o curses só envia para a tela o que mudou)
+  tela_posiciona(LINHA_ENTRADA, strlen(self->txt_entrada));
   tela_atualiza();
+  self->t_desenho = console_tempo_real();
+}
+
+// desenha se já passou o intervalo mínimo desde o último desenho; o que
+//   mudou nesse meio tempo continua marcado, e aparece no próximo
+static void console_desenha_limitado(console_t *self)
+{
+  if (!self->com_tela) return;
+  if (console_tempo_real() - self->t_desenho < 1.0 / FPS_MAX) return;
+  console_desenha(self);
+}
+
+void console_redesenha(console_t *self)
+{
+  console_desenha(self);
+}
+
+void console_define_espera(console_t *self, int ms)
+{
+  if (self->com_tela) tela_espera(ms);
 }
 
 // TICTAC {{{1
@@ -346,7 +518,24 @@ void console_tictac(console_t *self)
 {
   verifica_entrada(self);
   atualiza_terminais(self);
-  console_desenha(self);
+  console_desenha_limitado(self);
+}
+
+void console_tictac_terminais(console_t *self, int n)
+{
+  for (int t = 0; t < N_TERM; t++) {
+    terminal_avanca(self->term[t], n);
+  }
+}
+
+int console_tempo_ate_interrupcao(console_t *self)
+{
+  int menor = 0;
+  for (int t = 0; t < N_TERM; t++) {
+    int tempo = terminal_tempo_ate_interrupcao(self->term[t]);
+    if (tempo > 0 && (menor == 0 || tempo < menor)) menor = tempo;
+  }
+  return menor;
 }
 
 // vim: foldmethod=marker
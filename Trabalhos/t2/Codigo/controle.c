@@ -8,21 +8,48 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <time.h>
+#include <limits.h>
 #include <assert.h>
 
+// número de instruções executadas entre verificações do tempo real no modo turbo
+#define LOTE_TURBO 1000
+// quantas vezes por segundo os comandos do operador são verificados no modo
+//   turbo quando a console não é redesenhada
+#define FREQ_COMANDOS 10
+
 struct controle_t {
   cpu_t *cpu;
   relogio_t *relogio;
+  disco_t *disco;
+  pic_t *pic;
   console_t *console;
   enum { executando, passo, parado, fim } estado;
+  controle_modo_t modo;
+  int freq_console;
+  // número máximo de instruções (pelo relógio), 0 se não tiver limite
+  int limite;
+  // tempo (pelo relógio) que a CPU passou parada, esperando interrupção
+  int t_parada;
 };
 
 // funções auxiliares
+static void controle_laco_interativo(controle_t *self);
+static void controle_laco_turbo(controle_t *self);
+static void controle_executa_1(controle_t *self);
+static int controle_executa_n(controle_t *self, int n);
+static bool controle_tem_interrupcao(controle_t *self);
+static bool controle_cpu_ociosa(controle_t *self);
+static void controle_interrompe(controle_t *self);
+static bool controle_maquina_inerte(controle_t *self);
+static int controle_resta_ate_limite(controle_t *self);
+static double controle_tempo_real(void);
 static void controle_processa_comandos_da_console(controle_t *self);
 static void controle_atualiza_estado_na_console(controle_t *self);
 
 
-controle_t *controle_cria(cpu_t *cpu, console_t *console, relogio_t *relogio)
+controle_t *controle_cria(cpu_t *cpu, console_t *console, relogio_t *relogio,
+                          disco_t *disco, pic_t *pic)
 {
   controle_t *self = malloc(sizeof(*self));
   assert(self != NULL);
@@ -30,7 +57,13 @@ controle_t *controle_cria(cpu_t *cpu, console_t *console, relogio_t *relogio)
   self->cpu = cpu;
   self->console = console;
   self->relogio = relogio;
+  self->disco = disco;
+  self->pic = pic;
   self->estado = parado;
+  self->modo = controle_interativo;
+  self->freq_console = 0;
+  self->limite = 0;
+  self->t_parada = 0;
 
   return self;
 }
@@ -40,34 +73,234 @@ void controle_destroi(controle_t *self)
   free(self);
 }
 
+void controle_define_modo(controle_t *self, controle_modo_t modo, int freq_console)
+{
+  self->modo = modo;
+  self->freq_console = freq_console;
+  if (modo != controle_interativo) {
+    // o laço turbo controla o seu ritmo, a leitura do teclado não deve esperar
+    console_define_espera(self->console, 0);
+  }
+  if (modo == controle_lote) {
+    self->estado = executando;
+  }
+}
+
+void controle_define_limite(controle_t *self, int instrucoes)
+{
+  self->limite = instrucoes;
+}
+
 void controle_laco(controle_t *self)
+{
+  int relogio_ini = relogio_agora(self->relogio);
+  double t_ini = controle_tempo_real();
+
+  if (self->modo == controle_interativo) {
+    controle_laco_interativo(self);
+  } else {
+    controle_laco_turbo(self);
+  }
+
+  double segundos = controle_tempo_real() - t_ini;
+  int instrucoes = relogio_agora(self->relogio) - relogio_ini;
+  double ips = segundos > 0 ? instrucoes / segundos : 0;
+  console_printf("Fim da execução.");
+  console_printf("relógio: %d\n", relogio_agora(self->relogio));
+  console_printf("tempo real: %.3fs, %.0f instruções/s", segundos, ips);
+  console_printf("tempo com a CPU parada: %d", self->t_parada);
+  if (self->modo == controle_lote) {
+    // não tem tela, o relatório vai para a saída padrão
+    printf("relógio: %d, tempo real: %.3fs, %.0f instruções/s\n",
+           relogio_agora(self->relogio), segundos, ips);
+  }
+}
+
+static void controle_laco_interativo(controle_t *self)
 {
   // executa uma instrução por vez até a console dizer que chega
   do {
     if (self->estado == passo || self->estado == executando) {
-      cpu_executa_1(self->cpu);
-      relogio_tictac(self->relogio);
-
-      if (self->estado == passo) self->estado = parado;
-
-      // enquanto não tem controlador de interrupção, fala direto com o relógio
-      // o dispositivo 3 do relógio contém 1 se o timer expirou
-      int tem_int;
-      relogio_leitura(self->relogio, 3, &tem_int);
-      if (tem_int != 0) {
-        cpu_interrompe(self->cpu, IRQ_RELOGIO);
+      if (controle_resta_ate_limite(self) == 0) {
+        self->estado = fim;
+        break;
       }
+      controle_executa_1(self);
+      if (self->estado == passo) self->estado = parado;
     }
     console_tictac(self->console);
 
     controle_processa_comandos_da_console(self);
     controle_atualiza_estado_na_console(self);
   } while (self->estado != fim);
+}
 
-  console_printf("Fim da execução.");
-  console_printf("relógio: %d\n", relogio_agora(self->relogio));
+static void controle_laco_turbo(controle_t *self)
+{
+  // o tempo real só é consultado a cada lote de instruções; a console só é
+  //   redesenhada e os comandos só são atendidos a cada 'periodo' segundos
+  int freq = self->freq_console > 0 ? self->freq_console : FREQ_COMANDOS;
+  double periodo = 1.0 / freq;
+  double proxima_atualizacao = 0;
+  do {
+    if (self->estado == executando) {
+      int lote = controle_resta_ate_limite(self);
+      if (lote == 0) {
+        self->estado = fim;
+        break;
+      }
+      if (controle_cpu_ociosa(self)) {
+        // a CPU está parada esperando um dispositivo: o tempo avança de uma
+        //   vez até o próximo evento (controle_executa_n não passa dele), sem
+        //   o limite do lote -- o tempo ocioso não custa tempo real
+        controle_executa_n(self, lote);
+      } else {
+        if (lote > LOTE_TURBO) lote = LOTE_TURBO;
+        int executadas = 0;
+        while (executadas < lote) {
+          executadas += controle_executa_n(self, lote - executadas);
+        }
+      }
+      if (self->modo == controle_lote && controle_maquina_inerte(self)) {
+        console_printf("CPU parada sem interrupção pendente");
+        self->estado = fim;
+      }
+    } else if (self->estado == passo) {
+      controle_executa_n(self, 1);
+      self->estado = parado;
+      // mostra logo o resultado do passo
+      proxima_atualizacao = 0;
+    }
+
+    double agora = controle_tempo_real();
+    if (agora < proxima_atualizacao) {
+      if (self->estado != parado) continue;
+      // parado, não tem nada para fazer até a próxima atualização
+      double espera = proxima_atualizacao - agora;
+      struct timespec ts = { espera, (espera - (int)espera) * 1e9 };
+      nanosleep(&ts, NULL);
+    }
+    proxima_atualizacao = controle_tempo_real() + periodo;
+
+    controle_processa_comandos_da_console(self);
+    if (self->freq_console > 0) {
+      controle_atualiza_estado_na_console(self);
+      console_redesenha(self->console);
+    }
+  } while (self->estado != fim);
+}
+
+// executa uma instrução, avança o relógio e o disco e verifica se eles
+//   pedem interrupção
+static void controle_executa_1(controle_t *self)
+{
+  if (cpu_parada(self->cpu)) self->t_parada++;
+  cpu_executa_1(self->cpu);
+  relogio_tictac(self->relogio);
+  disco_avanca(self->disco, 1);
+  controle_interrompe(self);
+}
+
+// executa até n instruções de uma vez, avança o relógio, o disco e os
+//   terminais pelo número de instruções executadas e verifica se algum
+//   deles pede interrupção
+// a série não passa do momento em que o timer vai expirar, do fim da
+//   transferência em andamento no disco nem do próximo pedido de um
+//   terminal, para que a interrupção aconteça na mesma instrução que
+//   aconteceria executando uma instrução por vez
+// retorna o número de instruções executadas
+static int controle_executa_n(controle_t *self, int n)
+{
+  int timer;
+  relogio_leitura(self->relogio, 2, &timer);
+  int t_disco = disco_tempo_ate_interrupcao(self->disco);
+  int t_terminais = console_tempo_ate_interrupcao(self->console);
+  if (controle_tem_interrupcao(self)) {
+    // interrupção pendente ainda não aceita pela CPU, tenta a cada instrução
+    n = 1;
+  } else {
+    if (timer > 0 && timer < n) n = timer;
+    if (t_disco > 0 && t_disco < n) n = t_disco;
+    if (t_terminais > 0 && t_terminais < n) n = t_terminais;
+  }
+
+  bool parada = cpu_parada(self->cpu);
+  int executadas;
+  cpu_executa_n(self->cpu, n, &executadas);
+  if (parada) self->t_parada += executadas;
+  relogio_avanca(self->relogio, executadas);
+  disco_avanca(self->disco, executadas);
+  console_tictac_terminais(self->console, executadas);
+
+  controle_interrompe(self);
+  return executadas;
+}
+
+// retorna true se algum dispositivo está pedindo interrupção (numa linha
+//   não mascarada do controlador de interrupções)
+static bool controle_tem_interrupcao(controle_t *self)
+{
+  return pic_irq_pendente(self->pic) != -1;
+}
+
+// retorna true se a CPU está parada, sem interrupção pendente, e algum
+//   dispositivo vai pedir interrupção (e acordá-la) num tempo conhecido
+// nesse caso não tem o que executar até lá, e o tempo pode avançar direto
+//   até o primeiro desses eventos
+static bool controle_cpu_ociosa(controle_t *self)
+{
+  if (!cpu_parada(self->cpu) || controle_tem_interrupcao(self)) return false;
+  int timer;
+  relogio_leitura(self->relogio, 2, &timer);
+  return timer > 0 || disco_tempo_ate_interrupcao(self->disco) > 0
+         || console_tempo_ate_interrupcao(self->console) > 0;
+}
+
+// pede à CPU para atender a interrupção pendente de maior prioridade no
+//   controlador de interrupções, se houver; a interrupção que não for
+//   aceita continua pedida, e é tentada de novo após a próxima instrução
+static void controle_interrompe(controle_t *self)
+{
+  int irq = pic_irq_pendente(self->pic);
+  if (irq != -1) {
+    cpu_interrompe(self->cpu, irq);
+  }
+}
+
+// retorna true se a CPU está parada e nem o relógio, nem o disco, nem os
+//   terminais vão gerar interrupção (a única coisa que pode tirar a CPU
+//   desse estado) -- nada mais vai acontecer
+static bool controle_maquina_inerte(controle_t *self)
+{
+  if (!cpu_parada(self->cpu)) return false;
+  int timer;
+  relogio_leitura(self->relogio, 2, &timer);
+  return timer == 0 && disco_tempo_ate_interrupcao(self->disco) == 0
+         && console_tempo_ate_interrupcao(self->console) == 0
+         && !controle_tem_interrupcao(self);
 }
- 
+
+// retorna quantas instruções ainda podem ser executadas antes do limite (um
+//   número grande se não tiver limite)
+static int controle_resta_ate_limite(controle_t *self)
+{
+  if (self->limite == 0) return INT_MAX;
+  int resta = self->limite - relogio_agora(self->relogio);
+  if (resta <= 0) {
+    console_printf("limite de %d instruções atingido", self->limite);
+    return 0;
+  }
+  return resta;
+}
+
+// retorna o tempo real, em segundos, a partir de uma origem arbitrária
+static double controle_tempo_real(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
 
 static void controle_processa_comandos_da_console(controle_t *self)
 {
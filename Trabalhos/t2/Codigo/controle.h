@@ -11,10 +11,39 @@ typedef struct controle_t controle_t;
 #include "cpu.h"
 #include "console.h"
 #include "relogio.h"
+#include "disco.h"
+#include "pic.h"
 
-controle_t *controle_cria(cpu_t *cpu, console_t *console, relogio_t *relogio);
+// modos de funcionamento do laço principal
+typedef enum {
+  // a console é atualizada e os comandos do operador são atendidos após
+  //   cada instrução (é o modo inicial)
+  controle_interativo,
+  // as instruções são executadas em lotes; a console é redesenhada e os
+  //   comandos do operador são atendidos no máximo algumas vezes por segundo
+  //   de tempo real
+  controle_turbo,
+  // como o turbo, mas sem operador: a execução começa sem esperar comando,
+  //   e a simulação termina sozinha quando a CPU estiver parada e nenhuma
+  //   interrupção puder mais acontecer
+  controle_lote,
+} controle_modo_t;
+
+controle_t *controle_cria(cpu_t *cpu, console_t *console, relogio_t *relogio,
+                          disco_t *disco, pic_t *pic);
 void controle_destroi(controle_t *self);
 
+// define o modo de funcionamento do laço principal
+// 'freq_console' é o número de vezes por segundo (tempo real) que a console é
+//   redesenhada nos modos turbo e lote; se for 0, a console não é redesenhada
+//   (os comandos do operador continuam sendo atendidos)
+void controle_define_modo(controle_t *self, controle_modo_t modo, int freq_console);
+
+// limita a simulação a 'instrucoes' instruções (0 para não limitar); a
+//   simulação termina quando o relógio chega nesse valor
+// serve para o modo lote terminar mesmo se o SO nunca deixar a máquina inerte
+void controle_define_limite(controle_t *self, int instrucoes);
+
 // o laço principal da simulação
 void controle_laco(controle_t *self);
 
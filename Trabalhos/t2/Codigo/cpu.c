@@ -7,6 +7,7 @@
 #include "cpu.h"
 #include "err.h"
 #include "instrucao.h"
+#include "rastro.h"
 
 #include <stdbool.h>
 #include <stdlib.h>
@@ -15,6 +16,20 @@
 #include <assert.h>
 
 // DECLARAÇÃO {{{1
+#ifdef CPU_PRE_DECODIFICADO
+// uma instrução pré-decodificada, correspondente a um endereço físico
+typedef struct {
+  // endereço do código que executa a instrução (goto calculado)
+  //   NULL se o conteúdo da memória nesse endereço ainda não foi decodificado
+  void *rotulo;
+  int opcode;
+  // argumento da instrução (se tiver)
+  int A1;
+  // número de palavras ocupadas pela instrução (1 ou 2)
+  int tam;
+} instr_decod_t;
+#endif
+
 // uma CPU tem estado, memória, controlador de ES
 struct cpu_t {
   // registradores
@@ -33,8 +48,17 @@ struct cpu_t {
   // função e argumento para implementar instrução CHAMAC
   func_chamaC_t funcaoC;
   void *argC;
+#ifdef CPU_PRE_DECODIFICADO
+  // memória física, e uma instrução decodificada para cada endereço dela
+  mem_t *mem;
+  instr_decod_t *decod;
+#endif
 };
 
+#ifdef CPU_PRE_DECODIFICADO
+static void cpu_invalida_decodificacao(void *arg, int endereco);
+#endif
+
 // CRIAÇÃO {{{1
 cpu_t *cpu_cria(mmu_t *mmu, es_t *es)
 {
@@ -59,6 +83,14 @@ cpu_t *cpu_cria(mmu_t *mmu, es_t *es)
   self->privilegiadas[ESCR] = true;
   self->privilegiadas[RETI] = true;
   self->privilegiadas[CHAMAC] = true;
+#ifdef CPU_PRE_DECODIFICADO
+  // nenhuma instrução decodificada ainda; a memória avisa quando for alterada,
+  //   para que a decodificação seja descartada
+  self->mem = mmu_mem(mmu);
+  self->decod = calloc(mem_tam(self->mem), sizeof(*self->decod));
+  assert(self->decod != NULL);
+  mem_define_observador(self->mem, cpu_invalida_decodificacao, self);
+#endif
   // gera uma interrupção de reset, para o SO poder executar
   cpu_interrompe(self, IRQ_RESET);
 
@@ -68,6 +100,10 @@ cpu_t *cpu_cria(mmu_t *mmu, es_t *es)
 void cpu_destroi(cpu_t *self)
 {
   // eu nao criei MMU nem es; quem criou que destrua!
+#ifdef CPU_PRE_DECODIFICADO
+  mem_define_observador(self->mem, NULL, NULL);
+  free(self->decod);
+#endif
   free(self);
 }
 
@@ -459,14 +495,312 @@ static void executa_a_instrucao(cpu_t *self, int opcode)
   }
 }
 
-void cpu_executa_1(cpu_t *self)
+// diz se a instrução pode acessar dispositivos ou o SO (essas instruções são
+//   executadas sozinhas por cpu_executa_n)
+static bool interage_com_o_exterior(int opcode)
+{
+  return opcode == LE || opcode == ESCR || opcode == CHAMAC || opcode == CHAMAS;
+}
+
+#ifndef CPU_PRE_DECODIFICADO
+// interpreta até 'n' instruções, com as mesmas condições de parada de
+//   executa_pre_decodificado
+static int interpreta_n(cpu_t *self, int n)
 {
-  // não executa se CPU já estiver em erro
-  if (self->erro != ERR_OK) return;
+  int executadas = 0;
+  while (executadas < n) {
+    int opcode;
+    if (!pega_opcode(self, &opcode)) {
+      executadas++;
+      break;
+    }
+    if (interage_com_o_exterior(opcode)) {
+      if (executadas > 0) break;
+      executa_a_instrucao(self, opcode);
+      executadas++;
+      break;
+    }
+    executa_a_instrucao(self, opcode);
+    executadas++;
+    if (self->erro != ERR_OK) break;
+  }
+  return executadas;
+}
+#endif // CPU_PRE_DECODIFICADO
 
+// executa uma instrução, registrando-a no rastro
+// é o mesmo que interpreta_n com n igual a 1
+static int executa_rastreada(cpu_t *self)
+{
+  int pc = self->PC;
   int opcode;
   if (pega_opcode(self, &opcode)) {
     executa_a_instrucao(self, opcode);
+    rastro_registra(EV_INSTRUCAO, pc, opcode, self->modo);
+  }
+  return 1;
+}
+
+#ifdef CPU_PRE_DECODIFICADO
+// EXECUÇÃO PRÉ-DECODIFICADA {{{1
+
+// Em vez de buscar e decodificar o opcode e o argumento a cada execução, a
+//   instrução é decodificada uma vez, e o resultado (o endereço do código que
+//   a executa e o argumento) é guardado em self->decod, indexado pelo endereço
+//   físico da instrução. O código de cada instrução termina buscando a próxima
+//   e desviando diretamente para o código dela ("threaded code", com o goto
+//   calculado do gcc).
+// A decodificação de um endereço é descartada quando a memória nesse endereço
+//   (ou no seguinte, que pode conter o argumento) é alterada.
+// Casos incomuns (instrução inválida ou privilegiada, erro de tradução,
+//   instrução com argumento na página seguinte) são executados pelo
+//   interpretador, para que os erros sejam exatamente os mesmos.
+
+// chamada pela memória a cada escrita
+static void cpu_invalida_decodificacao(void *arg, int endereco)
+{
+  cpu_t *self = arg;
+  self->decod[endereco].rotulo = NULL;
+  if (endereco > 0) self->decod[endereco - 1].rotulo = NULL;
+}
+
+// decodifica a instrução no endereço físico 'endfis'
+// retorna false se não for uma instrução válida
+static bool decodifica(cpu_t *self, int endfis, void *rotulos[N_OPCODE])
+{
+  instr_decod_t *d = &self->decod[endfis];
+  int opcode, A1 = 0;
+  if (mem_le(self->mem, endfis, &opcode) != ERR_OK) return false;
+  if (opcode < 0 || opcode >= N_OPCODE || rotulos[opcode] == NULL) return false;
+  int tam = 1 + instrucao_num_args(opcode);
+  if (tam > 1 && mem_le(self->mem, endfis + 1, &A1) != ERR_OK) return false;
+  d->opcode = opcode;
+  d->A1 = A1;
+  d->tam = tam;
+  d->rotulo = rotulos[opcode];
+  return true;
+}
+
+// executa até 'n' instruções, parando antes se a CPU entrar em erro (a
+//   interrupção correspondente ao erro não é gerada aqui)
+// as instruções que interagem com o exterior terminam a série, e só são
+//   executadas se forem as primeiras dela
+// retorna o número de instruções executadas
+static int executa_pre_decodificado(cpu_t *self, int n)
+{
+  static void *rotulos[N_OPCODE] = {
+    [NOP]    = &&l_NOP,    [PARA]   = &&l_PARA,   [CARGI]  = &&l_CARGI,
+    [CARGM]  = &&l_CARGM,  [CARGX]  = &&l_CARGX,  [ARMM]   = &&l_ARMM,
+    [ARMX]   = &&l_ARMX,   [TRAX]   = &&l_TRAX,   [CPXA]   = &&l_CPXA,
+    [INCX]   = &&l_INCX,   [SOMA]   = &&l_SOMA,   [SUB]    = &&l_SUB,
+    [MULT]   = &&l_MULT,   [DIV]    = &&l_DIV,    [RESTO]  = &&l_RESTO,
+    [NEG]    = &&l_NEG,    [DESV]   = &&l_DESV,   [DESVZ]  = &&l_DESVZ,
+    [DESVNZ] = &&l_DESVNZ, [DESVN]  = &&l_DESVN,  [DESVP]  = &&l_DESVP,
+    [CHAMA]  = &&l_CHAMA,  [RET]    = &&l_RET,    [LE]     = &&l_LE,
+    [ESCR]   = &&l_ESCR,   [CHAMAS] = &&l_CHAMAS, [RETI]   = &&l_RETI,
+    [CHAMAC] = &&l_CHAMAC,
+  };
+  int executadas = 0;
+  instr_decod_t *d;
+  int endfis, resto, val;
+
+  // busca a instrução no PC; desvia para 'lento' se ela deve ser interpretada
+#define BUSCA \
+  if (mmu_traduz(self->mmu, self->PC, &endfis, &resto, self->modo) != ERR_OK) \
+    goto lento; \
+  d = &self->decod[endfis]; \
+  if (d->rotulo == NULL && !decodifica(self, endfis, rotulos)) goto lento; \
+  if (d->tam > resto) goto lento; \
+  if (self->modo == usuario && self->privilegiadas[d->opcode]) goto lento
+
+  // termina a instrução atual e desvia para a próxima
+#define PROXIMA \
+  executadas++; \
+  if (self->erro != ERR_OK || executadas >= n) goto fim; \
+  BUSCA; \
+  goto *d->rotulo
+
+  // termina a instrução atual e a série
+#define SOZINHA \
+  executadas++; \
+  goto fim
+
+  BUSCA;
+  goto *d->rotulo;
+
+lento:
+  if (!pega_opcode(self, &val)) {
+    executadas++;
+    goto fim;
+  }
+  if (interage_com_o_exterior(val)) {
+    if (executadas > 0) goto fim;
+    executa_a_instrucao(self, val);
+    executadas++;
+    goto fim;
+  }
+  executa_a_instrucao(self, val);
+  PROXIMA;
+
+l_NOP:
+  self->PC += 1;
+  PROXIMA;
+l_PARA:
+  self->erro = ERR_CPU_PARADA;
+  PROXIMA;
+l_CARGI:
+  self->A = d->A1;
+  self->PC += 2;
+  PROXIMA;
+l_CARGM:
+  if (pega_mem(self, d->A1, &val)) {
+    self->A = val;
+    self->PC += 2;
+  }
+  PROXIMA;
+l_CARGX:
+  if (pega_mem(self, d->A1 + self->X, &val)) {
+    self->A = val;
+    self->PC += 2;
+  }
+  PROXIMA;
+l_ARMM:
+  if (poe_mem(self, d->A1, self->A)) {
+    self->PC += 2;
+  }
+  PROXIMA;
+l_ARMX:
+  if (poe_mem(self, d->A1 + self->X, self->A)) {
+    self->PC += 2;
+  }
+  PROXIMA;
+l_TRAX:
+  val = self->A;
+  self->A = self->X;
+  self->X = val;
+  self->PC += 1;
+  PROXIMA;
+l_CPXA:
+  self->A = self->X;
+  self->PC += 1;
+  PROXIMA;
+l_INCX:
+  self->X += 1;
+  self->PC += 1;
+  PROXIMA;
+l_SOMA:
+  if (pega_mem(self, d->A1, &val)) {
+    self->A += val;
+    self->PC += 2;
+  }
+  PROXIMA;
+l_SUB:
+  if (pega_mem(self, d->A1, &val)) {
+    self->A -= val;
+    self->PC += 2;
+  }
+  PROXIMA;
+l_MULT:
+  if (pega_mem(self, d->A1, &val)) {
+    self->A *= val;
+    self->PC += 2;
+  }
+  PROXIMA;
+l_DIV:
+  if (pega_mem(self, d->A1, &val)) {
+    self->A /= val;
+    self->PC += 2;
+  }
+  PROXIMA;
+l_RESTO:
+  if (pega_mem(self, d->A1, &val)) {
+    self->A %= val;
+    self->PC += 2;
+  }
+  PROXIMA;
+l_NEG:
+  self->A = -self->A;
+  self->PC += 1;
+  PROXIMA;
+l_DESV:
+  self->PC = d->A1;
+  PROXIMA;
+l_DESVZ:
+  self->PC = (self->A == 0) ? d->A1 : self->PC + 2;
+  PROXIMA;
+l_DESVNZ:
+  self->PC = (self->A != 0) ? d->A1 : self->PC + 2;
+  PROXIMA;
+l_DESVN:
+  self->PC = (self->A < 0) ? d->A1 : self->PC + 2;
+  PROXIMA;
+l_DESVP:
+  self->PC = (self->A > 0) ? d->A1 : self->PC + 2;
+  PROXIMA;
+l_CHAMA:
+  if (poe_mem(self, d->A1, self->PC + 2)) {
+    self->PC = d->A1 + 1;
+  }
+  PROXIMA;
+l_RET:
+  if (pega_mem(self, d->A1, &val)) {
+    self->PC = val;
+  }
+  PROXIMA;
+  // as instruções abaixo são raras e complicadas, usa a implementação normal
+l_RETI:
+  op_RETI(self);
+  PROXIMA;
+  // essas interagem com o exterior, são executadas sozinhas
+l_LE:
+  if (executadas > 0) goto fim;
+  op_LE(self);
+  SOZINHA;
+l_ESCR:
+  if (executadas > 0) goto fim;
+  op_ESCR(self);
+  SOZINHA;
+l_CHAMAS:
+  if (executadas > 0) goto fim;
+  op_CHAMAS(self);
+  SOZINHA;
+l_CHAMAC:
+  if (executadas > 0) goto fim;
+  op_CHAMAC(self);
+  SOZINHA;
+
+fim:
+  return executadas;
+#undef BUSCA
+#undef PROXIMA
+#undef SOZINHA
+}
+#endif // CPU_PRE_DECODIFICADO
+
+void cpu_executa_1(cpu_t *self)
+{
+  int executadas;
+  cpu_executa_n(self, 1, &executadas);
+}
+
+void cpu_executa_n(cpu_t *self, int n, int *pexecutadas)
+{
+  // não executa se CPU já estiver em erro, mas o tempo passa
+  if (self->erro != ERR_OK) {
+    *pexecutadas = n;
+    return;
+  }
+
+  // com o rastro de instruções, executa uma por vez (para o instante de cada
+  //   uma ser o certo)
+  if (rastro_ativo(RASTRO_INSTRUCAO)) {
+    *pexecutadas = executa_rastreada(self);
+  } else {
+#ifdef CPU_PRE_DECODIFICADO
+    *pexecutadas = executa_pre_decodificado(self, n);
+#else
+    *pexecutadas = interpreta_n(self, n);
+#endif
   }
 
   // se a CPU entrou em erro, causa uma interrupção
@@ -480,6 +814,11 @@ void cpu_executa_1(cpu_t *self)
   }
 }
 
+bool cpu_parada(cpu_t *self)
+{
+  return self->erro == ERR_CPU_PARADA;
+}
+
 // INTERRUPÇÃO {{{1
 
 bool cpu_interrompe(cpu_t *self, irq_t irq)
@@ -494,15 +833,16 @@ bool cpu_interrompe(cpu_t *self, irq_t irq)
   self->modo = supervisor;
 
   // esta é uma CPU boazinha, salva todo o estado interno da CPU no início da memória
-  // self->erro é alterado por poe_mem, copia antes!
-  int erro = self->erro;
-  int complemento = self->complemento;
-  poe_mem(self, IRQ_END_PC,          self->PC);
-  poe_mem(self, IRQ_END_A,           self->A);
-  poe_mem(self, IRQ_END_X,           self->X);
-  poe_mem(self, IRQ_END_erro,        erro);
-  poe_mem(self, IRQ_END_complemento, complemento);
-  poe_mem(self, IRQ_END_modo,        usuario);
+  // os endereços IRQ_END_* são consecutivos, o estado é salvo de uma vez
+  int estado[IRQ_TAM_ESTADO];
+  estado[IRQ_END_PC]          = self->PC;
+  estado[IRQ_END_A]           = self->A;
+  estado[IRQ_END_X]           = self->X;
+  estado[IRQ_END_erro]        = self->erro;
+  estado[IRQ_END_complemento] = self->complemento;
+  estado[IRQ_END_modo]        = usuario;
+  mmu_escreve_bloco(self->mmu, IRQ_END_PC, estado, IRQ_TAM_ESTADO, self->modo,
+                    NULL);
 
   // altera o estado da CPU para ela poder executar o tratador de interrupção
   // vai iniciar o tratamento da interrupção no endereço IRQ_END_TRATADOR,
@@ -513,6 +853,7 @@ bool cpu_interrompe(cpu_t *self, irq_t irq)
   self->A = irq;
   self->erro = ERR_OK;
 
+  RASTRO(RASTRO_IRQ, EV_IRQ_ENTRA, irq, estado[IRQ_END_PC], 0);
   return true;
 }
 
@@ -524,17 +865,16 @@ static void cpu_desinterrompe(cpu_t *self)
   
   // tem que estar em modo supervisor para ler nesses endereços
   self->modo = supervisor;
-  pega_mem(self, IRQ_END_PC,          &self->PC);
-  pega_mem(self, IRQ_END_A,           &self->A);
-  pega_mem(self, IRQ_END_X,           &self->X);
-  // não dá para pegar o erro nem o modo diretamente porque eles não são int
-  int erro, modo;
-  pega_mem(self, IRQ_END_erro,        &erro);
-  pega_mem(self, IRQ_END_complemento, &self->complemento);
-  pega_mem(self, IRQ_END_modo,        &modo);
-  self->modo = modo;
-  // coloca o erro por último, porque pode ser alterado por pega_mem
-  self->erro = erro;
+  int estado[IRQ_TAM_ESTADO];
+  mmu_le_bloco(self->mmu, IRQ_END_PC, estado, IRQ_TAM_ESTADO, self->modo,
+               NULL);
+  self->PC          = estado[IRQ_END_PC];
+  self->A           = estado[IRQ_END_A];
+  self->X           = estado[IRQ_END_X];
+  self->complemento = estado[IRQ_END_complemento];
+  self->modo        = estado[IRQ_END_modo];
+  self->erro        = estado[IRQ_END_erro];
+  RASTRO(RASTRO_IRQ, EV_IRQ_SAI, self->PC, self->modo, 0);
 }
 
 // vim: foldmethod=marker
@@ -33,6 +33,20 @@ void cpu_destroi(cpu_t *self);
 //     e causa uma interrupção
 void cpu_executa_1(cpu_t *self);
 
+// executa até n instruções, a partir da apontada pelo PC
+//   para antes de n se a execução causar algum erro (que causa uma
+//     interrupção, como em cpu_executa_1), se a CPU parar (PARA) ou
+//     se for executada uma instrução CHAMAS
+//   as instruções que podem acessar dispositivos ou o SO (LE, ESCR, CHAMAC,
+//     CHAMAS) são sempre executadas sozinhas ou como a primeira da série, para
+//     que o estado dos dispositivos seja o mesmo de uma execução instrução a
+//     instrução
+//   se a CPU estiver em erro (parada), não executa nada, mas considera que o
+//     tempo de n instruções passou
+// coloca em *pexecutadas o número de instruções executadas (o número de
+//   unidades de tempo que devem ser contabilizadas no relógio)
+void cpu_executa_n(cpu_t *self, int n, int *pexecutadas);
+
 // implementa uma interrupção
 // passa para modo supervisor, salva o estado da CPU no início da memória,
 //   altera A para identificar a requisição de interrupção, altera PC para
@@ -44,6 +58,9 @@ bool cpu_interrompe(cpu_t *self, irq_t irq);
 // e o argumento a passar para ela (normalmente, um ponteiro para o SO)
 void cpu_define_chamaC(cpu_t *self, func_chamaC_t func, void *argC);
 
+// retorna true se a CPU está parada (executou PARA), esperando uma interrupção
+bool cpu_parada(cpu_t *self);
+
 // concatena a descrição do estado da CPU no final de str
 void cpu_concatena_descricao(cpu_t *self, char *str);
 
@@ -0,0 +1,249 @@
+// disco.c
+// dispositivo de E/S de memória secundária (disco de troca de páginas)
+// simulador de computador
+// so24b
+
+#include "disco.h"
+
+#include <stdlib.h>
+#include <assert.h>
+
+// um pedido de transferência
+typedef struct {
+  int id;
+  int comando;
+  int bloco;
+  int endereco;
+} pedido_t;
+
+struct disco_t {
+  // memória principal e memória do disco
+  mem_t *mem;
+  mem_t *conteudo;
+  int num_blocos;
+  int tam_bloco;
+  // modelo de latência
+  int t_busca;
+  int t_palavra;
+  // registradores com o bloco e o endereço do próximo pedido
+  int reg_bloco;
+  int reg_endereco;
+  // identificador do último pedido aceito
+  int ultimo_id;
+  // fila circular de pedidos a atender; o primeiro está sendo atendido,
+  //   e termina em 't_ate_fim'
+  pedido_t fila[DISCO_TAM_FILA];
+  int inicio_fila;
+  int num_fila;
+  int t_ate_fim;
+  // fila circular com os identificadores dos pedidos atendidos ainda não
+  //   informados ao SO
+  int atendidos[DISCO_TAM_FILA];
+  int inicio_atendidos;
+  int num_atendidos;
+  // 1 se está pedindo interrupção, 0 se não
+  int interrupcao;
+  // controlador onde a interrupção é pedida (NULL se não pede)
+  pic_t *pic;
+  // para copiar um bloco entre as memórias
+  int *buffer;
+};
+
+disco_t *disco_cria(mem_t *mem, int num_blocos, int tam_bloco,
+                    int t_busca, int t_palavra)
+{
+  disco_t *self;
+  self = malloc(sizeof(disco_t));
+  assert(self != NULL);
+
+  self->mem = mem;
+  self->conteudo = mem_cria(num_blocos * tam_bloco);
+  self->num_blocos = num_blocos;
+  self->tam_bloco = tam_bloco;
+  self->t_busca = t_busca;
+  self->t_palavra = t_palavra;
+  self->reg_bloco = 0;
+  self->reg_endereco = 0;
+  self->ultimo_id = 0;
+  self->inicio_fila = 0;
+  self->num_fila = 0;
+  self->t_ate_fim = 0;
+  self->inicio_atendidos = 0;
+  self->num_atendidos = 0;
+  self->interrupcao = 0;
+  self->pic = NULL;
+  self->buffer = malloc(tam_bloco * sizeof(*self->buffer));
+  assert(self->buffer != NULL);
+
+  return self;
+}
+
+void disco_destroi(disco_t *self)
+{
+  mem_destroi(self->conteudo);
+  free(self->buffer);
+  free(self);
+}
+
+mem_t *disco_mem(disco_t *self)
+{
+  return self->conteudo;
+}
+
+void disco_define_pic(disco_t *self, pic_t *pic)
+{
+  self->pic = pic;
+}
+
+// liga ou desliga o pedido de interrupção, também no controlador
+static void disco_muda_interrupcao(disco_t *self, int interrupcao)
+{
+  self->interrupcao = interrupcao;
+  if (self->pic == NULL) return;
+  if (interrupcao != 0) {
+    pic_pede(self->pic, IRQ_DISCO, 0);
+  } else {
+    pic_retira(self->pic, IRQ_DISCO, 0);
+  }
+}
+
+// tempo para atender um pedido, pelo modelo de latência
+// é pelo menos 1, para que o disco parado seja distinguível
+static int disco_latencia(disco_t *self)
+{
+  int t = self->t_busca + self->t_palavra * self->tam_bloco;
+  return t > 0 ? t : 1;
+}
+
+// realiza a transferência do primeiro pedido da fila, retira ele da fila e
+//   coloca nos atendidos, e inicia o atendimento do próximo
+static void disco_completa_pedido(disco_t *self)
+{
+  pedido_t *pedido = &self->fila[self->inicio_fila];
+  int end_disco = pedido->bloco * self->tam_bloco;
+  // os endereços foram verificados quando o pedido foi aceito
+  if (pedido->comando == DISCO_CMD_LE) {
+    mem_le_bloco(self->conteudo, end_disco, self->buffer, self->tam_bloco);
+    mem_escreve_bloco(self->mem, pedido->endereco, self->buffer,
+                      self->tam_bloco);
+  } else {
+    mem_le_bloco(self->mem, pedido->endereco, self->buffer, self->tam_bloco);
+    mem_escreve_bloco(self->conteudo, end_disco, self->buffer,
+                      self->tam_bloco);
+  }
+  int pos = (self->inicio_atendidos + self->num_atendidos) % DISCO_TAM_FILA;
+  self->atendidos[pos] = pedido->id;
+  self->num_atendidos++;
+  disco_muda_interrupcao(self, 1);
+
+  self->inicio_fila = (self->inicio_fila + 1) % DISCO_TAM_FILA;
+  self->num_fila--;
+  self->t_ate_fim = self->num_fila > 0 ? disco_latencia(self) : 0;
+}
+
+void disco_avanca(disco_t *self, int n)
+{
+  while (n > 0 && self->num_fila > 0) {
+    if (n < self->t_ate_fim) {
+      self->t_ate_fim -= n;
+      return;
+    }
+    n -= self->t_ate_fim;
+    disco_completa_pedido(self);
+  }
+}
+
+int disco_tempo_ate_interrupcao(disco_t *self)
+{
+  return self->t_ate_fim;
+}
+
+// coloca um pedido na fila
+static err_t disco_novo_pedido(disco_t *self, int comando)
+{
+  if (comando != DISCO_CMD_LE && comando != DISCO_CMD_ESCREVE) {
+    return ERR_OP_INV;
+  }
+  if (self->reg_bloco < 0 || self->reg_bloco >= self->num_blocos
+      || self->reg_endereco < 0
+      || self->reg_endereco > mem_tam(self->mem) - self->tam_bloco) {
+    return ERR_OP_INV;
+  }
+  if (self->num_fila + self->num_atendidos >= DISCO_TAM_FILA) {
+    return ERR_OCUP;
+  }
+  int pos = (self->inicio_fila + self->num_fila) % DISCO_TAM_FILA;
+  pedido_t *pedido = &self->fila[pos];
+  pedido->id = ++self->ultimo_id;
+  pedido->comando = comando;
+  pedido->bloco = self->reg_bloco;
+  pedido->endereco = self->reg_endereco;
+  self->num_fila++;
+  // se o disco estava parado, começa a atender agora
+  if (self->num_fila == 1) {
+    self->t_ate_fim = disco_latencia(self);
+  }
+  return ERR_OK;
+}
+
+// retira o pedido atendido mais antigo da fila de atendidos
+static int disco_pega_atendido(disco_t *self)
+{
+  if (self->num_atendidos == 0) return 0;
+  int id = self->atendidos[self->inicio_atendidos];
+  self->inicio_atendidos = (self->inicio_atendidos + 1) % DISCO_TAM_FILA;
+  self->num_atendidos--;
+  return id;
+}
+
+err_t disco_leitura(void *disp, int id, int *pvalor)
+{
+  disco_t *self = disp;
+  err_t err = ERR_OK;
+  switch (id) {
+    case 0:
+      *pvalor = self->reg_bloco;
+      break;
+    case 1:
+      *pvalor = self->reg_endereco;
+      break;
+    case 2:
+      *pvalor = self->ultimo_id;
+      break;
+    case 3:
+      *pvalor = disco_pega_atendido(self);
+      break;
+    case 4:
+      *pvalor = self->interrupcao;
+      break;
+    case 5:
+      *pvalor = self->num_fila + self->num_atendidos;
+      break;
+    default:
+      err = ERR_END_INV;
+  }
+  return err;
+}
+
+err_t disco_escrita(void *disp, int id, int valor)
+{
+  disco_t *self = disp;
+  err_t err = ERR_OK;
+  switch (id) {
+    case 0:
+      self->reg_bloco = valor;
+      break;
+    case 1:
+      self->reg_endereco = valor;
+      break;
+    case 2:
+      err = disco_novo_pedido(self, valor);
+      break;
+    case 4:
+      disco_muda_interrupcao(self, (valor == 0) ? 0 : 1);
+      break;
+    default:
+      err = ERR_END_INV;
+  }
+  return err;
+}
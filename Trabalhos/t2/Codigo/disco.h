@@ -0,0 +1,85 @@
+// disco.h
+// dispositivo de E/S de memória secundária (disco de troca de páginas)
+// simulador de computador
+// so24b
+
+#ifndef DISCO_H
+#define DISCO_H
+
+// simulador do disco usado como memória secundária
+// o disco tem uma memória própria, dividida em blocos do tamanho de uma
+//   página, e transfere blocos inteiros entre ela e os quadros da memória
+//   principal (sem passar pela CPU)
+// o SO pede as transferências pelos registradores do dispositivo; os pedidos
+//   são colocados em uma fila e atendidos um de cada vez, na ordem em que
+//   foram feitos
+// o tempo de cada transferência segue um modelo de latência configurável:
+//   um tempo fixo de busca mais um tempo por palavra transferida
+// quando uma transferência termina, o disco pede uma interrupção, e o SO
+//   descobre quais pedidos terminaram lendo um registrador -- com isso, o SO
+//   pode executar outros processos enquanto as páginas são transferidas
+
+#include "err.h"
+#include "memoria.h"
+#include "pic.h"
+
+typedef struct disco_t disco_t;
+
+// número máximo de pedidos no disco (esperando, sendo atendido ou atendido
+//   mas ainda não informado ao SO)
+#define DISCO_TAM_FILA 32
+
+// comandos aceitos pelo registrador de comando (id 2)
+#define DISCO_CMD_LE      1  // copia o bloco do disco para a memória principal
+#define DISCO_CMD_ESCREVE 2  // copia da memória principal para o bloco do disco
+
+// cria e inicializa um disco com 'num_blocos' blocos de 'tam_bloco' palavras,
+//   que transfere dados de e para a memória principal 'mem'
+// cada transferência demora 't_busca' + 't_palavra' * 'tam_bloco' unidades
+//   de tempo
+// mata o programa em caso de erro (malloc)
+disco_t *disco_cria(mem_t *mem, int num_blocos, int tam_bloco,
+                    int t_busca, int t_palavra);
+
+// destrói um disco
+// nenhuma outra operação pode ser realizada no disco após esta chamada
+void disco_destroi(disco_t *self);
+
+// retorna a memória do disco
+// é usada pelo SO para colocar os programas na memória secundária na
+//   carga, sem passar pela fila (como se fosse feito por um carregador de
+//   programas antes de eles precisarem ser executados)
+mem_t *disco_mem(disco_t *self);
+
+// faz o disco pedir a interrupção de fim de transferência (IRQ_DISCO) ao
+//   controlador 'pic', além de indicá-la no seu registrador '4'
+void disco_define_pic(disco_t *self, pic_t *pic);
+
+// registra a passagem de n unidades de tempo
+// termina as transferências que completarem nesse tempo, e pede interrupção
+//   se alguma terminar
+// esta função é chamada pelo controlador após a execução das instruções
+void disco_avanca(disco_t *self, int n);
+
+// retorna em quanto tempo a transferência em andamento vai terminar, ou 0
+//   se o disco estiver parado
+int disco_tempo_ate_interrupcao(disco_t *self);
+
+// Funções para acessar o disco como dispositivo de E/S, com id:
+//   '0' para ler ou escrever o número do bloco do disco do próximo pedido
+//   '1' para ler ou escrever o endereço na memória principal (o início de um
+//       quadro) do próximo pedido
+//   '2' para escrever um comando (DISCO_CMD_*), que coloca um pedido na fila
+//       com o bloco e o endereço definidos em '0' e '1' -- retorna ERR_OCUP
+//       se a fila estiver cheia ou ERR_OP_INV se o pedido for inválido;
+//       ler fornece o identificador do último pedido aceito (os
+//       identificadores são 1, 2, 3... na ordem dos pedidos)
+//   '3' para ler o identificador do pedido atendido mais antigo ainda não
+//       informado (e esquecer dele), ou 0 se não houver
+//   '4' para ler ou escrever se uma interrupção está sendo pedida
+//   '5' para ler o número de pedidos no disco
+// Devem seguir o protocolo f_leitura_t e f_escrita_t declarados em es.h
+err_t disco_leitura(void *disp, int id, int *pvalor);
+err_t disco_escrita(void *disp, int id, int valor);
+
+#endif // DISCO_H
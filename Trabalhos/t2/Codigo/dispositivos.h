@@ -27,6 +27,20 @@ typedef enum {
   D_RELOGIO_REAL          = 17,
   D_RELOGIO_TIMER         = 18,
   D_RELOGIO_INTERRUPCAO   = 19,
+  D_DISCO_BLOCO           = 20,
+  D_DISCO_ENDERECO        = 21,
+  D_DISCO_COMANDO         = 22,
+  D_DISCO_ATENDIDO        = 23,
+  D_DISCO_INTERRUPCAO     = 24,
+  D_DISCO_NUM_PEDIDOS     = 25,
+  D_PIC_ORIGEM_TECLADO    = 26,
+  D_PIC_ORIGEM_TELA       = 27,
+  D_PIC_PENDENTES         = 28,
+  D_PIC_PROXIMA           = 29,
+  D_PIC_MASCARA           = 30,
+  D_PIC_LINHA             = 31,
+  D_PIC_PRIORIDADE        = 32,
+  D_RELOGIO_ALARME        = 33,
   N_DISPOSITIVOS
 } dispositivo_id_t;
 
@@ -0,0 +1,116 @@
+#!/bin/bash
+# experimentos.sh
+# executa o simulador em lote para várias configurações da memória e junta
+#   as métricas de paginação de todas as execuções em uma tabela
+# simulador de computador
+# so24b
+#
+# uso: ./experimentos.sh [-j execuções_simultâneas] [-n instruções]
+# as configurações são todas as combinações dos valores nas variáveis
+#   MEMORIAS, PAGINAS e POLITICAS (listas separadas por espaço), que podem
+#   ser alteradas no ambiente, por exemplo:
+#     MEMORIAS="10000 5000 2500 1250" PAGINAS="4 16" ./experimentos.sh
+# cada execução é feita em um diretório próprio dentro de experimentos/
+#   (com o log da console e os relatórios completos); a comparação fica em
+#   experimentos/resultados.csv e experimentos/resultados.md
+# uma execução termina quando a máquina fica parada sem nada que a acorde;
+#   o limite de instruções (-n, LIMITE se não informado) só interrompe as
+#   que não terminariam (por exemplo, trocando sempre as mesmas páginas)
+# as execuções interrompidas pelo limite são marcadas na coluna
+#   limite_atingido dos resultados, as métricas delas não são comparáveis
+#   com as das outras
+
+MEMORIAS=${MEMORIAS:-"10000 5000 2500 1250 624 312 224 200"}
+PAGINAS=${PAGINAS:-"16"}
+POLITICAS=${POLITICAS:-"fifo segunda_chance relogio envelhecimento wsclock"}
+LIMITE=200000
+JOBS=$(nproc 2>/dev/null || echo 1)
+DIR=experimentos
+
+while getopts "j:n:" opt; do
+  case $opt in
+    j) JOBS=$OPTARG ;;
+    n) LIMITE=$OPTARG ;;
+    *) echo "uso: $0 [-j execuções_simultâneas] [-n instruções]" >&2; exit 1 ;;
+  esac
+done
+
+if [ ! -x ./main ]; then
+  echo "$0: ./main não encontrado, execute 'make' antes" >&2
+  exit 1
+fi
+
+# executa uma configuração no seu diretório; os programas são ligados, não
+#   copiados
+executa() {
+  local mem=$1 pag=$2 pol=$3
+  local d=$DIR/m${mem}_p${pag}_${pol}
+  rm -rf "$d"
+  mkdir -p "$d"
+  for maq in *.maq; do ln -s "../../$maq" "$d/$maq"; done
+  if ! (cd "$d" && ../../main -l -n "$LIMITE" -m "$mem" -p "$pag" -s "$pol" \
+                   < /dev/null > saida 2>&1); then
+    echo "$0: falhou: memória $mem, página $pag, $pol (ver $d/saida)" >&2
+  fi
+}
+export -f executa
+export DIR LIMITE
+
+# configurações que não deixam quadro para os programas (a memória toda é
+#   reservada) devem ser recusadas pelo simulador, com qualquer política
+for pol in $POLITICAS; do
+  for opcoes in "-m 96" "-p 16384"; do
+    ./main -l -n 1000 $opcoes -s "$pol" < /dev/null > /dev/null 2>&1
+    if [ $? -ne 1 ]; then
+      echo "$0: configuração sem quadros não foi recusada: $opcoes -s $pol" >&2
+    fi
+  done
+done
+
+mkdir -p $DIR
+for mem in $MEMORIAS; do
+  for pag in $PAGINAS; do
+    for pol in $POLITICAS; do
+      echo "$mem $pag $pol"
+    done
+  done
+done > $DIR/configuracoes
+
+xargs -P "$JOBS" -L 1 bash -c 'executa "$@"' _ < $DIR/configuracoes
+
+# junta a linha de total de cada execução, na ordem das configurações
+csv=$DIR/resultados.csv
+md=$DIR/resultados.md
+rm -f $csv
+interrompidas=0
+while read -r mem pag pol; do
+  d=$DIR/m${mem}_p${pag}_${pol}
+  f=$d/metricas_paginacao.csv
+  [ -f "$f" ] || continue
+  [ -f $csv ] || echo "$(head -n 1 "$f"),limite_atingido" > $csv
+  limite=nao
+  if grep -aqs 'limite de .* instruções atingido' "$d/saida" "$d/log_da_console"; then
+    limite=sim
+    interrompidas=$((interrompidas + 1))
+  fi
+  grep ',total,' "$f" | sed "s/\$/,$limite/" >> $csv
+done < $DIR/configuracoes
+
+if [ ! -f $csv ]; then
+  echo "$0: nenhuma execução gerou métricas" >&2
+  exit 1
+fi
+
+{
+  echo "| memória | página | quadros | política | faltas | salvas | evitadas | tempo bloqueado | acertos TLB | falhas TLB | ocupação média | limite atingido |"
+  echo "|--------:|-------:|--------:|----------|-------:|-------:|---------:|----------------:|------------:|-----------:|---------------:|-----------------|"
+  tail -n +2 $csv | awk -F, '{
+    printf "| %s | %s | %s | %s | %s | %s | %s | %s | %s | %s | %s | %s |\n",
+           $1, $2, $3, $4, $6, $8, $9, $10, $11, $12, $13, $15
+  }'
+} > $md
+
+cat $md
+if [ $interrompidas -gt 0 ]; then
+  echo "$0: $interrompidas execuções atingiram o limite de $LIMITE instruções" >&2
+fi
@@ -14,9 +14,11 @@ typedef enum {
   IRQ_SISTEMA,       // chamada de sistema
   // interrupções geradas por dispositivos de E/S
   IRQ_RELOGIO,       // interrupção causada pelo relógio
-  // interrupções de E/S ainda não implementadas
-  IRQ_TECLADO,       // interrupção causada pelo teclado
-  IRQ_TELA,          // interrupção causada pela tela
+  IRQ_DISCO,         // interrupção causada pelo disco (fim de transferência)
+  // interrupções dos terminais, pedidas pelo controlador de interrupções
+  //   (ver pic.h)
+  IRQ_TECLADO,       // chegou entrada em um terminal
+  IRQ_TELA,          // a saída de um terminal ficou pronta
   N_IRQ              // número de interrupções
 } irq_t;
 
@@ -31,6 +33,8 @@ char *irq_nome(irq_t irq);
 #define IRQ_END_erro        3
 #define IRQ_END_complemento 4
 #define IRQ_END_modo        5
+// número de valores do estado salvo (nos endereços IRQ_END_PC em diante)
+#define IRQ_TAM_ESTADO      6
 
 // endereço para onde desviar quando aceita uma interrupção
 #define IRQ_END_TRATADOR   10
@@ -8,17 +8,29 @@
 #include "mmu.h"
 #include "cpu.h"
 #include "relogio.h"
+#include "pic.h"
+#include "disco.h"
 #include "console.h"
 #include "terminal.h"
 #include "es.h"
 #include "dispositivos.h"
 #include "so.h"
+#include "rastro.h"
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
 
 // constantes
 #define MEM_TAM 10000        // tamanho da memória principal
+#define FREQ_CONSOLE 30      // redesenhos da console por segundo no modo turbo
+#define DISCO_TAM 20000      // tamanho da memória secundária (em palavras)
+#define DISCO_T_BUSCA 100    // tempo fixo de cada transferência do disco
+#define DISCO_T_PALAVRA 2    // tempo de transferência de cada palavra
+#define POLITICA_SUBST SUBST_RELOGIO // substituição de páginas do SO
+#define N_TERM 4             // número de terminais (A a D)
+#define INTERVALO_ENTRADA 1  // instruções entre caracteres da entrada de arquivo
 
 // estrutura com os componentes do computador simulado
 typedef struct {
@@ -26,20 +38,64 @@ typedef struct {
   mmu_t *mmu;
   cpu_t *cpu;
   relogio_t *relogio;
+  pic_t *pic;
+  disco_t *disco;
   console_t *console;
   es_t *es;
   controle_t *controle;
 } hardware_t;
 
-static void cria_hardware(hardware_t *hw)
+// configuração da simulação, definida pelos argumentos da linha de comando
+typedef struct {
+  controle_modo_t modo;
+  int freq_console;
+  int limite;
+  int mem_tam;
+  int tam_pagina;
+  int disco_t_busca;
+  int disco_t_palavra;
+  politica_subst_t politica;
+  // arquivos de entrada e saída de cada terminal (NULL para usar a console)
+  FILE *entrada[N_TERM];
+  int intervalo_entrada[N_TERM];
+  FILE *saida[N_TERM];
+  // nível das mensagens da console
+  console_nivel_t nivel;
+  // arquivo e categorias do rastro (NULL se não tem rastro)
+  char *rastro;
+  unsigned categorias_rastro;
+} config_t;
+
+static void cria_hardware(hardware_t *hw, config_t *cfg)
 {
   // cria a memória e a MMU
-  hw->mem = mem_cria(MEM_TAM);
-  hw->mmu = mmu_cria(hw->mem);
+  hw->mem = mem_cria(cfg->mem_tam);
+  hw->mmu = mmu_cria(hw->mem, cfg->tam_pagina);
+
+  // cria o controlador de interrupções
+  hw->pic = pic_cria();
 
   // cria dispositivos de E/S
-  hw->console = console_cria();
+  // no modo lote não tem operador, a console não usa a tela
+  // os terminais pedem interrupção ao controlador, identificados pelo
+  //   número (0 para o A)
+  hw->console = console_cria(cfg->modo != controle_lote);
+  console_define_nivel(cfg->nivel);
+  for (int t = 0; t < N_TERM; t++) {
+    terminal_t *terminal = console_terminal(hw->console, 'A' + t);
+    terminal_define_pic(terminal, hw->pic, t);
+    if (cfg->entrada[t] != NULL) {
+      terminal_define_entrada(terminal, cfg->entrada[t],
+                              cfg->intervalo_entrada[t]);
+    }
+    if (cfg->saida[t] != NULL) terminal_define_saida(terminal, cfg->saida[t]);
+  }
   hw->relogio = relogio_cria();
+  relogio_define_pic(hw->relogio, hw->pic);
+  // o disco transfere páginas inteiras
+  hw->disco = disco_cria(hw->mem, DISCO_TAM / cfg->tam_pagina, cfg->tam_pagina,
+                         cfg->disco_t_busca, cfg->disco_t_palavra);
+  disco_define_pic(hw->disco, hw->pic);
 
   // cria o controlador de E/S e registra os dispositivos
   //   por exemplo, o dispositivo 8 do controlador de E/S (e da CPU) será o
@@ -70,18 +126,40 @@ static void cria_hardware(hardware_t *hw)
   es_registra_dispositivo(hw->es, D_TERM_D_TECLADO_OK , terminal, 1, terminal_leitura, NULL);
   es_registra_dispositivo(hw->es, D_TERM_D_TELA       , terminal, 2, NULL, terminal_escrita);
   es_registra_dispositivo(hw->es, D_TERM_D_TELA_OK    , terminal, 3, terminal_leitura, NULL);
-  // lê relógio virtual, relógio real
+  // lê relógio virtual, relógio real; lê ou programa o timer (pelo tempo até
+  //   a interrupção ou pelo instante dela), o pedido de interrupção
   es_registra_dispositivo(hw->es, D_RELOGIO_INSTRUCOES, hw->relogio, 0, relogio_leitura, NULL);
   es_registra_dispositivo(hw->es, D_RELOGIO_REAL      , hw->relogio, 1, relogio_leitura, NULL);
   es_registra_dispositivo(hw->es, D_RELOGIO_TIMER     , hw->relogio, 2, relogio_leitura, relogio_escrita);
   es_registra_dispositivo(hw->es, D_RELOGIO_INTERRUPCAO,hw->relogio, 3, relogio_leitura, relogio_escrita);
+  es_registra_dispositivo(hw->es, D_RELOGIO_ALARME    , hw->relogio, 4, relogio_leitura, relogio_escrita);
+  // controlador de interrupções: lê (e reconhece) os terminais que pediram
+  //   interrupção de teclado, de tela; lê as linhas pendentes, a próxima a
+  //   atender; lê ou altera a máscara, a linha selecionada e a sua prioridade
+  es_registra_dispositivo(hw->es, D_PIC_ORIGEM_TECLADO, hw->pic, IRQ_TECLADO, pic_leitura, NULL);
+  es_registra_dispositivo(hw->es, D_PIC_ORIGEM_TELA   , hw->pic, IRQ_TELA, pic_leitura, NULL);
+  es_registra_dispositivo(hw->es, D_PIC_PENDENTES     , hw->pic, PIC_PENDENTES, pic_leitura, NULL);
+  es_registra_dispositivo(hw->es, D_PIC_PROXIMA       , hw->pic, PIC_PROXIMA, pic_leitura, NULL);
+  es_registra_dispositivo(hw->es, D_PIC_MASCARA       , hw->pic, PIC_MASCARA, pic_leitura, pic_escrita);
+  es_registra_dispositivo(hw->es, D_PIC_LINHA         , hw->pic, PIC_LINHA, pic_leitura, pic_escrita);
+  es_registra_dispositivo(hw->es, D_PIC_PRIORIDADE    , hw->pic, PIC_PRIORIDADE, pic_leitura, pic_escrita);
+
+  es_registra_dispositivo(hw->es, D_DISCO_BLOCO       , hw->disco, 0, disco_leitura, disco_escrita);
+  es_registra_dispositivo(hw->es, D_DISCO_ENDERECO    , hw->disco, 1, disco_leitura, disco_escrita);
+  es_registra_dispositivo(hw->es, D_DISCO_COMANDO     , hw->disco, 2, disco_leitura, disco_escrita);
+  es_registra_dispositivo(hw->es, D_DISCO_ATENDIDO    , hw->disco, 3, disco_leitura, NULL);
+  es_registra_dispositivo(hw->es, D_DISCO_INTERRUPCAO , hw->disco, 4, disco_leitura, disco_escrita);
+  es_registra_dispositivo(hw->es, D_DISCO_NUM_PEDIDOS , hw->disco, 5, disco_leitura, NULL);
 
   // cria a unidade de execução e inicializa com a MMU e E/S
   hw->cpu = cpu_cria(hw->mmu, hw->es);
 
-  // cria o controlador da CPU e inicializa com a unidade de execução, a console e
-  //   o relógio
-  hw->controle = controle_cria(hw->cpu, hw->console, hw->relogio);
+  // cria o controlador da CPU e inicializa com a unidade de execução, a console,
+  //   o relógio, o disco e o controlador de interrupções
+  hw->controle = controle_cria(hw->cpu, hw->console, hw->relogio,
+                                hw->disco, hw->pic);
+  controle_define_modo(hw->controle, cfg->modo, cfg->freq_console);
+  controle_define_limite(hw->controle, cfg->limite);
 }
 
 static void destroi_hardware(hardware_t *hw)
@@ -89,27 +167,221 @@ static void destroi_hardware(hardware_t *hw)
   controle_destroi(hw->controle);
   cpu_destroi(hw->cpu);
   es_destroi(hw->es);
+  disco_destroi(hw->disco);
   relogio_destroi(hw->relogio);
   console_destroi(hw->console);
+  pic_destroi(hw->pic);
   mmu_destroi(hw->mmu);
   mem_destroi(hw->mem);
 }
 
-int main()
+// interpreta o argumento das opções -E e -S ('t=arquivo', com t de A a D),
+//   abrindo o arquivo com 'modo'; retorna o número do terminal
+// para a entrada, o nome pode terminar com ',intervalo', que é colocado em
+//   '*pintervalo' (se não for NULL)
+static int le_arquivo_terminal(char *arg, char *modo, FILE **parq,
+                               int *pintervalo)
+{
+  int t = toupper(arg[0]) - 'A';
+  if (t < 0 || t >= N_TERM || arg[1] != '=' || arg[2] == '\0') {
+    fprintf(stderr, "ERRO: terminal inválido (deve ser t=arquivo, t de A"
+                    " a D): '%s'\n", arg);
+    exit(1);
+  }
+  char *nome = &arg[2];
+  char *virgula = strrchr(nome, ',');
+  if (pintervalo != NULL && virgula != NULL) {
+    char *fim;
+    int intervalo = strtol(virgula + 1, &fim, 10);
+    if (virgula[1] != '\0' && *fim == '\0' && intervalo >= 0) {
+      *pintervalo = intervalo;
+      *virgula = '\0';
+    }
+  }
+  *parq = fopen(nome, modo);
+  if (*parq == NULL) {
+    fprintf(stderr, "ERRO: não foi possível abrir '%s'\n", nome);
+    exit(1);
+  }
+  return t;
+}
+
+// interpreta os argumentos da linha de comando
+//   -t [freq]  modo turbo, redesenhando a console 'freq' vezes por segundo
+//              (FREQ_CONSOLE se não informado, 0 para não redesenhar)
+//   -l         modo lote, sem tela; a simulação começa executando e termina
+//              quando a CPU parar sem ter interrupção pendente
+//   -n instr   termina a simulação depois de 'instr' instruções (para o modo
+//              lote terminar mesmo que o SO não pare a máquina)
+//   -m tam     tamanho da memória principal (MEM_TAM se não informado)
+//   -p tam     tamanho da página da MMU (potência de 2, TAM_PAGINA se não
+//              informado)
+//   -d busca,palavra
+//              modelo de latência do disco: tempo fixo de cada transferência
+//              e tempo por palavra (DISCO_T_BUSCA,DISCO_T_PALAVRA se não
+//              informado)
+//   -s nome    política de substituição de páginas do SO (fifo,
+//              segunda_chance, relogio, envelhecimento, wsclock)
+//   -E t=arq[,intervalo]
+//              a entrada do terminal t (A a D) vem do arquivo (ou pipe)
+//              'arq', um caractere a cada 'intervalo' instruções
+//              (INTERVALO_ENTRADA se não informado; 0 para o mais rápido
+//              possível)
+//   -S t=arq   a saída do terminal t é copiada para o arquivo 'arq'
+//   -r arq[:categorias]
+//              registra um rastro dos eventos da simulação no arquivo 'arq'
+//              (ver rastro.h), das categorias listadas separadas por vírgula
+//              (instrucao, irq, chamada, processo, memoria; todas menos
+//              instrucao se não informado)
+//   -v nivel   nível das mensagens da console (erro, info, depuracao,
+//              detalhe, ou o número correspondente; info se não informado)
+static void verifica_args(int argc, char *argv[argc], config_t *cfg)
+{
+  for (int t = 0; t < N_TERM; t++) {
+    cfg->entrada[t] = NULL;
+    cfg->intervalo_entrada[t] = INTERVALO_ENTRADA;
+    cfg->saida[t] = NULL;
+  }
+  cfg->nivel = NIVEL_INFO;
+  cfg->rastro = NULL;
+  cfg->categorias_rastro = RASTRO_TODAS & ~RASTRO_INSTRUCAO;
+  cfg->modo = controle_interativo;
+  cfg->freq_console = FREQ_CONSOLE;
+  cfg->limite = 0;
+  cfg->mem_tam = MEM_TAM;
+  cfg->tam_pagina = TAM_PAGINA;
+  cfg->disco_t_busca = DISCO_T_BUSCA;
+  cfg->disco_t_palavra = DISCO_T_PALAVRA;
+  cfg->politica = POLITICA_SUBST;
+  for (int argi = 1; argi < argc; argi++) {
+    if (strcmp(argv[argi], "-t") == 0) {
+      cfg->modo = controle_turbo;
+      if (argi + 1 < argc && argv[argi + 1][0] != '-') {
+        argi++;
+        char *fim;
+        cfg->freq_console = strtol(argv[argi], &fim, 10);
+        if (*fim != '\0' || cfg->freq_console < 0) {
+          fprintf(stderr, "ERRO: frequência inválida: '%s'\n", argv[argi]);
+          exit(1);
+        }
+      }
+    } else if (strcmp(argv[argi], "-l") == 0) {
+      cfg->modo = controle_lote;
+      cfg->freq_console = 0;
+    } else if (strcmp(argv[argi], "-n") == 0 && argi + 1 < argc) {
+      argi++;
+      char *fim;
+      cfg->limite = strtol(argv[argi], &fim, 10);
+      if (*fim != '\0' || cfg->limite <= 0) {
+        fprintf(stderr, "ERRO: número de instruções inválido: '%s'\n",
+                argv[argi]);
+        exit(1);
+      }
+    } else if (strcmp(argv[argi], "-m") == 0 && argi + 1 < argc) {
+      argi++;
+      char *fim;
+      cfg->mem_tam = strtol(argv[argi], &fim, 10);
+      if (*fim != '\0' || cfg->mem_tam <= 0) {
+        fprintf(stderr, "ERRO: tamanho de memória inválido: '%s'\n",
+                argv[argi]);
+        exit(1);
+      }
+    } else if (strcmp(argv[argi], "-p") == 0 && argi + 1 < argc) {
+      argi++;
+      char *fim;
+      cfg->tam_pagina = strtol(argv[argi], &fim, 10);
+      if (*fim != '\0' || !mmu_tam_pagina_valido(cfg->tam_pagina)) {
+        fprintf(stderr, "ERRO: tamanho de página inválido (deve ser potência"
+                        " de 2): '%s'\n", argv[argi]);
+        exit(1);
+      }
+    } else if (strcmp(argv[argi], "-d") == 0 && argi + 1 < argc) {
+      argi++;
+      if (sscanf(argv[argi], "%d,%d", &cfg->disco_t_busca,
+                 &cfg->disco_t_palavra) != 2
+          || cfg->disco_t_busca < 0 || cfg->disco_t_palavra < 0) {
+        fprintf(stderr, "ERRO: latência do disco inválida (deve ser"
+                        " busca,palavra): '%s'\n", argv[argi]);
+        exit(1);
+      }
+    } else if (strcmp(argv[argi], "-s") == 0 && argi + 1 < argc) {
+      argi++;
+      if (!quadros_politica_por_nome(argv[argi], &cfg->politica)) {
+        fprintf(stderr, "ERRO: política de substituição desconhecida: '%s'\n",
+                argv[argi]);
+        exit(1);
+      }
+    } else if (strcmp(argv[argi], "-E") == 0 && argi + 1 < argc) {
+      FILE *arq;
+      int intervalo = INTERVALO_ENTRADA;
+      int t = le_arquivo_terminal(argv[++argi], "r", &arq, &intervalo);
+      if (cfg->entrada[t] != NULL) fclose(cfg->entrada[t]);
+      cfg->entrada[t] = arq;
+      cfg->intervalo_entrada[t] = intervalo;
+    } else if (strcmp(argv[argi], "-S") == 0 && argi + 1 < argc) {
+      FILE *arq;
+      int t = le_arquivo_terminal(argv[++argi], "w", &arq, NULL);
+      if (cfg->saida[t] != NULL) fclose(cfg->saida[t]);
+      cfg->saida[t] = arq;
+    } else if (strcmp(argv[argi], "-v") == 0 && argi + 1 < argc) {
+      argi++;
+      if (!console_nivel_por_nome(argv[argi], &cfg->nivel)) {
+        fprintf(stderr, "ERRO: nível de mensagem desconhecido: '%s'\n",
+                argv[argi]);
+        exit(1);
+      }
+    } else if (strcmp(argv[argi], "-r") == 0 && argi + 1 < argc) {
+      cfg->rastro = argv[++argi];
+      char *dois_pontos = strrchr(cfg->rastro, ':');
+      if (dois_pontos != NULL) {
+        *dois_pontos = '\0';
+        if (!rastro_categorias_por_nome(dois_pontos + 1,
+                                        &cfg->categorias_rastro)) {
+          fprintf(stderr, "ERRO: categoria de rastro desconhecida: '%s'\n",
+                  dois_pontos + 1);
+          exit(1);
+        }
+      }
+    } else {
+      fprintf(stderr, "ERRO: chame como '%s [-t [freq]] [-l] [-n instr]"
+                      " [-m tam] [-p tam] [-d busca,palavra] [-s politica]"
+                      " [-E t=arq[,intervalo]] [-S t=arq]"
+                      " [-r arq[:categorias]] [-v nivel]'\n", argv[0]);
+      exit(1);
+    }
+  }
+  if (so_quadros_usuario(cfg->mem_tam, cfg->tam_pagina) < 1) {
+    fprintf(stderr, "ERRO: memória de %d com páginas de %d não deixa quadro"
+                    " para os programas (os endereços até 99 são do SO)\n",
+            cfg->mem_tam, cfg->tam_pagina);
+    exit(1);
+  }
+}
+
+int main(int argc, char *argv[argc])
 {
   hardware_t hw;
+  config_t cfg;
   so_t *so;
 
+  verifica_args(argc, argv, &cfg);
+
   // cria o hardware
-  cria_hardware(&hw);
+  cria_hardware(&hw, &cfg);
+  if (cfg.rastro != NULL
+      && !rastro_inicia(cfg.rastro, cfg.categorias_rastro, hw.relogio)) {
+    console_printf("não foi possível criar o rastro '%s'", cfg.rastro);
+  }
   // cria o sistema operacional
-  so = so_cria(hw.cpu, hw.mem, hw.mmu, hw.es, hw.console);
+  so = so_cria(hw.cpu, hw.mem, hw.mmu, disco_mem(hw.disco), hw.es,
+               hw.console, cfg.politica);
   
   // executa o laço principal do controlador
   controle_laco(hw.controle);
 
   // destroi tudo
   so_destroi(so);
+  rastro_termina();
   destroi_hardware(&hw);
 }
 
@@ -6,12 +6,16 @@
 #include "memoria.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
 // tipo de dados para representar uma região de memória
 struct mem_t {
   int tam;
   int *conteudo;
+  // função chamada após cada escrita, e seu argumento
+  mem_f_observador_t observador;
+  void *arg_observador;
 };
 
 mem_t *mem_cria(int tam)
@@ -24,6 +28,7 @@ mem_t *mem_cria(int tam)
   assert(self->conteudo != NULL);
 
   self->tam = tam;
+  self->observador = NULL;
 
   return self;
 }
@@ -66,6 +71,48 @@ err_t mem_escreve(mem_t *self, int endereco, int valor)
   err_t err = verifica_permissao(self, endereco);
   if (err == ERR_OK) {
     self->conteudo[endereco] = valor;
+    if (self->observador != NULL) {
+      self->observador(self->arg_observador, endereco);
+    }
   }
   return err;
 }
+
+// função auxiliar, verifica se os 'n' endereços a partir de 'endereco'
+//   são válidos
+static err_t verifica_permissao_bloco(mem_t *self, int endereco, int n)
+{
+  if (n < 0 || endereco < 0 || endereco > self->tam - n) {
+    return ERR_END_INV;
+  }
+  return ERR_OK;
+}
+
+err_t mem_le_bloco(mem_t *self, int endereco, int *valores, int n)
+{
+  err_t err = verifica_permissao_bloco(self, endereco, n);
+  if (err == ERR_OK) {
+    memcpy(valores, &self->conteudo[endereco], n * sizeof(*valores));
+  }
+  return err;
+}
+
+err_t mem_escreve_bloco(mem_t *self, int endereco, const int *valores, int n)
+{
+  err_t err = verifica_permissao_bloco(self, endereco, n);
+  if (err == ERR_OK) {
+    memcpy(&self->conteudo[endereco], valores, n * sizeof(*valores));
+    if (self->observador != NULL) {
+      for (int i = 0; i < n; i++) {
+        self->observador(self->arg_observador, endereco + i);
+      }
+    }
+  }
+  return err;
+}
+
+void mem_define_observador(mem_t *self, mem_f_observador_t func, void *arg)
+{
+  self->observador = func;
+  self->arg_observador = arg;
+}
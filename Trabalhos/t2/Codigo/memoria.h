@@ -31,4 +31,24 @@ err_t mem_le(mem_t *self, int endereco, int *pvalor);
 // retorna erro ERR_END_INV se endereço inválido
 err_t mem_escreve(mem_t *self, int endereco, int valor);
 
+// copia para 'valores' os 'n' valores da memória a partir do endereço
+//   'endereco'
+// retorna erro ERR_END_INV (e não altera 'valores') se algum endereço da
+//   faixa for inválido
+err_t mem_le_bloco(mem_t *self, int endereco, int *valores, int n);
+
+// copia os 'n' valores de 'valores' para a memória, a partir do endereço
+//   'endereco'
+// retorna erro ERR_END_INV (e não altera a memória) se algum endereço da
+//   faixa for inválido
+err_t mem_escreve_bloco(mem_t *self, int endereco, const int *valores, int n);
+
+// tipo da função chamada a cada escrita bem sucedida na memória
+typedef void (*mem_f_observador_t)(void *arg, int endereco);
+
+// define uma função a ser chamada (com o argumento 'arg' e o endereço escrito)
+//   após cada escrita bem sucedida na memória, ou NULL para nenhuma
+// é usada pela CPU para invalidar instruções pré-decodificadas
+void mem_define_observador(mem_t *self, mem_f_observador_t func, void *arg);
+
 #endif // MEMORIA_H
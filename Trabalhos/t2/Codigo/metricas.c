@@ -0,0 +1,337 @@
+// metricas.c
+// métricas de paginação do SO
+// simulador de computador
+// so24b
+
+#include "metricas.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+// medidas de um processo
+typedef struct {
+  bool usado;
+  int faltas;
+  int trazidas;          // páginas trazidas da memória secundária
+  int salvas;            // páginas alteradas copiadas para a memória secundária
+  int copias_evitadas;   // páginas retiradas sem precisar de cópia
+  long tempo_bloqueado;  // tempo esperando páginas
+} metricas_proc_t;
+
+// um ponto da série de ocupação dos quadros
+typedef struct {
+  int tempo;
+  int ocupados;
+} ponto_ocupacao_t;
+
+struct metricas_t {
+  // configuração
+  int tam_mem;
+  int tam_pagina;
+  int num_quadros;
+  char *politica;
+  // medidas por processo, indexadas pelo número do processo
+  metricas_proc_t *procs;
+  int num_procs;
+  // TLB
+  long tlb_acertos;
+  long tlb_falhas;
+  // série da ocupação, com um ponto a cada mudança
+  ponto_ocupacao_t *ocupacao;
+  int num_ocupacao;
+  int cap_ocupacao;
+};
+
+metricas_t *metricas_cria(void)
+{
+  metricas_t *self = malloc(sizeof(*self));
+  assert(self != NULL);
+  self->tam_mem = 0;
+  self->tam_pagina = 0;
+  self->num_quadros = 0;
+  self->politica = strdup("");
+  self->procs = NULL;
+  self->num_procs = 0;
+  self->tlb_acertos = 0;
+  self->tlb_falhas = 0;
+  self->ocupacao = NULL;
+  self->num_ocupacao = 0;
+  self->cap_ocupacao = 0;
+  return self;
+}
+
+void metricas_destroi(metricas_t *self)
+{
+  free(self->politica);
+  free(self->procs);
+  free(self->ocupacao);
+  free(self);
+}
+
+void metricas_define_config(metricas_t *self, int tam_mem, int tam_pagina,
+                            int num_quadros, char *politica)
+{
+  self->tam_mem = tam_mem;
+  self->tam_pagina = tam_pagina;
+  self->num_quadros = num_quadros;
+  free(self->politica);
+  self->politica = strdup(politica);
+  assert(self->politica != NULL);
+}
+
+// REGISTRO {{{1
+
+// retorna as medidas do processo, aumentando o vetor se necessário
+static metricas_proc_t *metricas__proc(metricas_t *self, int processo)
+{
+  assert(processo >= 0);
+  if (processo >= self->num_procs) {
+    int novo_num = processo + 1;
+    self->procs = realloc(self->procs, novo_num * sizeof(*self->procs));
+    assert(self->procs != NULL);
+    memset(&self->procs[self->num_procs], 0,
+           (novo_num - self->num_procs) * sizeof(*self->procs));
+    self->num_procs = novo_num;
+  }
+  metricas_proc_t *m = &self->procs[processo];
+  m->usado = true;
+  return m;
+}
+
+void metricas_falta_de_pagina(metricas_t *self, int processo)
+{
+  metricas__proc(self, processo)->faltas++;
+}
+
+void metricas_pagina_trazida(metricas_t *self, int processo, int tempo)
+{
+  metricas_proc_t *m = metricas__proc(self, processo);
+  m->trazidas++;
+  m->tempo_bloqueado += tempo;
+}
+
+void metricas_pagina_retirada(metricas_t *self, int processo, bool alterada)
+{
+  metricas_proc_t *m = metricas__proc(self, processo);
+  if (alterada) {
+    m->salvas++;
+  } else {
+    m->copias_evitadas++;
+  }
+}
+
+void metricas_ocupacao(metricas_t *self, int agora, int ocupados)
+{
+  // várias mudanças no mesmo instante ficam só com a última
+  if (self->num_ocupacao > 0
+      && self->ocupacao[self->num_ocupacao - 1].tempo == agora) {
+    self->ocupacao[self->num_ocupacao - 1].ocupados = ocupados;
+    return;
+  }
+  if (self->num_ocupacao == self->cap_ocupacao) {
+    self->cap_ocupacao = self->cap_ocupacao == 0 ? 64 : 2 * self->cap_ocupacao;
+    self->ocupacao = realloc(self->ocupacao,
+                             self->cap_ocupacao * sizeof(*self->ocupacao));
+    assert(self->ocupacao != NULL);
+  }
+  self->ocupacao[self->num_ocupacao++] = (ponto_ocupacao_t){ agora, ocupados };
+}
+
+void metricas_tlb(metricas_t *self, long acertos, long falhas)
+{
+  self->tlb_acertos = acertos;
+  self->tlb_falhas = falhas;
+}
+
+// RELATÓRIOS {{{1
+
+// soma as medidas de todos os processos
+static metricas_proc_t metricas__total(metricas_t *self)
+{
+  metricas_proc_t t = { .usado = true };
+  for (int i = 0; i < self->num_procs; i++) {
+    metricas_proc_t *m = &self->procs[i];
+    t.faltas += m->faltas;
+    t.trazidas += m->trazidas;
+    t.salvas += m->salvas;
+    t.copias_evitadas += m->copias_evitadas;
+    t.tempo_bloqueado += m->tempo_bloqueado;
+  }
+  return t;
+}
+
+// calcula a ocupação média (ponderada pelo tempo) e máxima até 'agora'
+static void metricas__resumo_ocupacao(metricas_t *self, int agora,
+                                      double *pmedia, int *pmaximo)
+{
+  double soma = 0;
+  int maximo = 0;
+  for (int i = 0; i < self->num_ocupacao; i++) {
+    ponto_ocupacao_t *p = &self->ocupacao[i];
+    int fim = (i + 1 < self->num_ocupacao) ? self->ocupacao[i + 1].tempo : agora;
+    soma += (double)p->ocupados * (fim - p->tempo);
+    if (p->ocupados > maximo) maximo = p->ocupados;
+  }
+  int inicio = self->num_ocupacao > 0 ? self->ocupacao[0].tempo : agora;
+  *pmedia = agora > inicio ? soma / (agora - inicio) : 0;
+  *pmaximo = maximo;
+}
+
+static double metricas__taxa_tlb(metricas_t *self)
+{
+  long total = self->tlb_acertos + self->tlb_falhas;
+  return total > 0 ? (double)self->tlb_acertos / total : 0;
+}
+
+static void metricas__grava_linha_tabela(FILE *arq, char *nome,
+                                         metricas_proc_t *m)
+{
+  fprintf(arq, "| %-9s | %-7d | %-8d | %-7d | %-8d | %-15ld |\n", nome,
+          m->faltas, m->trazidas, m->salvas, m->copias_evitadas,
+          m->tempo_bloqueado);
+}
+
+static void metricas__grava_tabela(metricas_t *self, FILE *arq, int agora)
+{
+  double media;
+  int maximo;
+  metricas__resumo_ocupacao(self, agora, &media, &maximo);
+  fprintf(arq, "MÉTRICAS DE PAGINAÇÃO\n");
+  fprintf(arq, "| MÉTRICA                        | VALOR        |\n");
+  fprintf(arq, "|--------------------------------|--------------|\n");
+  fprintf(arq, "| TAMANHO DA MEMÓRIA             | %-12d |\n", self->tam_mem);
+  fprintf(arq, "| TAMANHO DA PÁGINA              | %-12d |\n",
+          self->tam_pagina);
+  fprintf(arq, "| NÚMERO DE QUADROS              | %-12d |\n",
+          self->num_quadros);
+  fprintf(arq, "| POLÍTICA DE SUBSTITUIÇÃO       | %-12s |\n", self->politica);
+  fprintf(arq, "| TEMPO DE MEDIÇÃO               | %-12d |\n", agora);
+  fprintf(arq, "| ACERTOS NA TLB                 | %-12ld |\n",
+          self->tlb_acertos);
+  fprintf(arq, "| FALHAS NA TLB                  | %-12ld |\n",
+          self->tlb_falhas);
+  fprintf(arq, "| TAXA DE ACERTOS NA TLB         | %-12.4f |\n",
+          metricas__taxa_tlb(self));
+  fprintf(arq, "| OCUPAÇÃO MÉDIA DOS QUADROS     | %-12.2f |\n", media);
+  fprintf(arq, "| OCUPAÇÃO MÁXIMA DOS QUADROS    | %-12d |\n", maximo);
+
+  fprintf(arq, "\nPAGINAÇÃO POR PROCESSO\n");
+  fprintf(arq, "| %-9s | %-7s | %-8s | %-7s | %-8s | %-15s |\n", "PROCESSO",
+          "FALTAS", "TRAZIDAS", "SALVAS", "EVITADAS", "TEMPO BLOQUEADO");
+  fprintf(arq, "|-----------|---------|----------|---------|----------|"
+               "-----------------|\n");
+  for (int i = 0; i < self->num_procs; i++) {
+    if (!self->procs[i].usado) continue;
+    char nome[20];
+    sprintf(nome, "%d", i);
+    metricas__grava_linha_tabela(arq, nome, &self->procs[i]);
+  }
+  metricas_proc_t total = metricas__total(self);
+  metricas__grava_linha_tabela(arq, "TOTAL", &total);
+}
+
+static void metricas__grava_linha_csv(metricas_t *self, FILE *arq, char *nome,
+                                      metricas_proc_t *m, double media,
+                                      int maximo)
+{
+  fprintf(arq, "%d,%d,%d,%s,%s,%d,%d,%d,%d,%ld,%ld,%ld,%.2f,%d\n",
+          self->tam_mem, self->tam_pagina, self->num_quadros, self->politica,
+          nome, m->faltas, m->trazidas, m->salvas, m->copias_evitadas,
+          m->tempo_bloqueado, self->tlb_acertos, self->tlb_falhas,
+          media, maximo);
+}
+
+// uma linha por processo e uma com o total; as colunas de configuração e
+//   globais se repetem em todas as linhas, para que os arquivos de várias
+//   execuções possam ser simplesmente concatenados
+static void metricas__grava_csv(metricas_t *self, FILE *arq, int agora)
+{
+  double media;
+  int maximo;
+  metricas__resumo_ocupacao(self, agora, &media, &maximo);
+  fprintf(arq, "tam_mem,tam_pagina,num_quadros,politica,processo,faltas,"
+               "trazidas,salvas,copias_evitadas,tempo_bloqueado,"
+               "tlb_acertos,tlb_falhas,ocupacao_media,ocupacao_maxima\n");
+  for (int i = 0; i < self->num_procs; i++) {
+    if (!self->procs[i].usado) continue;
+    char nome[20];
+    sprintf(nome, "%d", i);
+    metricas__grava_linha_csv(self, arq, nome, &self->procs[i], media, maximo);
+  }
+  metricas_proc_t total = metricas__total(self);
+  metricas__grava_linha_csv(self, arq, "total", &total, media, maximo);
+}
+
+static void metricas__grava_proc_json(FILE *arq, metricas_proc_t *m)
+{
+  fprintf(arq, "\"faltas\": %d, \"trazidas\": %d, \"salvas\": %d, "
+               "\"copias_evitadas\": %d, \"tempo_bloqueado\": %ld",
+          m->faltas, m->trazidas, m->salvas, m->copias_evitadas,
+          m->tempo_bloqueado);
+}
+
+static void metricas__grava_json(metricas_t *self, FILE *arq, int agora)
+{
+  double media;
+  int maximo;
+  metricas__resumo_ocupacao(self, agora, &media, &maximo);
+  fprintf(arq, "{\n");
+  fprintf(arq, "  \"config\": {\"tam_mem\": %d, \"tam_pagina\": %d, "
+               "\"num_quadros\": %d, \"politica\": \"%s\"},\n",
+          self->tam_mem, self->tam_pagina, self->num_quadros, self->politica);
+  fprintf(arq, "  \"tempo\": %d,\n", agora);
+  fprintf(arq, "  \"tlb\": {\"acertos\": %ld, \"falhas\": %ld, "
+               "\"taxa_acertos\": %.4f},\n",
+          self->tlb_acertos, self->tlb_falhas, metricas__taxa_tlb(self));
+  metricas_proc_t total = metricas__total(self);
+  fprintf(arq, "  \"total\": {");
+  metricas__grava_proc_json(arq, &total);
+  fprintf(arq, "},\n");
+  fprintf(arq, "  \"processos\": [");
+  bool primeiro = true;
+  for (int i = 0; i < self->num_procs; i++) {
+    if (!self->procs[i].usado) continue;
+    fprintf(arq, "%s\n    {\"processo\": %d, ", primeiro ? "" : ",", i);
+    metricas__grava_proc_json(arq, &self->procs[i]);
+    fprintf(arq, "}");
+    primeiro = false;
+  }
+  fprintf(arq, "\n  ],\n");
+  fprintf(arq, "  \"ocupacao\": {\"media\": %.2f, \"maxima\": %d, "
+               "\"serie\": [", media, maximo);
+  for (int i = 0; i < self->num_ocupacao; i++) {
+    fprintf(arq, "%s[%d, %d]", i == 0 ? "" : ", ", self->ocupacao[i].tempo,
+            self->ocupacao[i].ocupados);
+  }
+  fprintf(arq, "]}\n");
+  fprintf(arq, "}\n");
+}
+
+// grava um relatório no arquivo 'nome_base' + 'extensao' usando 'grava'
+static bool metricas__grava_arquivo(metricas_t *self, char *nome_base,
+                                    char *extensao, int agora,
+                                    void (*grava)(metricas_t *, FILE *, int))
+{
+  char nome[strlen(nome_base) + strlen(extensao) + 1];
+  sprintf(nome, "%s%s", nome_base, extensao);
+  FILE *arq = fopen(nome, "w");
+  if (arq == NULL) return false;
+  grava(self, arq, agora);
+  return fclose(arq) == 0;
+}
+
+bool metricas_grava(metricas_t *self, char *nome_base, int agora)
+{
+  bool ok = true;
+  ok &= metricas__grava_arquivo(self, nome_base, ".txt", agora,
+                                metricas__grava_tabela);
+  ok &= metricas__grava_arquivo(self, nome_base, ".csv", agora,
+                                metricas__grava_csv);
+  ok &= metricas__grava_arquivo(self, nome_base, ".json", agora,
+                                metricas__grava_json);
+  return ok;
+}
+
+// vim: foldmethod=marker
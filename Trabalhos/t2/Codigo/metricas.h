@@ -0,0 +1,55 @@
+// metricas.h
+// métricas de paginação do SO
+// simulador de computador
+// so24b
+
+#ifndef METRICAS_H
+#define METRICAS_H
+
+// estrutura auxiliar para o SO acumular medidas do desempenho da memória
+//   virtual, por processo e globais, e gerar relatórios
+// os relatórios são gerados em três formatos: uma tabela para leitura, e
+//   CSV e JSON para serem processados por programas (para comparar
+//   execuções com configurações diferentes, por exemplo)
+
+#include <stdbool.h>
+
+typedef struct metricas_t metricas_t;
+
+// cria e inicializa as métricas
+// mata o programa em caso de erro (malloc)
+metricas_t *metricas_cria(void);
+
+// destrói as métricas
+void metricas_destroi(metricas_t *self);
+
+// registra a configuração da memória, para constar nos relatórios
+void metricas_define_config(metricas_t *self, int tam_mem, int tam_pagina,
+                            int num_quadros, char *politica);
+
+// registra uma falta de página do processo 'processo'
+void metricas_falta_de_pagina(metricas_t *self, int processo);
+
+// registra que uma página do processo foi trazida da memória secundária
+//   e que o processo ficou 'tempo' bloqueado esperando por ela
+void metricas_pagina_trazida(metricas_t *self, int processo, int tempo);
+
+// registra que uma página do processo foi retirada da memória principal;
+//   'alterada' diz se ela teve que ser copiada para a memória secundária
+//   (se não, a cópia foi evitada)
+void metricas_pagina_retirada(metricas_t *self, int processo, bool alterada);
+
+// registra que no tempo 'agora' há 'ocupados' quadros ocupados
+// deve ser chamada quando o número muda; o relatório tem a série completa
+//   e a média ponderada pelo tempo
+void metricas_ocupacao(metricas_t *self, int agora, int ocupados);
+
+// registra os contadores da TLB
+void metricas_tlb(metricas_t *self, long acertos, long falhas);
+
+// grava os relatórios, nos arquivos com nome 'nome_base' e as extensões
+//   .txt (tabela), .csv e .json; o tempo 'agora' é o fim da medição
+// retorna false se algum arquivo não pôde ser gravado
+bool metricas_grava(metricas_t *self, char *nome_base, int agora);
+
+#endif // METRICAS_H
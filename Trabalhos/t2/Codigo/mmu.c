@@ -7,21 +7,66 @@
 #include <stdlib.h>
 #include <assert.h>
 
+// uma entrada da TLB: a tradução de uma página e os bits dessa página que
+//   já foram marcados na tabela (para não marcar de novo a cada acesso)
+typedef struct {
+  // a entrada contém uma tradução ou está vazia
+  bool valida;
+  int pagina;
+  int quadro;
+  bool acessada;
+  bool alterada;
+} entrada_tlb_t;
+
 // tipo de dados opaco para representar uma MMU
 struct mmu_t {
   // memória física
   mem_t *mem;
   // tabela de páginas
+  // tamanho da página; como é uma potência de 2, a tradução é feita com
+  //   deslocamento e máscara em vez de divisão e resto
+  int tam_pagina;
+  int bits_deslocamento;  // log2(tam_pagina)
+  int mascara_deslocamento;  // tam_pagina - 1
   tabpag_t *tabpag;
+  // TLB, com mapeamento direto (a página p fica na entrada p % TAM_TLB)
+  // as traduções valem para a versão 'versao_tabpag' da tabela de páginas
+  entrada_tlb_t tlb[TAM_TLB];
+  int versao_tabpag;
+  // contadores de acertos e falhas na TLB
+  long tlb_acertos;
+  long tlb_falhas;
 };
 
-mmu_t *mmu_cria(mem_t *mem)
+static void mmu__esvazia_tlb(mmu_t *self)
+{
+  for (int i = 0; i < TAM_TLB; i++) {
+    self->tlb[i].valida = false;
+    self->tlb[i].pagina = 0;
+    self->tlb[i].quadro = 0;
+  }
+  if (self->tabpag != NULL) {
+    self->versao_tabpag = tabpag_versao(self->tabpag);
+  }
+}
+
+mmu_t *mmu_cria(mem_t *mem, int tam_pagina)
 {
+  assert(mmu_tam_pagina_valido(tam_pagina));
   mmu_t *self;
   self = malloc(sizeof(*self));
   assert(self != NULL);
   self->mem = mem;
+  self->tam_pagina = tam_pagina;
+  self->bits_deslocamento = 0;
+  while ((1 << self->bits_deslocamento) < tam_pagina) {
+    self->bits_deslocamento++;
+  }
+  self->mascara_deslocamento = tam_pagina - 1;
   self->tabpag = NULL;
+  self->tlb_acertos = 0;
+  self->tlb_falhas = 0;
+  mmu__esvazia_tlb(self);
   return self;
 }
 
@@ -33,24 +78,103 @@ void mmu_destroi(mmu_t *self)
   }
 }
 
+int mmu_tam_pagina(mmu_t *self)
+{
+  return self->tam_pagina;
+}
+
+bool mmu_tam_pagina_valido(int tam_pagina)
+{
+  return tam_pagina > 0 && (tam_pagina & (tam_pagina - 1)) == 0;
+}
+
 void mmu_define_tabpag(mmu_t *self, tabpag_t *tabpag)
 {
   self->tabpag = tabpag;
+  mmu__esvazia_tlb(self);
+}
+
+void mmu_contadores_tlb(mmu_t *self, long *pacertos, long *pfalhas)
+{
+  *pacertos = self->tlb_acertos;
+  *pfalhas = self->tlb_falhas;
 }
 
-// tradur o endereço virtual 'endvirt', colocando o endereço físico
+void mmu_zera_bit_acesso(mmu_t *self, tabpag_t *tabpag, int pagina)
+{
+  tabpag_zera_bit_acesso(tabpag, pagina);
+  // a TLB só contém páginas da tabela em uso
+  if (tabpag != self->tabpag || pagina < 0) return;
+  entrada_tlb_t *entrada = &self->tlb[pagina & (TAM_TLB - 1)];
+  if (entrada->valida && entrada->pagina == pagina) {
+    entrada->acessada = false;
+  }
+}
+
+// traduz o endereço virtual 'endvirt', colocando o endereço físico
 //   correspondente em 'pendfis'.
+// a tradução da página é buscada na TLB, e só em caso de falha na tabela de
+//   páginas
+// se a tradução for bem sucedida e resultar em um endereço físico válido,
+//   marca na tabela de páginas o acesso à página (e a alteração, se
+//   'alteracao' for true) -- o acesso à memória não vai falhar
 // retorna ERR_OK ou um erro se a tradução não for possível
-static err_t mmu__traduz(mmu_t *self, int endvirt, int *pendfis)
+static err_t mmu__traduz(mmu_t *self, int endvirt, int *pendfis, bool alteracao)
 {
-  int pagina = endvirt / TAM_PAGINA;
-  int deslocamento = endvirt % TAM_PAGINA;
-  int quadro;
-  err_t err = tabpag_traduz(self->tabpag, pagina, &quadro);
-  if (err == ERR_OK) {
-    *pendfis = quadro * TAM_PAGINA + deslocamento;
+  // o deslocamento à direita de um endereço negativo resultaria em uma página
+  //   negativa com deslocamento positivo, sem relação com o endereço; um
+  //   endereço negativo nunca é válido
+  if (endvirt < 0) return ERR_END_INV;
+  int pagina = endvirt >> self->bits_deslocamento;
+  int deslocamento = endvirt & self->mascara_deslocamento;
+  if (tabpag_versao(self->tabpag) != self->versao_tabpag) {
+    mmu__esvazia_tlb(self);
   }
-  return err;
+  entrada_tlb_t *entrada = &self->tlb[pagina & (TAM_TLB - 1)];
+  if (entrada->valida && entrada->pagina == pagina) {
+    self->tlb_acertos++;
+  } else {
+    self->tlb_falhas++;
+    int quadro;
+    err_t err = tabpag_traduz(self->tabpag, pagina, &quadro);
+    if (err != ERR_OK) return err;
+    entrada->valida = true;
+    entrada->pagina = pagina;
+    entrada->quadro = quadro;
+    entrada->acessada = false;
+    entrada->alterada = false;
+  }
+  int endfis = (entrada->quadro << self->bits_deslocamento) | deslocamento;
+  if (endfis < 0 || endfis >= mem_tam(self->mem)) return ERR_END_INV;
+  if (!entrada->acessada || (alteracao && !entrada->alterada)) {
+    tabpag_marca_bit_acesso(self->tabpag, pagina, alteracao);
+    entrada->acessada = true;
+    if (alteracao) entrada->alterada = true;
+  }
+  *pendfis = endfis;
+  return ERR_OK;
+}
+
+err_t mmu_traduz(mmu_t *self, int endvirt, int *pendfis, int *presto,
+                 cpu_modo_t modo)
+{
+  int tam_mem = mem_tam(self->mem);
+  // sem tradução, o endereço virtual é o físico, e a "página" é a memória toda
+  if (modo == supervisor || self->tabpag == NULL) {
+    if (endvirt < 0 || endvirt >= tam_mem) return ERR_END_INV;
+    *pendfis = endvirt;
+    *presto = tam_mem - endvirt;
+    return ERR_OK;
+  }
+  err_t err = mmu__traduz(self, endvirt, pendfis, false);
+  if (err != ERR_OK) return err;
+  *presto = self->tam_pagina - (endvirt & self->mascara_deslocamento);
+  return ERR_OK;
+}
+
+mem_t *mmu_mem(mmu_t *self)
+{
+  return self->mem;
 }
 
 err_t mmu_le(mmu_t *self, int endvirt, int *pvalor, cpu_modo_t modo)
@@ -61,12 +185,9 @@ err_t mmu_le(mmu_t *self, int endvirt, int *pvalor, cpu_modo_t modo)
     return mem_le(self->mem, endvirt, pvalor);
   }
   int endfis;
-  err_t err = mmu__traduz(self, endvirt, &endfis);
+  err_t err = mmu__traduz(self, endvirt, &endfis, false);
   if (err == ERR_OK) {
     err = mem_le(self->mem, endfis, pvalor);
-    if (err == ERR_OK) {
-      tabpag_marca_bit_acesso(self->tabpag, endvirt / TAM_PAGINA, false);
-    }
   }
   return err;
 }
@@ -79,12 +200,64 @@ err_t mmu_escreve(mmu_t *self, int endvirt, int valor, cpu_modo_t modo)
     return mem_escreve(self->mem, endvirt, valor);
   }
   int endfis;
-  err_t err = mmu__traduz(self, endvirt, &endfis);
+  err_t err = mmu__traduz(self, endvirt, &endfis, true);
   if (err == ERR_OK) {
     err = mem_escreve(self->mem, endfis, valor);
+  }
+  return err;
+}
+
+// copia um bloco entre 'valores' e a memória virtual, uma página de cada vez
+static err_t mmu__copia_bloco(mmu_t *self, int endvirt, int *valores, int n,
+                              cpu_modo_t modo, bool escrita,
+                              int *pendvirt_erro)
+{
+  // sem tradução, a faixa é contínua na memória física
+  if (modo == supervisor || self->tabpag == NULL) {
+    err_t err;
+    if (escrita) {
+      err = mem_escreve_bloco(self->mem, endvirt, valores, n);
+    } else {
+      err = mem_le_bloco(self->mem, endvirt, valores, n);
+    }
+    if (err != ERR_OK && pendvirt_erro != NULL) *pendvirt_erro = endvirt;
+    return err;
+  }
+  while (n > 0) {
+    int endfis;
+    int parte = self->tam_pagina - (endvirt & self->mascara_deslocamento);
+    if (parte > n) parte = n;
+    // a parte está toda na mesma página, basta traduzir o início
+    err_t err = mmu__traduz(self, endvirt, &endfis, escrita);
     if (err == ERR_OK) {
-      tabpag_marca_bit_acesso(self->tabpag, endvirt / TAM_PAGINA, true);
+      if (escrita) {
+        err = mem_escreve_bloco(self->mem, endfis, valores, parte);
+      } else {
+        err = mem_le_bloco(self->mem, endfis, valores, parte);
+      }
+    }
+    if (err != ERR_OK) {
+      if (pendvirt_erro != NULL) *pendvirt_erro = endvirt;
+      return err;
     }
+    endvirt += parte;
+    valores += parte;
+    n -= parte;
   }
-  return err;
+  return ERR_OK;
+}
+
+err_t mmu_le_bloco(mmu_t *self, int endvirt, int *valores, int n,
+                   cpu_modo_t modo, int *pendvirt_erro)
+{
+  return mmu__copia_bloco(self, endvirt, valores, n, modo, false,
+                          pendvirt_erro);
+}
+
+err_t mmu_escreve_bloco(mmu_t *self, int endvirt, const int *valores, int n,
+                        cpu_modo_t modo, int *pendvirt_erro)
+{
+  // a cópia não altera 'valores' quando 'escrita' é true
+  return mmu__copia_bloco(self, endvirt, (int *)valores, n, modo, true,
+                          pendvirt_erro);
 }
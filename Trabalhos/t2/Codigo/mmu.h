@@ -19,16 +19,28 @@ typedef struct mmu_t mmu_t;
 #include "err.h"
 #include "cpu.h"
 
-// tamanho de uma página, em palavras de memória
-// t2: pode ser alterado para comparar configurações diferentes
-#define TAM_PAGINA 10
+// tamanho padrão de uma página, em palavras de memória
+// o tamanho é definido na criação da MMU, e deve ser uma potência de 2
+// t2: pode ser alterado para comparar configurações diferentes (ou com a
+//     opção -p na linha de comando)
+#define TAM_PAGINA 16
+
+// número de entradas da TLB (mapeamento direto, deve ser potência de 2)
+#define TAM_TLB 16
 
 // cria uma MMU para gerenciar acessos à memória
 // retorna um ponteiro para um descritor, que deverá ser usado em todas
 //   as operações nessa MMU
-// recebe 'mem', a memória física que será gerenciada
+// recebe 'mem', a memória física que será gerenciada, e o tamanho das
+//   páginas, que deve ser uma potência de 2
 // mata o programa em caso de erro (malloc)
-mmu_t *mmu_cria(mem_t *mem);
+mmu_t *mmu_cria(mem_t *mem, int tam_pagina);
+
+// retorna o tamanho de uma página, em palavras de memória
+int mmu_tam_pagina(mmu_t *self);
+
+// retorna true se 'tam_pagina' for um tamanho de página aceitável
+bool mmu_tam_pagina_valido(int tam_pagina);
 
 // destrói uma MMU
 // nenhuma outra operação pode ser realizada na MMU após esta chamada
@@ -36,8 +48,21 @@ void mmu_destroi(mmu_t *self);
 
 // define a tabela de páginas a usar nas próximas traduções
 // se tabpag for NULL, os acessos serão repassados sem alteração à memória
+// esvazia a TLB
 void mmu_define_tabpag(mmu_t *self, tabpag_t *tabpag);
 
+// A MMU mantém uma TLB com as traduções mais recentes. A TLB é esvaziada
+//   quando a tabela de páginas é trocada ou alterada (ver tabpag_versao).
+// coloca em '*pacertos' e '*pfalhas' o número de traduções feitas com e sem
+//   sucesso na TLB desde a criação da MMU
+void mmu_contadores_tlb(mmu_t *self, long *pacertos, long *pfalhas);
+
+// zera o bit de acesso da página 'pagina' na tabela 'tabpag' (ver
+//   tabpag_zera_bit_acesso), e desfaz na TLB a marcação desse acesso, para
+//   que o próximo acesso à página marque o bit de novo
+// só a entrada da TLB dessa página é afetada
+void mmu_zera_bit_acesso(mmu_t *self, tabpag_t *tabpag, int pagina);
+
 // coloca na posição apontada por 'pvalor' o valor que está na memória
 //   no endereço físico correspondente ao endereço virtual 'endvirt'
 // marca a página como acessada se o acesso for bem sucedido
@@ -48,6 +73,18 @@ void mmu_define_tabpag(mmu_t *self, tabpag_t *tabpag);
 //   à memória sem tradução
 err_t mmu_le(mmu_t *self, int endvirt, int *pvalor, cpu_modo_t modo);
 
+// traduz o endereço virtual 'endvirt' como em um acesso de leitura com
+//   mmu_le (inclusive marcando a página como acessada), mas sem acessar a memória
+// coloca em '*pendfis' o endereço físico correspondente e em '*presto' o
+//   número de endereços virtuais a partir de 'endvirt' que estão na mesma página
+//   (e portanto em endereços físicos consecutivos)
+// retorna os mesmos erros que mmu_le
+err_t mmu_traduz(mmu_t *self, int endvirt, int *pendfis, int *presto,
+                 cpu_modo_t modo);
+
+// retorna a memória física gerenciada pela MMU
+mem_t *mmu_mem(mmu_t *self);
+
 // coloca 'valor' no endereço físico da memória correspondente ao endereço
 //   virtual 'endvirt'
 // marca a página como acessada e alterada se o acesso for bem sucedido
@@ -58,4 +95,17 @@ err_t mmu_le(mmu_t *self, int endvirt, int *pvalor, cpu_modo_t modo);
 //   à memória sem tradução
 err_t mmu_escreve(mmu_t *self, int endvirt, int valor, cpu_modo_t modo);
 
+// acessos em bloco
+// lê (ou escreve) os 'n' valores a partir do endereço virtual 'endvirt',
+//   com a mesma tradução, marcação de bits e erros de mmu_le (ou mmu_escreve)
+// a faixa é dividida nos limites de página, e cada parte é copiada de uma
+//   vez da (ou para a) memória física
+// em caso de erro, as páginas anteriores à que causou o erro podem ter sido
+//   copiadas; se 'pendvirt_erro' não for NULL, é colocado nele o endereço
+//   virtual do primeiro valor da parte que não pôde ser copiada
+err_t mmu_le_bloco(mmu_t *self, int endvirt, int *valores, int n,
+                   cpu_modo_t modo, int *pendvirt_erro);
+err_t mmu_escreve_bloco(mmu_t *self, int endvirt, const int *valores, int n,
+                        cpu_modo_t modo, int *pendvirt_erro);
+
 #endif // MMU_H
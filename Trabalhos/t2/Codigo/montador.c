@@ -5,6 +5,7 @@
 
 // INCLUDES {{{1
 #include "instrucao.h"
+#include "programa.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -45,6 +46,7 @@ int mem_min = -1;       // menor endereço preenchido
 int mem_max = -1;       // maior endereço preenchido
 
 char *nome_fonte;   // nome do arquivo fonte a montar
+bool saida_binaria; // gera o formato binário em vez do texto
 
 // coloca um valor no final da memória
 void mem_insere(int val)
@@ -87,6 +89,7 @@ void mem_imprime(void)
 struct {
   char *nome;
   int valor;
+  bool relocavel;   // o valor é um endereço do programa (label)
 } simbolo[SIMB_TAM];
 int simb_num;             // número d símbolos na tabela
 
@@ -101,8 +104,20 @@ int simb_valor(char *nome)
   return -1;
 }
 
+// retorna true se o símbolo existe e seu valor é um endereço do programa
+bool simb_relocavel(char *nome)
+{
+  for (int i=0; i<simb_num; i++) {
+    if (strcmp(nome, simbolo[i].nome) == 0) {
+      return simbolo[i].relocavel;
+    }
+  }
+  return false;
+}
+
 // insere um novo símbolo na tabela
-void simb_novo(char *nome, int valor)
+// 'relocavel' diz se o valor é um endereço do programa ou uma constante
+void simb_novo(char *nome, int valor, bool relocavel)
 {
   if (nome == NULL) return;
   if (simb_valor(nome) != -1) {
@@ -114,6 +129,7 @@ void simb_novo(char *nome, int valor)
   }
   simbolo[simb_num].nome = strdup(nome);
   simbolo[simb_num].valor = valor;
+  simbolo[simb_num].relocavel = relocavel;
   simb_num++;
 }
 
@@ -131,6 +147,10 @@ struct {
 } ref[REF_TAM];
 int ref_num;      // numero de referências criadas
 
+// endereços que contêm endereços do programa (referências a labels)
+int reloc[REF_TAM];
+int reloc_num;
+
 // insere uma nova referência na tabela
 void ref_nova(char *nome, int linha, int endereco)
 {
@@ -156,6 +176,9 @@ void ref_resolve(void)
               ref[i].nome, ref[i].linha);
     }
     mem_altera(ref[i].endereco, valor);
+    if (simb_relocavel(ref[i].nome)) {
+      reloc[reloc_num++] = ref[i].endereco;
+    }
   }
 }
 
@@ -219,7 +242,7 @@ void monta_define(int linha, char *label, char *arg)
     fprintf(stderr, "ERRO: linha %d 'DEFINE' exige valor numérico\n", linha);
   } else {
     // tudo OK, define o símbolo
-    simb_novo(label, argn);
+    simb_novo(label, argn, false);
   }
 }
 
@@ -236,7 +259,7 @@ void monta_linha(int linha, char *label, char *instrucao, char *arg)
   
   // cria símbolo correspondente ao label, se for o caso
   if (label != NULL) {
-    simb_novo(label, mem_pos);
+    simb_novo(label, mem_pos, true);
   }
   
   // verifica a existência de instrução e número correto de argumentos
@@ -371,6 +394,45 @@ void monta_arquivo(char *nome)
   ref_resolve();
 }
 
+// SAÍDA BINÁRIA {{{1
+
+// grava um bloco binário na saída
+void grava(void *dados, size_t tam)
+{
+  if (tam > 0 && fwrite(dados, tam, 1, stdout) != 1) {
+    erro_brabo("erro na escrita da saída");
+  }
+}
+
+// grava o conteúdo da memória no formato binário (ver programa.h)
+void mem_grava_binario(void)
+{
+  cabecalho_maqb_t cab = {
+    .versao = MAQB_VERSAO,
+    .tamanho = mem_max - mem_min + 1,
+    .carga = mem_min,
+    .inicio = mem_min,
+    .num_relocacoes = reloc_num,
+    .num_simbolos = simb_num,
+  };
+  memcpy(cab.magico, MAQB_MAGICO, sizeof(cab.magico));
+  grava(&cab, sizeof(cab));
+  for (int i = mem_min; i <= mem_max; i++) {
+    int32_t val = mem[i];
+    grava(&val, sizeof(val));
+  }
+  for (int i = 0; i < reloc_num; i++) {
+    int32_t end = reloc[i];
+    grava(&end, sizeof(end));
+  }
+  for (int i = 0; i < simb_num; i++) {
+    simbolo_maqb_t simb = { .valor = simbolo[i].valor };
+    strncpy(simb.nome, simbolo[i].nome, sizeof(simb.nome) - 1);
+    grava(&simb, sizeof(simb));
+  }
+}
+
+
 // MAIN {{{1
 
 void verifica_args(int argc, char *argv[argc])
@@ -388,12 +450,14 @@ void verifica_args(int argc, char *argv[argc])
         fprintf(stderr, "ERRO: endereço inválido: '%s'\n", argv[argi]);
         exit(1);
       }
+    } else if (strcmp(argv[argi], "-b") == 0) {
+      saida_binaria = true;
     } else {
       nome_fonte = argv[argi];
     }
   }
   if (nome_fonte == NULL) {
-    fprintf(stderr, "ERRO: chame como '%s [-e end.inicial] nome_do_arquivo'\n",
+    fprintf(stderr, "ERRO: chame como '%s [-b] [-e end.inicial] nome_do_arquivo'\n",
             argv[0]);
     exit(1);
   }
@@ -403,7 +467,11 @@ int main(int argc, char *argv[argc])
 {
   verifica_args(argc, argv);
   monta_arquivo(nome_fonte);
-  mem_imprime();
+  if (saida_binaria) {
+    mem_grava_binario();
+  } else {
+    mem_imprime();
+  }
   return 0;
 }
 
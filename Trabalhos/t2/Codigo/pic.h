@@ -0,0 +1,82 @@
+// pic.h
+// controlador de interrupções
+// simulador de computador
+// so24b
+
+#ifndef PIC_H
+#define PIC_H
+
+// simulação de um controlador de interrupções programável (PIC)
+//
+// fica entre os dispositivos e a CPU: um dispositivo pede uma interrupção em
+//   uma linha (uma irq), identificando-se com um número de origem (0 a 31;
+//   o número do terminal, por exemplo); o pedido fica pendente até ser
+//   reconhecido pelo SO
+// a unidade de controle consulta o controlador após cada instrução, e pede
+//   à CPU para atender a linha pendente de maior prioridade
+// pedidos repetidos da mesma origem antes do reconhecimento contam como um
+//   (são aglutinados): um dispositivo que pede muitas vezes enquanto o SO não
+//   o atende causa uma interrupção só
+//
+// o controlador mantém um mapa de bits das linhas pendentes, e é programado
+//   pelo SO por registradores de E/S (os ids abaixo):
+// - cada linha pode ser mascarada; o pedido numa linha mascarada fica
+//   pendente, mas não é entregue à CPU até a linha ser desmascarada
+// - cada linha tem uma prioridade (um inteiro, maior é mais prioritária;
+//   inicialmente todas 0); entre linhas de mesma prioridade, a de menor
+//   número é a escolhida
+// - o SO pode perguntar qual é a próxima linha a atender, e assim atender
+//   todas as pendentes em uma só entrada no SO, em vez de uma entrada para
+//   cada uma
+//
+// o SO reconhece os pedidos de uma linha:
+// - lendo o registrador de origens da linha, que retorna as origens que
+//   pediram (o bit n para a origem n) e desliga o pedido (é o que se faz com
+//   os terminais, que compartilham as linhas); ou
+// - desligando o pedido no próprio dispositivo, que o retira do controlador
+//   (pic_retira; é o que se faz com o relógio e com o disco)
+
+#include "err.h"
+#include "irq.h"
+
+typedef struct pic_t pic_t;
+
+// ids dos registradores do controlador, para pic_leitura e pic_escrita
+// os ids de 0 a N_IRQ-1 são os registradores de origens de cada linha
+//   (leitura; reconhece os pedidos da linha)
+typedef enum {
+  PIC_PENDENTES = 32,  // mapa de bits das linhas pendentes (leitura)
+  PIC_PROXIMA,         // linha pendente não mascarada de maior prioridade,
+                       //   ou -1 se não tem (leitura)
+  PIC_MASCARA,         // mapa de bits das linhas mascaradas (leitura e escrita)
+  PIC_LINHA,           // linha selecionada para PIC_PRIORIDADE (leitura e
+                       //   escrita)
+  PIC_PRIORIDADE,      // prioridade da linha selecionada (leitura e escrita)
+} pic_registrador_t;
+
+// cria e inicializa um controlador, sem pedidos pendentes, sem linhas
+//   mascaradas e com todas as prioridades iguais
+pic_t *pic_cria(void);
+
+// destrói um controlador
+void pic_destroi(pic_t *self);
+
+// pede uma interrupção na linha 'irq', vinda da origem 'origem' (0 a 31)
+// (para uso pelos dispositivos)
+void pic_pede(pic_t *self, irq_t irq, int origem);
+
+// retira o pedido da origem 'origem' na linha 'irq', se houver
+// (para uso pelos dispositivos, quando o SO desliga o pedido neles)
+void pic_retira(pic_t *self, irq_t irq, int origem);
+
+// retorna a linha pendente não mascarada de maior prioridade, ou -1 se não
+//   tem (para uso pela unidade de controle)
+int pic_irq_pendente(pic_t *self);
+
+// Funções para acessar o controlador como dispositivo de E/S, com os ids
+//   descritos acima
+// Devem seguir o protocolo f_leitura_t e f_escrita_t declarados em es.h
+err_t pic_leitura(void *disp, int id, int *pvalor);
+err_t pic_escrita(void *disp, int id, int valor);
+
+#endif // PIC_H
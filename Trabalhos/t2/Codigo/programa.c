@@ -7,13 +7,33 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// a imagem do arquivo binário é usada diretamente como vetor de int
+_Static_assert(sizeof(int) == sizeof(int32_t), "int deve ter 32 bits");
 
 struct programa_t {
   int carga;
+  int inicio;
   int tamanho;
   int *dados;
+  // só no formato binário: o arquivo mapeado e as seções dentro dele
+  //   (dados aponta para dentro do mapeamento)
+  void *mapa;
+  size_t tam_mapa;
+  int num_relocacoes;
+  int32_t *relocacoes;
+  int num_simbolos;
+  simbolo_maqb_t *simbolos;
 };
 
+// FORMATO TEXTO {{{1
+
 // lê os dados do cabeçalho do arquivo (1ª linha)
 // tem "MAQ" seguido do tamanho e endereço inicial do programa
 static programa_t *pega_cabecalho(char *lin)
@@ -29,6 +49,13 @@ static programa_t *pega_cabecalho(char *lin)
   }
   prog->tamanho = tam;
   prog->carga = carga;
+  prog->inicio = carga;
+  prog->mapa = NULL;
+  prog->tam_mapa = 0;
+  prog->num_relocacoes = 0;
+  prog->relocacoes = NULL;
+  prog->num_simbolos = 0;
+  prog->simbolos = NULL;
   return prog;
 }
 
@@ -50,7 +77,7 @@ static void pega_dados(programa_t *self, char *lin)
   }
 }
 
-programa_t *prog_cria(char *nome)
+static programa_t *prog_cria_texto(char *nome)
 {
   FILE *arq = fopen(nome, "r");
   if (arq == NULL) return NULL;
@@ -69,12 +96,88 @@ fim:
   return prog;
 }
 
+// FORMATO BINÁRIO {{{1
+
+// verifica se o cabeçalho é coerente com o tamanho do arquivo
+static bool cabecalho_valido(cabecalho_maqb_t *cab, size_t tam_arq)
+{
+  if (memcmp(cab->magico, MAQB_MAGICO, sizeof(cab->magico)) != 0) return false;
+  if (cab->versao != MAQB_VERSAO) return false;
+  if (cab->tamanho < 0 || cab->num_relocacoes < 0 || cab->num_simbolos < 0) {
+    return false;
+  }
+  size_t tam = sizeof(*cab)
+             + (size_t)cab->tamanho * sizeof(int32_t)
+             + (size_t)cab->num_relocacoes * sizeof(int32_t)
+             + (size_t)cab->num_simbolos * sizeof(simbolo_maqb_t);
+  return tam <= tam_arq;
+}
+
+// mapeia o arquivo 'fd' na memória; as seções são usadas diretamente
+//   no mapeamento, sem cópia nem conversão
+static programa_t *prog_cria_binario(int fd, size_t tam_arq)
+{
+  void *mapa = mmap(NULL, tam_arq, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (mapa == MAP_FAILED) return NULL;
+  cabecalho_maqb_t *cab = mapa;
+  if (!cabecalho_valido(cab, tam_arq)) {
+    munmap(mapa, tam_arq);
+    return NULL;
+  }
+  programa_t *prog = malloc(sizeof(*prog));
+  if (prog == NULL) {
+    munmap(mapa, tam_arq);
+    return NULL;
+  }
+  int32_t *dados = (int32_t *)(cab + 1);
+  prog->carga = cab->carga;
+  prog->inicio = cab->inicio;
+  prog->tamanho = cab->tamanho;
+  prog->dados = (int *)dados;
+  prog->mapa = mapa;
+  prog->tam_mapa = tam_arq;
+  prog->num_relocacoes = cab->num_relocacoes;
+  prog->relocacoes = dados + cab->tamanho;
+  prog->num_simbolos = cab->num_simbolos;
+  prog->simbolos = (simbolo_maqb_t *)(prog->relocacoes + cab->num_relocacoes);
+  return prog;
+}
+
+// CRIAÇÃO E DESTRUIÇÃO {{{1
+
+programa_t *prog_cria(char *nome)
+{
+  // decide o formato pelos primeiros bytes do arquivo
+  int fd = open(nome, O_RDONLY);
+  if (fd == -1) return NULL;
+  struct stat st;
+  char magico[sizeof(((cabecalho_maqb_t *)0)->magico)];
+  bool binario = fstat(fd, &st) == 0
+              && (size_t)st.st_size >= sizeof(cabecalho_maqb_t)
+              && read(fd, magico, sizeof(magico)) == sizeof(magico)
+              && memcmp(magico, MAQB_MAGICO, sizeof(magico)) == 0;
+  programa_t *prog;
+  if (binario) {
+    prog = prog_cria_binario(fd, st.st_size);
+  } else {
+    prog = prog_cria_texto(nome);
+  }
+  close(fd);
+  return prog;
+}
+
 void prog_destroi(programa_t *self)
 {
-  free(self->dados);
+  if (self->mapa != NULL) {
+    munmap(self->mapa, self->tam_mapa);
+  } else {
+    free(self->dados);
+  }
   free(self);
 }
 
+// ACESSO {{{1
+
 int prog_tamanho(programa_t *self)
 {
   return self->tamanho;
@@ -87,7 +190,7 @@ int prog_end_carga(programa_t *self)
 
 int prog_end_inicio(programa_t *self)
 {
-  return self->carga;
+  return self->inicio;
 }
 
 int prog_dado(programa_t *self, int ender)
@@ -95,3 +198,32 @@ int prog_dado(programa_t *self, int ender)
   if (ender < self->carga || ender >= self->carga + self->tamanho) return -1;
   return self->dados[ender - self->carga];
 }
+
+const int *prog_dados(programa_t *self)
+{
+  return self->dados;
+}
+
+int prog_num_relocacoes(programa_t *self)
+{
+  return self->num_relocacoes;
+}
+
+int prog_relocacao(programa_t *self, int i)
+{
+  if (i < 0 || i >= self->num_relocacoes) return -1;
+  return self->relocacoes[i];
+}
+
+int prog_simbolo(programa_t *self, char *nome)
+{
+  for (int i = 0; i < self->num_simbolos; i++) {
+    simbolo_maqb_t *simb = &self->simbolos[i];
+    if (strncmp(simb->nome, nome, sizeof(simb->nome)) == 0) {
+      return simb->valor;
+    }
+  }
+  return -1;
+}
+
+// vim: foldmethod=marker
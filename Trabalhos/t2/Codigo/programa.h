@@ -6,10 +6,42 @@
 #ifndef PROGRAMA_H
 #define PROGRAMA_H
 
+#include <stdint.h>
+
 // TAD para representar um programa lido de um arquivo '.maq'
+// o arquivo pode estar em um de dois formatos:
+// - texto: uma linha "MAQ tamanho carga", seguida de linhas "[end] = v, v, ..."
+// - binário: um cabeçalho (cabecalho_maqb_t), seguido da imagem da memória
+//   (tamanho valores int32_t), da seção de relocação (num_relocacoes
+//   endereços, que contêm valores que são endereços do programa) e da seção
+//   de símbolos (num_simbolos entradas simbolo_maqb_t)
+//   os valores estão na ordem de bytes da máquina que gerou o arquivo
+// o formato binário é gerado pelo montador com a opção '-b', e é mapeado
+//   diretamente na memória (com mmap), sem interpretação
 
 typedef struct programa_t programa_t;
 
+// formato binário
+
+#define MAQB_MAGICO "MAQB"
+#define MAQB_VERSAO 1
+#define MAQB_TAM_NOME 28
+
+typedef struct {
+  char magico[4];         // MAQB_MAGICO, sem o '\0'
+  int32_t versao;         // MAQB_VERSAO
+  int32_t tamanho;        // número de valores na imagem
+  int32_t carga;          // endereço de carga do primeiro valor
+  int32_t inicio;         // endereço inicial de execução
+  int32_t num_relocacoes; // número de endereços na seção de relocação
+  int32_t num_simbolos;   // número de entradas na seção de símbolos
+} cabecalho_maqb_t;
+
+typedef struct {
+  int32_t valor;
+  char nome[MAQB_TAM_NOME]; // terminado por '\0' (nome truncado se preciso)
+} simbolo_maqb_t;
+
 // cria e inicializa um programa com o conteúdo do arquivo 'nome'
 // retorna NULL em caso de erro
 programa_t *prog_cria(char *nome);
@@ -31,4 +63,19 @@ int prog_end_inicio(programa_t *self);
 // valor a colocar na posição 'ender' da memória
 int prog_dado(programa_t *self, int ender);
 
+// retorna a imagem do programa, os prog_tamanho() valores a colocar na
+//   memória a partir de prog_end_carga(), para cópia em bloco
+// o vetor pertence ao programa, e só é válido até prog_destroi
+const int *prog_dados(programa_t *self);
+
+// número de endereços na seção de relocação (0 no formato texto)
+int prog_num_relocacoes(programa_t *self);
+
+// endereço da relocação 'i' -- o valor nesse endereço é um endereço do
+//   programa, e deve ser ajustado se ele for carregado em outro lugar
+int prog_relocacao(programa_t *self, int i);
+
+// valor do símbolo 'nome', ou -1 se não existir (ou formato texto)
+int prog_simbolo(programa_t *self, char *nome);
+
 #endif // PROGRAMA_H
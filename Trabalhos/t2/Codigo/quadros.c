@@ -0,0 +1,421 @@
+// quadros.c
+// tabela de quadros da memória principal, com substituição de páginas
+// simulador de computador
+// so24b
+
+#include "quadros.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+// WSClock: uma página não acessada há mais que este tempo está fora do
+//   conjunto de trabalho do processo
+#define WSCLOCK_TAU 1000
+
+// uma instrução acessa até 3 páginas (opcode, argumento e dado); os quadros
+//   ocupados pelas últimas faltas não são substituídos, senão a carga de
+//   uma página da instrução que causou a falta pode tirar outra que ela
+//   precisa, e a instrução nunca completa
+#define QUADROS_PROTEGIDOS 2
+
+// informações sobre um quadro
+typedef struct {
+  // processo dono da página no quadro, ou QUADRO_LIVRE
+  int processo;
+  tabpag_t *tabpag;
+  int pagina;
+  // posição na fila (FIFO e segunda chance): quanto menor, mais antigo
+  long ordem;
+  // envelhecimento: um bit por tic, o mais significativo é o mais recente
+  unsigned char idade;
+  // WSClock: quando a página foi vista acessada pela última vez
+  int ultimo_uso;
+  // posição do quadro na pilha de livres, -1 se não estiver livre
+  int pos_livre;
+} quadro_t;
+
+// uma política de substituição, definida pelas funções que a implementam
+typedef struct {
+  char *nome;
+  // escolhe um quadro ocupado para liberar (tem pelo menos um)
+  int (*escolhe)(quadros_t *self);
+  // chamada a cada tic, pode ser NULL
+  void (*tictac)(quadros_t *self);
+} politica_t;
+
+struct quadros_t {
+  mmu_t *mmu;
+  int num_quadros;
+  int primeiro_quadro;
+  quadro_t *quadros;
+  // pilha com os quadros livres
+  int *livres;
+  int num_livres;
+  politica_subst_t politica;
+  politica_t *impl;
+  long proxima_ordem;
+  // ponteiro circular do relógio e do WSClock
+  int ponteiro;
+  // o tempo atual, informado a cada tic, escolha e ocupação
+  int agora;
+  // os últimos quadros ocupados, -1 se não tiver ou se foi liberado
+  int recentes[QUADROS_PROTEGIDOS];
+};
+
+// FUNÇÕES AUXILIARES {{{1
+
+static bool quadros__ocupado(quadros_t *self, int quadro)
+{
+  return self->quadros[quadro].processo != QUADRO_LIVRE;
+}
+
+// um quadro pode ser escolhido para substituição se estiver ocupado e não
+//   for um dos últimos ocupados, a não ser que só esses estejam ocupados
+static bool quadros__candidato(quadros_t *self, int quadro)
+{
+  if (!quadros__ocupado(self, quadro)) return false;
+  bool recente = false;
+  int num_recentes = 0;
+  for (int i = 0; i < QUADROS_PROTEGIDOS; i++) {
+    if (self->recentes[i] == -1) continue;
+    num_recentes++;
+    if (self->recentes[i] == quadro) recente = true;
+  }
+  if (!recente) return true;
+  int ocupados = quadros_num_ocupados(self);
+  return ocupados == num_recentes;
+}
+
+static bool quadros__acessado(quadros_t *self, int quadro)
+{
+  quadro_t *q = &self->quadros[quadro];
+  return tabpag_bit_acesso(q->tabpag, q->pagina);
+}
+
+static void quadros__zera_acesso(quadros_t *self, int quadro)
+{
+  quadro_t *q = &self->quadros[quadro];
+  mmu_zera_bit_acesso(self->mmu, q->tabpag, q->pagina);
+}
+
+static bool quadros__alterado(quadros_t *self, int quadro)
+{
+  quadro_t *q = &self->quadros[quadro];
+  return tabpag_bit_alteracao(q->tabpag, q->pagina);
+}
+
+// retorna o quadro candidato com menor ordem (o que está há mais tempo na fila)
+static int quadros__mais_antigo(quadros_t *self)
+{
+  int escolhido = -1;
+  for (int i = self->primeiro_quadro; i < self->num_quadros; i++) {
+    if (!quadros__candidato(self, i)) continue;
+    if (escolhido == -1 || self->quadros[i].ordem < self->quadros[escolhido].ordem) {
+      escolhido = i;
+    }
+  }
+  return escolhido;
+}
+
+// avança o ponteiro circular para o próximo quadro não reservado
+static void quadros__avanca_ponteiro(quadros_t *self)
+{
+  self->ponteiro++;
+  if (self->ponteiro >= self->num_quadros) {
+    self->ponteiro = self->primeiro_quadro;
+  }
+}
+
+// POLÍTICAS {{{1
+
+static int fifo_escolhe(quadros_t *self)
+{
+  return quadros__mais_antigo(self);
+}
+
+static int segunda_chance_escolhe(quadros_t *self)
+{
+  // cada página acessada vai para o fim da fila sem o bit de acesso;
+  //   termina no máximo quando a fila der uma volta
+  for (;;) {
+    int quadro = quadros__mais_antigo(self);
+    if (!quadros__acessado(self, quadro)) return quadro;
+    quadros__zera_acesso(self, quadro);
+    self->quadros[quadro].ordem = self->proxima_ordem++;
+  }
+}
+
+static int relogio_escolhe(quadros_t *self)
+{
+  // na segunda volta, todos os bits de acesso estão zerados
+  for (;;) {
+    int quadro = self->ponteiro;
+    quadros__avanca_ponteiro(self);
+    if (!quadros__candidato(self, quadro)) continue;
+    if (!quadros__acessado(self, quadro)) return quadro;
+    quadros__zera_acesso(self, quadro);
+  }
+}
+
+static void envelhecimento_tictac(quadros_t *self)
+{
+  for (int i = self->primeiro_quadro; i < self->num_quadros; i++) {
+    if (!quadros__ocupado(self, i)) continue;
+    quadro_t *q = &self->quadros[i];
+    q->idade >>= 1;
+    if (quadros__acessado(self, i)) {
+      q->idade |= 0x80;
+      quadros__zera_acesso(self, i);
+    }
+  }
+}
+
+static int envelhecimento_escolhe(quadros_t *self)
+{
+  // o bit de acesso atual é mais recente que todos os bits do contador
+  // em caso de empate, escolhe o carregado há mais tempo
+  int escolhido = -1;
+  int menor_chave = 0;
+  for (int i = self->primeiro_quadro; i < self->num_quadros; i++) {
+    if (!quadros__candidato(self, i)) continue;
+    quadro_t *q = &self->quadros[i];
+    int chave = (quadros__acessado(self, i) ? 0x100 : 0) | q->idade;
+    if (escolhido == -1 || chave < menor_chave
+        || (chave == menor_chave && q->ordem < self->quadros[escolhido].ordem)) {
+      escolhido = i;
+      menor_chave = chave;
+    }
+  }
+  return escolhido;
+}
+
+static void wsclock_tictac(quadros_t *self)
+{
+  for (int i = self->primeiro_quadro; i < self->num_quadros; i++) {
+    if (!quadros__ocupado(self, i)) continue;
+    if (quadros__acessado(self, i)) {
+      self->quadros[i].ultimo_uso = self->agora;
+      quadros__zera_acesso(self, i);
+    }
+  }
+}
+
+static int wsclock_escolhe(quadros_t *self)
+{
+  // dá uma volta no relógio procurando uma página fora do conjunto de
+  //   trabalho e não alterada (que não precisa ser salva)
+  // se não achar, usa a primeira fora do conjunto de trabalho encontrada
+  //   (vai ter que ser salva), ou, se todas estiverem no conjunto de
+  //   trabalho, a usada há mais tempo
+  // o WSClock original agenda a escrita das páginas alteradas e continua
+  //   procurando; aqui a escrita é feita por quem libera o quadro
+  int velha_alterada = -1;
+  int mais_velha = -1;
+  int n = self->num_quadros - self->primeiro_quadro;
+  for (int i = 0; i < n; i++) {
+    int quadro = self->ponteiro;
+    quadros__avanca_ponteiro(self);
+    if (!quadros__candidato(self, quadro)) continue;
+    quadro_t *q = &self->quadros[quadro];
+    if (quadros__acessado(self, quadro)) {
+      q->ultimo_uso = self->agora;
+      quadros__zera_acesso(self, quadro);
+    } else if (self->agora - q->ultimo_uso > WSCLOCK_TAU) {
+      if (!quadros__alterado(self, quadro)) return quadro;
+      if (velha_alterada == -1) velha_alterada = quadro;
+    }
+    if (mais_velha == -1 || q->ultimo_uso < self->quadros[mais_velha].ultimo_uso) {
+      mais_velha = quadro;
+    }
+  }
+  if (velha_alterada != -1) return velha_alterada;
+  return mais_velha;
+}
+
+static politica_t politicas[N_SUBST] = {
+  [SUBST_FIFO]           = { "fifo",           fifo_escolhe,           NULL },
+  [SUBST_SEGUNDA_CHANCE] = { "segunda_chance", segunda_chance_escolhe, NULL },
+  [SUBST_RELOGIO]        = { "relogio",        relogio_escolhe,        NULL },
+  [SUBST_ENVELHECIMENTO] = { "envelhecimento", envelhecimento_escolhe,
+                             envelhecimento_tictac },
+  [SUBST_WSCLOCK]        = { "wsclock",        wsclock_escolhe,
+                             wsclock_tictac },
+};
+
+// CRIAÇÃO {{{1
+
+quadros_t *quadros_cria(mmu_t *mmu, int num_quadros, int primeiro_quadro,
+                        politica_subst_t politica)
+{
+  assert(politica >= 0 && politica < N_SUBST);
+  quadros_t *self = malloc(sizeof(*self));
+  assert(self != NULL);
+  self->quadros = malloc(num_quadros * sizeof(*self->quadros));
+  assert(self->quadros != NULL);
+  self->livres = malloc(num_quadros * sizeof(*self->livres));
+  assert(self->livres != NULL);
+
+  self->mmu = mmu;
+  self->num_quadros = num_quadros;
+  // sem quadro para páginas, todos são reservados
+  if (primeiro_quadro > num_quadros) primeiro_quadro = num_quadros;
+  self->primeiro_quadro = primeiro_quadro;
+  self->num_livres = 0;
+  self->politica = politica;
+  self->impl = &politicas[politica];
+  self->proxima_ordem = 0;
+  self->ponteiro = primeiro_quadro;
+  self->agora = 0;
+  for (int i = 0; i < QUADROS_PROTEGIDOS; i++) {
+    self->recentes[i] = -1;
+  }
+  // os quadros são colocados na pilha do último para o primeiro, para serem
+  //   alocados em ordem crescente
+  for (int i = num_quadros - 1; i >= 0; i--) {
+    quadro_t *q = &self->quadros[i];
+    q->processo = QUADRO_LIVRE;
+    q->tabpag = NULL;
+    q->pagina = -1;
+    q->pos_livre = -1;
+    if (i >= primeiro_quadro) {
+      q->pos_livre = self->num_livres;
+      self->livres[self->num_livres++] = i;
+    }
+  }
+  return self;
+}
+
+void quadros_destroi(quadros_t *self)
+{
+  free(self->livres);
+  free(self->quadros);
+  free(self);
+}
+
+char *quadros_nome_politica(politica_subst_t politica)
+{
+  if (politica < 0 || politica >= N_SUBST) return "DESCONHECIDA";
+  return politicas[politica].nome;
+}
+
+bool quadros_politica_por_nome(char *nome, politica_subst_t *ppolitica)
+{
+  for (politica_subst_t p = 0; p < N_SUBST; p++) {
+    if (strcmp(nome, politicas[p].nome) == 0) {
+      *ppolitica = p;
+      return true;
+    }
+  }
+  return false;
+}
+
+politica_subst_t quadros_politica(quadros_t *self)
+{
+  return self->politica;
+}
+
+// ALOCAÇÃO {{{1
+
+int quadros_num_livres(quadros_t *self)
+{
+  return self->num_livres;
+}
+
+int quadros_num_ocupados(quadros_t *self)
+{
+  return self->num_quadros - self->primeiro_quadro - self->num_livres;
+}
+
+int quadros_livre(quadros_t *self)
+{
+  if (self->num_livres == 0) return -1;
+  return self->livres[self->num_livres - 1];
+}
+
+int quadros_escolhe_vitima(quadros_t *self, int agora)
+{
+  // sem quadro para páginas, ou com todos livres, não tem o que escolher
+  if (self->primeiro_quadro >= self->num_quadros) return -1;
+  if (quadros_num_ocupados(self) == 0) return -1;
+  self->agora = agora;
+  return self->impl->escolhe(self);
+}
+
+void quadros_ocupa(quadros_t *self, int quadro, int processo,
+                   tabpag_t *tabpag, int pagina, int agora)
+{
+  assert(quadro >= self->primeiro_quadro && quadro < self->num_quadros);
+  quadro_t *q = &self->quadros[quadro];
+  // tira da pilha de livres, colocando o último no lugar
+  if (q->pos_livre != -1) {
+    int ultimo = self->livres[--self->num_livres];
+    self->livres[q->pos_livre] = ultimo;
+    self->quadros[ultimo].pos_livre = q->pos_livre;
+    q->pos_livre = -1;
+  }
+  q->processo = processo;
+  q->tabpag = tabpag;
+  q->pagina = pagina;
+  // a página entra como acabada de acessar: a instrução que causou a falta
+  //   vai acessá-la assim que for reexecutada
+  self->agora = agora;
+  for (int i = QUADROS_PROTEGIDOS - 1; i > 0; i--) {
+    self->recentes[i] = self->recentes[i - 1];
+  }
+  self->recentes[0] = quadro;
+  q->ordem = self->proxima_ordem++;
+  q->idade = 0x80;
+  q->ultimo_uso = agora;
+}
+
+void quadros_libera(quadros_t *self, int quadro)
+{
+  assert(quadro >= self->primeiro_quadro && quadro < self->num_quadros);
+  quadro_t *q = &self->quadros[quadro];
+  if (q->pos_livre != -1) return;
+  for (int i = 0; i < QUADROS_PROTEGIDOS; i++) {
+    if (self->recentes[i] == quadro) self->recentes[i] = -1;
+  }
+  q->processo = QUADRO_LIVRE;
+  q->tabpag = NULL;
+  q->pagina = -1;
+  q->pos_livre = self->num_livres;
+  self->livres[self->num_livres++] = quadro;
+}
+
+void quadros_libera_processo(quadros_t *self, int processo)
+{
+  for (int i = self->primeiro_quadro; i < self->num_quadros; i++) {
+    quadro_t *q = &self->quadros[i];
+    if (q->processo == processo) {
+      tabpag_invalida_pagina(q->tabpag, q->pagina);
+      quadros_libera(self, i);
+    }
+  }
+}
+
+int quadros_processo(quadros_t *self, int quadro)
+{
+  return self->quadros[quadro].processo;
+}
+
+int quadros_pagina(quadros_t *self, int quadro)
+{
+  return self->quadros[quadro].pagina;
+}
+
+tabpag_t *quadros_tabpag(quadros_t *self, int quadro)
+{
+  return self->quadros[quadro].tabpag;
+}
+
+void quadros_tictac(quadros_t *self, int agora)
+{
+  self->agora = agora;
+  if (self->impl->tictac != NULL) {
+    self->impl->tictac(self);
+  }
+}
+
+// vim: foldmethod=marker
@@ -0,0 +1,111 @@
+// quadros.h
+// tabela de quadros da memória principal, com substituição de páginas
+// simulador de computador
+// so24b
+
+#ifndef QUADROS_H
+#define QUADROS_H
+
+// estrutura auxiliar para o SO gerenciar a memória principal
+// mantém, para cada quadro da memória, se ele está livre ou qual página de
+//   qual processo está nele (e em qual tabela de páginas ela está mapeada)
+// quando não tem quadro livre, escolhe um quadro para ser liberado, segundo
+//   uma política de substituição de páginas escolhida na criação da tabela
+// as políticas que precisam saber se uma página foi acessada consultam (e
+//   zeram) o bit de acesso na tabela de páginas da página
+
+#include "tabpag.h"
+#include "mmu.h"
+
+#include <stdbool.h>
+
+typedef struct quadros_t quadros_t;
+
+// políticas de substituição de páginas
+typedef enum {
+  SUBST_FIFO,            // a página carregada há mais tempo
+  SUBST_SEGUNDA_CHANCE,  // FIFO, mas uma página acessada volta para o fim da
+                         //   fila (com o bit de acesso zerado)
+  SUBST_RELOGIO,         // segunda chance com um ponteiro circular nos quadros
+  SUBST_ENVELHECIMENTO,  // aproximação de LRU: um contador por quadro, que
+                         //   recebe o bit de acesso a cada tic
+  SUBST_WSCLOCK,         // relógio, escolhendo página fora do conjunto de
+                         //   trabalho (não acessada há mais de um intervalo),
+                         //   de preferência não alterada
+  N_SUBST
+} politica_subst_t;
+
+// valor de processo para um quadro que não pertence a processo
+#define QUADRO_LIVRE -1
+
+// cria uma tabela para 'num_quadros' quadros, que usa a política 'politica'
+// os bits de acesso são zerados por meio da MMU 'mmu'
+// os quadros anteriores a 'primeiro_quadro' são reservados (para o
+//   hardware e o SO), nunca são alocados nem escolhidos para substituição
+// se 'primeiro_quadro' não for menor que 'num_quadros', todos são reservados
+// mata o programa em caso de erro (malloc)
+quadros_t *quadros_cria(mmu_t *mmu, int num_quadros, int primeiro_quadro,
+                        politica_subst_t politica);
+
+// destrói a tabela
+void quadros_destroi(quadros_t *self);
+
+// retorna o nome da política
+char *quadros_nome_politica(politica_subst_t politica);
+
+// coloca em '*ppolitica' a política de nome 'nome' (ver quadros_nome_politica)
+// retorna false se não existir política com esse nome
+bool quadros_politica_por_nome(char *nome, politica_subst_t *ppolitica);
+
+// retorna a política usada pela tabela
+politica_subst_t quadros_politica(quadros_t *self);
+
+// retorna o número de quadros livres
+int quadros_num_livres(quadros_t *self);
+
+// retorna o número de quadros ocupados (sem contar os reservados)
+int quadros_num_ocupados(quadros_t *self);
+
+// retorna um quadro livre, ou -1 se não tiver
+// o quadro continua livre até ser ocupado com quadros_ocupa
+int quadros_livre(quadros_t *self);
+
+// escolhe, segundo a política, um quadro ocupado para ser liberado
+// 'agora' é o tempo atual
+// os quadros ocupados pelas duas últimas faltas só são escolhidos se forem
+//   os únicos ocupados (as páginas deles podem ser necessárias para a
+//   instrução que causou a falta, que ainda não completou)
+// retorna -1 se não tiver quadro ocupado
+// o quadro continua ocupado -- quem chama deve salvar a página se necessário,
+//   invalidá-la na tabela de páginas e liberar o quadro com quadros_libera
+int quadros_escolhe_vitima(quadros_t *self, int agora);
+
+// registra que a página 'pagina' do processo 'processo', mapeada na tabela
+//   'tabpag', foi colocada no quadro 'quadro' no tempo 'agora'
+// a página é considerada acessada nesse tempo
+void quadros_ocupa(quadros_t *self, int quadro, int processo,
+                   tabpag_t *tabpag, int pagina, int agora);
+
+// registra que o quadro 'quadro' está livre
+void quadros_libera(quadros_t *self, int quadro);
+
+// libera todos os quadros do processo 'processo', invalidando as páginas
+//   correspondentes nas suas tabelas de páginas
+void quadros_libera_processo(quadros_t *self, int processo);
+
+// retorna o processo que ocupa o quadro, ou QUADRO_LIVRE
+int quadros_processo(quadros_t *self, int quadro);
+
+// retorna a página que está no quadro (se não estiver livre)
+int quadros_pagina(quadros_t *self, int quadro);
+
+// retorna a tabela de páginas onde a página do quadro está mapeada (NULL se
+//   o quadro estiver livre)
+tabpag_t *quadros_tabpag(quadros_t *self, int quadro);
+
+// registra a passagem do tempo; 'agora' é o tempo atual
+// deve ser chamada periodicamente (a cada interrupção do relógio), é quando
+//   as políticas que acompanham o uso das páginas consultam os bits de acesso
+void quadros_tictac(quadros_t *self, int agora);
+
+#endif // QUADROS_H
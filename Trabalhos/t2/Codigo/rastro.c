@@ -0,0 +1,191 @@
+// rastro.c
+// rastro binário de eventos da simulação
+// simulador de computador
+// so24b
+
+// INCLUDES {{{1
+
+#include "rastro.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <assert.h>
+
+// CONSTANTES {{{1
+
+// número de eventos no buffer (potência de 2)
+#define RASTRO_TAM 65536
+// a thread de gravação é acordada a cada tantos eventos registrados
+#define RASTRO_LOTE (RASTRO_TAM / 4)
+
+// DECLARAÇÃO {{{1
+
+// o rastro é único, como a console; o buffer é circular, com um produtor (a
+//   simulação, que avança 'escritos') e um consumidor (a thread de gravação,
+//   que avança 'gravados'); o mutex e as condições são usados só para uma
+//   esperar pela outra
+static struct {
+  FILE *arq;
+  relogio_t *relogio;
+  rastro_evento_t buf[RASTRO_TAM];
+  atomic_ulong escritos;
+  atomic_ulong gravados;
+  bool terminando;
+  pthread_t gravador;
+  pthread_mutex_t mutex;
+  pthread_cond_t tem_eventos;
+  pthread_cond_t tem_espaco;
+} rastro;
+
+unsigned rastro_categorias = 0;
+
+// GRAVAÇÃO {{{1
+
+// grava os eventos de 'gravados' até 'escritos' no arquivo
+static void rastro_grava_pendentes(void)
+{
+  unsigned long ini = atomic_load_explicit(&rastro.gravados,
+                                           memory_order_relaxed);
+  unsigned long fim = atomic_load_explicit(&rastro.escritos,
+                                           memory_order_acquire);
+  while (ini != fim) {
+    // até o fim do buffer ou dos eventos, o que vier primeiro
+    int pos = ini % RASTRO_TAM;
+    unsigned long n = fim - ini;
+    if (n > RASTRO_TAM - pos) n = RASTRO_TAM - pos;
+    fwrite(&rastro.buf[pos], sizeof(rastro_evento_t), n, rastro.arq);
+    ini += n;
+  }
+  pthread_mutex_lock(&rastro.mutex);
+  atomic_store_explicit(&rastro.gravados, fim, memory_order_release);
+  pthread_cond_signal(&rastro.tem_espaco);
+  pthread_mutex_unlock(&rastro.mutex);
+}
+
+// laço da thread de gravação: espera ter eventos, grava, até terminar
+static void *rastro_gravador(void *arg)
+{
+  for (;;) {
+    pthread_mutex_lock(&rastro.mutex);
+    while (!rastro.terminando
+           && atomic_load(&rastro.escritos) == atomic_load(&rastro.gravados)) {
+      pthread_cond_wait(&rastro.tem_eventos, &rastro.mutex);
+    }
+    bool terminando = rastro.terminando;
+    pthread_mutex_unlock(&rastro.mutex);
+    rastro_grava_pendentes();
+    if (terminando) break;
+  }
+  return NULL;
+}
+
+// acorda a thread de gravação
+static void rastro_acorda_gravador(void)
+{
+  pthread_mutex_lock(&rastro.mutex);
+  pthread_cond_signal(&rastro.tem_eventos);
+  pthread_mutex_unlock(&rastro.mutex);
+}
+
+// INÍCIO E FIM {{{1
+
+bool rastro_inicia(char *nome, unsigned categorias, relogio_t *relogio)
+{
+  assert(rastro.arq == NULL);
+  rastro.arq = fopen(nome, "wb");
+  if (rastro.arq == NULL) return false;
+  fwrite(RASTRO_ASSINATURA, 1, strlen(RASTRO_ASSINATURA), rastro.arq);
+  rastro.relogio = relogio;
+  atomic_init(&rastro.escritos, 0);
+  atomic_init(&rastro.gravados, 0);
+  rastro.terminando = false;
+  pthread_mutex_init(&rastro.mutex, NULL);
+  pthread_cond_init(&rastro.tem_eventos, NULL);
+  pthread_cond_init(&rastro.tem_espaco, NULL);
+  int r = pthread_create(&rastro.gravador, NULL, rastro_gravador, NULL);
+  assert(r == 0);
+  rastro_categorias = categorias & RASTRO_COMPILADAS;
+  return true;
+}
+
+void rastro_termina(void)
+{
+  if (rastro.arq == NULL) return;
+  rastro_categorias = 0;
+  pthread_mutex_lock(&rastro.mutex);
+  rastro.terminando = true;
+  pthread_cond_signal(&rastro.tem_eventos);
+  pthread_mutex_unlock(&rastro.mutex);
+  pthread_join(rastro.gravador, NULL);
+  pthread_cond_destroy(&rastro.tem_espaco);
+  pthread_cond_destroy(&rastro.tem_eventos);
+  pthread_mutex_destroy(&rastro.mutex);
+  fclose(rastro.arq);
+  rastro.arq = NULL;
+}
+
+// REGISTRO {{{1
+
+void rastro_registra(rastro_tipo_t tipo, int a, int b, int c)
+{
+  unsigned long escritos = atomic_load_explicit(&rastro.escritos,
+                                                memory_order_relaxed);
+  // se o buffer está cheio, espera a gravação liberar espaço
+  if (escritos - atomic_load_explicit(&rastro.gravados, memory_order_acquire)
+      == RASTRO_TAM) {
+    pthread_mutex_lock(&rastro.mutex);
+    pthread_cond_signal(&rastro.tem_eventos);
+    while (escritos - atomic_load(&rastro.gravados) == RASTRO_TAM) {
+      pthread_cond_wait(&rastro.tem_espaco, &rastro.mutex);
+    }
+    pthread_mutex_unlock(&rastro.mutex);
+  }
+  rastro_evento_t *ev = &rastro.buf[escritos % RASTRO_TAM];
+  ev->instante = relogio_agora(rastro.relogio);
+  ev->tipo = tipo;
+  ev->arg[0] = a;
+  ev->arg[1] = b;
+  ev->arg[2] = c;
+  atomic_store_explicit(&rastro.escritos, escritos + 1, memory_order_release);
+  if ((escritos + 1) % RASTRO_LOTE == 0) rastro_acorda_gravador();
+}
+
+// CATEGORIAS {{{1
+
+static struct {
+  char *nome;
+  unsigned categorias;
+} nomes_categorias[] = {
+  { "instrucao", RASTRO_INSTRUCAO },
+  { "irq",       RASTRO_IRQ       },
+  { "chamada",   RASTRO_CHAMADA   },
+  { "processo",  RASTRO_PROCESSO  },
+  { "memoria",   RASTRO_MEMORIA   },
+  { "todas",     RASTRO_TODAS     },
+};
+#define N_NOMES (sizeof(nomes_categorias) / sizeof(nomes_categorias[0]))
+
+bool rastro_categorias_por_nome(char *nomes, unsigned *pcategorias)
+{
+  unsigned categorias = 0;
+  char *p = nomes;
+  while (*p != '\0') {
+    int tam = strcspn(p, ",");
+    int i;
+    for (i = 0; i < N_NOMES; i++) {
+      if (strlen(nomes_categorias[i].nome) == tam
+          && strncmp(p, nomes_categorias[i].nome, tam) == 0) break;
+    }
+    if (i == N_NOMES) return false;
+    categorias |= nomes_categorias[i].categorias;
+    p += tam;
+    if (*p == ',') p++;
+  }
+  *pcategorias = categorias;
+  return true;
+}
+
+// vim: foldmethod=marker
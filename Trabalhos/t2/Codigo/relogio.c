@@ -12,10 +12,14 @@
 struct relogio_t {
   // que horas são (em tics)
   int agora;
-  // quanto tempo até gerar uma interrupção
-  int t_ate_interrupcao;
+  // em que instante gerar uma interrupção, 0 se não tem interrupção
+  //   programada (o timer é de disparo único: a cada tictac só se compara
+  //   com o instante, não tem contagem regressiva)
+  int instante_interrupcao;
   // 1 se está gerando interrupção, 0 se não
   int interrupcao;
+  // controlador onde a interrupção é pedida (NULL se não pede)
+  pic_t *pic;
 };
 
 relogio_t *relogio_cria(void)
@@ -25,6 +29,9 @@ relogio_t *relogio_cria(void)
   assert(self != NULL);
 
   self->agora = 0;
+  self->instante_interrupcao = 0;
+  self->interrupcao = 0;
+  self->pic = NULL;
 
   return self;
 }
@@ -34,15 +41,48 @@ void relogio_destroi(relogio_t *self)
   free(self);
 }
 
+void relogio_define_pic(relogio_t *self, pic_t *pic)
+{
+  self->pic = pic;
+}
+
+// liga ou desliga o pedido de interrupção, também no controlador
+static void relogio_muda_interrupcao(relogio_t *self, int interrupcao)
+{
+  self->interrupcao = interrupcao;
+  if (self->pic == NULL) return;
+  if (interrupcao != 0) {
+    pic_pede(self->pic, IRQ_RELOGIO, 0);
+  } else {
+    pic_retira(self->pic, IRQ_RELOGIO, 0);
+  }
+}
+
 void relogio_tictac(relogio_t *self)
 {
-  self->agora++;
+  relogio_avanca(self, 1);
+}
+
+void relogio_avanca(relogio_t *self, int n)
+{
+  self->agora += n;
   // vê se tem que gerar interrupção
-  if (self->t_ate_interrupcao != 0) {
-    self->t_ate_interrupcao--;
-    if (self->t_ate_interrupcao == 0) {
-      self->interrupcao = 1;
-    }
+  if (self->instante_interrupcao != 0
+      && self->agora >= self->instante_interrupcao) {
+    self->instante_interrupcao = 0;
+    relogio_muda_interrupcao(self, 1);
+  }
+}
+
+// programa a interrupção para o instante 'instante' (0 desprograma); se o
+//   instante já passou, a interrupção é pedida agora
+static void relogio_programa(relogio_t *self, int instante)
+{
+  if (instante != 0 && instante <= self->agora) {
+    self->instante_interrupcao = 0;
+    relogio_muda_interrupcao(self, 1);
+  } else {
+    self->instante_interrupcao = instante;
   }
 }
 
@@ -63,11 +103,18 @@ err_t relogio_leitura(void *disp, int id, int *pvalor)
       *pvalor = clock()/(CLOCKS_PER_SEC/1000);
       break;
     case 2:
-      *pvalor = self->t_ate_interrupcao;
+      if (self->instante_interrupcao == 0) {
+        *pvalor = 0;
+      } else {
+        *pvalor = self->instante_interrupcao - self->agora;
+      }
       break;
     case 3:
       *pvalor = self->interrupcao;
       break;
+    case 4:
+      *pvalor = self->instante_interrupcao;
+      break;
     default: 
       err = ERR_END_INV;
   }
@@ -80,10 +127,13 @@ err_t relogio_escrita(void *disp, int id, int pvalor)
   err_t err = ERR_OK;
   switch (id) {
     case 2:
-      self->t_ate_interrupcao = pvalor;
+      relogio_programa(self, (pvalor <= 0) ? 0 : self->agora + pvalor);
       break;
     case 3:
-      self->interrupcao = (pvalor == 0) ? 0 : 1;
+      relogio_muda_interrupcao(self, (pvalor == 0) ? 0 : 1);
+      break;
+    case 4:
+      relogio_programa(self, (pvalor < 0) ? 0 : pvalor);
       break;
     default: 
       err = ERR_END_INV;
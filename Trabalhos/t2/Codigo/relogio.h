@@ -8,8 +8,12 @@
 
 // simulador do relógio
 // registra a passagem do tempo
+// o timer é de disparo único: é programado com o instante (ou o tempo até
+//   ele) em que deve gerar uma interrupção, gera uma só e fica desprogramado
+//   até ser programado de novo
 
 #include "err.h"
+#include "pic.h"
 
 typedef struct relogio_t relogio_t;
 
@@ -20,10 +24,19 @@ relogio_t *relogio_cria(void);
 // nenhuma outra operação pode ser realizada no relógio após esta chamada
 void relogio_destroi(relogio_t *self);
 
+// faz o relógio pedir a interrupção do timer (IRQ_RELOGIO) ao controlador
+//   'pic', além de indicá-la no seu registrador '3'
+void relogio_define_pic(relogio_t *self, pic_t *pic);
+
 // registra a passagem de uma unidade de tempo
 // esta função é chamada pelo controlador após a execução de cada instrução
 void relogio_tictac(relogio_t *self);
 
+// registra a passagem de n unidades de tempo de uma vez
+// equivale a n chamadas a relogio_tictac, desde que n não passe do momento
+//   de gerar a interrupção (se passar, a interrupção é gerada atrasada)
+void relogio_avanca(relogio_t *self, int n);
+
 // retorna a hora atual do sistema, em unidades de tempo
 int relogio_agora(relogio_t *self);
 
@@ -31,7 +44,11 @@ int relogio_agora(relogio_t *self);
 //   '0' para ler o relógio local (contador de instruções)
 //   '1' para ler o tempo de CPU consumido pelo simulador (em ms)
 //   '2' para ler ou escrever em quanto tempo uma interrupção será gerada
+//       (0 se não tem interrupção programada; escrever 0 desprograma)
 //   '3' para ler ou escrever se uma interrupção está sendo pedida
+//   '4' para ler ou escrever o instante (no relógio local) em que uma
+//       interrupção será gerada (0 se não tem; escrever um instante que já
+//       passou pede a interrupção imediatamente, escrever 0 desprograma)
 // Devem seguir o protocolo f_leitura_t e f_escrita_t declarados em es.h
 err_t relogio_leitura(void *disp, int id, int *pvalor);
 err_t relogio_escrita(void *disp, int id, int pvalor);
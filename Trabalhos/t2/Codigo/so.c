@@ -9,26 +9,29 @@
 #include "irq.h"
 #include "programa.h"
 #include "tabpag.h"
+#include "quadros.h"
+#include "metricas.h"
+#include "disco.h"
+#include "rastro.h"
 
 #include <stdlib.h>
 #include <stdbool.h>
 #include <assert.h>
 
 // CONSTANTES E TIPOS {{{1
-// intervalo entre interrupções do relógio
+// intervalo entre interrupções do relógio, enquanto tem programa executando
 #define INTERVALO_INTERRUPCAO 50   // em instruções executadas
 
-// Não tem processos nem memória virtual, mas é preciso usar a paginação,
-//   pelo menos para implementar relocação, já que os programas estão sendo
-//   todos montados para serem executados no endereço 0 e o endereço 0
-//   físico é usado pelo hardware nas interrupções.
-// Os programas estão sendo carregados no início de um quadro, e usam quantos
-//   quadros forem necessárias. Para isso a variável quadro_livre contém
-//   o número do primeiro quadro da memória principal que ainda não foi usado.
-//   Na carga do processo, a tabela de páginas (deveria ter uma por processo,
-//   mas não tem processo) é alterada para que o endereço virtual 0 resulte
-//   no quadro onde o programa foi carregado. Com isso, o programa carregado
-//   é acessível, mas o acesso ao anterior é perdido.
+// Não tem processos, mas tem memória virtual com paginação por demanda,
+//   já que os programas estão sendo todos montados para serem executados no
+//   endereço 0 e o endereço 0 físico é usado pelo hardware nas interrupções.
+// Os programas são carregados na memória secundária (a memória do disco), e
+//   a tabela de páginas (deveria ter uma por processo, mas não tem processo)
+//   começa sem nenhuma página. Cada falta de página escolhe um quadro (um
+//   livre ou um escolhido pela política de substituição) e pede ao disco
+//   para trazer a página; o programa espera até o disco terminar. Na carga
+//   de um programa, os quadros do anterior são liberados, e o acesso a ele
+//   é perdido.
 
 // t2: a interface de algumas funções que manipulam memória teve que ser alterada,
 //   para incluir o processo ao qual elas se referem. Para isso, precisa de um
@@ -48,10 +51,40 @@ struct so_t {
   bool erro_interno;
   // t1: tabela de processos, processo corrente, pendências, etc
 
-  // primeiro quadro da memória que está livre (quadros anteriores estão ocupados)
-  // t2: com memória virtual, o controle de memória livre e ocupada é mais
-  //     completo que isso
-  int quadro_livre;
+  // tabela com o dono de cada quadro da memória principal, que escolhe
+  //   o quadro a liberar quando não tem quadro livre
+  quadros_t *quadros;
+  // memória secundária, onde ficam as páginas dos programas
+  // é alocada de forma contígua, sem reuso: cada programa é carregado a
+  //   partir do próximo bloco (do tamanho de uma página) livre
+  mem_t *mem_secundaria;
+  int bloco_livre;
+  // o programa em execução, o bloco da memória secundária onde está a sua
+  //   página 0 e o número de páginas que ele tem
+  // t2: com processos, isto fica no descritor de cada processo
+  processo_t processo_corrente;
+  int bloco_programa;
+  int num_paginas_programa;
+  // enquanto o programa espera o disco trazer uma página, o estado da CPU
+  //   fica aqui, e 'pedido_esperado' tem a identificação do pedido ao disco
+  //   (0 se não estiver esperando)
+  // t2: com processos, o processo fica bloqueado e outro pode executar
+  int estado_salvo[IRQ_TAM_ESTADO];
+  int pedido_esperado;
+  // da mesma forma, enquanto o programa espera o terminal para ler ou
+  //   escrever, o estado fica em 'estado_salvo', e 'dispositivo_esperado'
+  //   tem o dispositivo do terminal (-1 se não estiver esperando); a chamada
+  //   de sistema é refeita quando o terminal pedir interrupção
+  int dispositivo_esperado;
+  // quando começou a espera pela página (para as métricas)
+  int inicio_espera;
+  // o timer é de disparo único; 'proximo_tictac' é o instante em que a
+  //   substituição de páginas deve ser avisada da passagem do tempo, e
+  //   'alarme' o instante para o qual o timer está programado (0 se desligado)
+  int proximo_tictac;
+  int alarme;
+  // medidas do desempenho da memória virtual, gravadas no fim da execução
+  metricas_t *metricas;
   // uma tabela de páginas para poder usar a MMU
   // t2: com processos, não tem esta tabela global, tem que ter uma para
   //     cada processo
@@ -70,12 +103,30 @@ static int so_carrega_programa(so_t *self, processo_t processo,
 // copia para str da memória do processo, até copiar um 0 (retorna true) ou tam bytes
 static bool so_copia_str_do_processo(so_t *self, int tam, char str[tam],
                                      int end_virt, processo_t processo);
+// traz para a memória principal a página que contém 'end_virt'; retorna false
+//   se o endereço não pertence ao programa
+static bool so_trata_falta_de_pagina(so_t *self, int end_virt);
+// retorna o número de instruções executadas desde o início
+static int so_agora(so_t *self);
+// registra nas métricas o número atual de quadros ocupados
+static void so_registra_ocupacao(so_t *self);
 
 // CRIAÇÃO {{{1
 
+// o primeiro quadro depois dos que contêm os endereços reservados (até 99)
+static int so_primeiro_quadro_usuario(int tam_pagina)
+{
+  return 99 / tam_pagina + 1;
+}
+
+int so_quadros_usuario(int tam_mem, int tam_pagina)
+{
+  return tam_mem / tam_pagina - so_primeiro_quadro_usuario(tam_pagina);
+}
+
 
-so_t *so_cria(cpu_t *cpu, mem_t *mem, mmu_t *mmu,
-              es_t *es, console_t *console)
+so_t *so_cria(cpu_t *cpu, mem_t *mem, mmu_t *mmu, mem_t *mem_secundaria,
+              es_t *es, console_t *console, politica_subst_t politica)
 {
   so_t *self = malloc(sizeof(*self));
   assert(self != NULL);
@@ -86,6 +137,16 @@ so_t *so_cria(cpu_t *cpu, mem_t *mem, mmu_t *mmu,
   self->es = es;
   self->console = console;
   self->erro_interno = false;
+  self->mem_secundaria = mem_secundaria;
+  self->bloco_livre = 0;
+  self->processo_corrente = NENHUM_PROCESSO;
+  self->bloco_programa = 0;
+  self->num_paginas_programa = 0;
+  self->pedido_esperado = 0;
+  self->dispositivo_esperado = -1;
+  self->inicio_espera = 0;
+  self->proximo_tictac = INTERVALO_INTERRUPCAO;
+  self->alarme = 0;
 
   // quando a CPU executar uma instrução CHAMAC, deve chamar a função
   //   so_trata_interrupcao, com primeiro argumento um ptr para o SO
@@ -101,32 +162,48 @@ so_t *so_cria(cpu_t *cpu, mem_t *mem, mmu_t *mmu,
   //   foi definido acima)
   int ender = so_carrega_programa(self, NENHUM_PROCESSO, "trata_int.maq");
   if (ender != IRQ_END_TRATADOR) {
-    console_printf("SO: problema na carga do programa de tratamento de interrupção");
+    console_log(NIVEL_ERRO, "SO: problema na carga do programa de tratamento de interrupção");
     self->erro_interno = true;
   }
 
-  // programa o relógio para gerar uma interrupção após INTERVALO_INTERRUPCAO
-  if (es_escreve(self->es, D_RELOGIO_TIMER, INTERVALO_INTERRUPCAO) != ERR_OK) {
-    console_printf("SO: problema na programação do timer");
-    self->erro_interno = true;
-  }
+  // o relógio é programado no despacho (so_programa_relogio)
 
   // inicializa a tabela de páginas global, e entrega ela para a MMU
   // t2: com processos, essa tabela não existiria, teria uma por processo, que
   //     deve ser colocada na MMU quando o processo é despachado para execução
   self->tabpag_global = tabpag_cria();
   mmu_define_tabpag(self->mmu, self->tabpag_global);
-  // define o primeiro quadro livre de memória como o seguinte àquele que
-  //   contém o endereço 99 (as 100 primeiras posições de memória (pelo menos)
+  // cria a tabela de quadros; os quadros até o que contém o endereço 99
+  //   são reservados (as 100 primeiras posições de memória (pelo menos)
   //   não vão ser usadas por programas de usuário)
-  // t2: o controle de memória livre deve ser mais aprimorado que isso  
-  self->quadro_livre = 99 / TAM_PAGINA + 1;
+  int tam_pagina = mmu_tam_pagina(self->mmu);
+  self->quadros = quadros_cria(self->mmu, mem_tam(self->mem) / tam_pagina,
+                               so_primeiro_quadro_usuario(tam_pagina),
+                               politica);
+  console_log(NIVEL_INFO, "SO: substituição de páginas: %s",
+              quadros_nome_politica(politica));
+
+  self->metricas = metricas_cria();
+  metricas_define_config(self->metricas, mem_tam(self->mem), tam_pagina,
+                         mem_tam(self->mem) / tam_pagina,
+                         quadros_nome_politica(politica));
+  so_registra_ocupacao(self);
   return self;
 }
 
 void so_destroi(so_t *self)
 {
+  long acertos, falhas;
+  mmu_contadores_tlb(self->mmu, &acertos, &falhas);
+  console_log(NIVEL_INFO, "SO: TLB: %ld acertos, %ld falhas", acertos, falhas);
+  metricas_tlb(self->metricas, acertos, falhas);
+  if (!metricas_grava(self->metricas, "metricas_paginacao", so_agora(self))) {
+    console_log(NIVEL_ERRO, "SO: problema na gravação das métricas de paginação");
+  }
+  metricas_destroi(self->metricas);
   cpu_define_chamaC(self->cpu, NULL, NULL);
+  quadros_destroi(self->quadros);
+  tabpag_destroi(self->tabpag_global);
   free(self);
 }
 
@@ -136,9 +213,11 @@ void so_destroi(so_t *self)
 // funções auxiliares para o tratamento de interrupção
 static void so_salva_estado_da_cpu(so_t *self);
 static void so_trata_irq(so_t *self, int irq);
+static void so_trata_irqs_pendentes(so_t *self, int irq_atendida);
 static void so_trata_pendencias(so_t *self);
 static void so_escalona(so_t *self);
 static int so_despacha(so_t *self);
+static void so_programa_relogio(so_t *self, bool executando);
 
 // função a ser chamada pela CPU quando executa a instrução CHAMAC, no tratador de
 //   interrupção em assembly
@@ -159,11 +238,13 @@ static int so_trata_interrupcao(void *argC, int reg_A)
   so_t *self = argC;
   irq_t irq = reg_A;
   // esse print polui bastante, recomendo tirar quando estiver com mais confiança
-  console_printf("SO: recebi IRQ %d (%s)", irq, irq_nome(irq));
+  console_log(NIVEL_DEPURACAO, "SO: recebi IRQ %d (%s)", irq, irq_nome(irq));
   // salva o estado da cpu no descritor do processo que foi interrompido
   so_salva_estado_da_cpu(self);
   // faz o atendimento da interrupção
   so_trata_irq(self, irq);
+  // e das outras que estiverem pendentes, sem sair do SO
+  so_trata_irqs_pendentes(self, irq);
   // faz o processamento independente da interrupção
   so_trata_pendencias(self);
   // escolhe o próximo processo a executar
@@ -180,6 +261,23 @@ static void so_salva_estado_da_cpu(so_t *self)
   // se não houver processo corrente, não faz nada
 }
 
+// atende, em ordem de prioridade, as interrupções de E/S que estiverem
+//   pendentes no controlador de interrupções, na mesma entrada no SO (em vez
+//   de uma entrada para cada)
+// cada linha é atendida no máximo uma vez por entrada (incluindo a que
+//   causou a entrada, 'irq_atendida'); se pedir de novo, vai causar outra
+static void so_trata_irqs_pendentes(so_t *self, int irq_atendida)
+{
+  unsigned atendidas = 1u << irq_atendida;
+  int irq;
+  while (es_le(self->es, D_PIC_PROXIMA, &irq) == ERR_OK && irq != -1
+         && (atendidas & (1u << irq)) == 0) {
+    console_log(NIVEL_DEPURACAO, "SO: IRQ %d (%s) pendente", irq, irq_nome(irq));
+    atendidas |= 1u << irq;
+    so_trata_irq(self, irq);
+  }
+}
+
 static void so_trata_pendencias(so_t *self)
 {
   // t1: realiza ações que não são diretamente ligadas com a interrupção que
@@ -204,8 +302,40 @@ static int so_despacha(so_t *self)
   // o valor retornado será o valor de retorno de CHAMAC
   // passa o processador para modo usuário
   mem_escreve(self->mem, IRQ_END_erro, ERR_OK);
-  if (self->erro_interno) return 1;
-  else return 0;
+  // o programa está esperando o disco ou um terminal, a CPU fica parada até
+  //   a interrupção do dispositivo
+  bool parada = self->erro_interno || self->pedido_esperado != 0
+                || self->dispositivo_esperado != -1;
+  so_programa_relogio(self, !parada);
+  if (parada) return 1;
+  RASTRO(RASTRO_PROCESSO, EV_DESPACHO, self->processo_corrente, 0, 0);
+  return 0;
+}
+
+// programa o timer para o próximo instante em que o SO precisa dele
+// só é preciso enquanto tem programa executando (para a substituição de
+//   páginas acompanhar o uso); com a CPU parada o timer fica desligado, e ela
+//   só é acordada pela interrupção do disco ou do terminal, sem passar por
+//   interrupções do relógio que não teriam nada para fazer
+// o tempo parado não conta: se o instante passou durante a espera, o
+//   próximo é um intervalo depois da volta
+static void so_programa_relogio(so_t *self, bool executando)
+{
+  int instante = 0;
+  if (executando) {
+    int agora = so_agora(self);
+    if (self->proximo_tictac <= agora) {
+      self->proximo_tictac = agora + INTERVALO_INTERRUPCAO;
+    }
+    instante = self->proximo_tictac;
+  }
+  if (instante == self->alarme) return;
+  if (es_escreve(self->es, D_RELOGIO_ALARME, instante) != ERR_OK) {
+    console_log(NIVEL_ERRO, "SO: problema na programação do timer");
+    self->erro_interno = true;
+    return;
+  }
+  self->alarme = instante;
 }
 
 // TRATAMENTO DE UMA IRQ {{{1
@@ -215,6 +345,9 @@ static void so_trata_irq_reset(so_t *self);
 static void so_trata_irq_chamada_sistema(so_t *self);
 static void so_trata_irq_err_cpu(so_t *self);
 static void so_trata_irq_relogio(so_t *self);
+static void so_trata_irq_disco(so_t *self);
+static void so_trata_irq_terminal(so_t *self, dispositivo_id_t origens,
+                                  dispositivo_id_t dispositivo);
 static void so_trata_irq_desconhecida(so_t *self, int irq);
 
 static void so_trata_irq(so_t *self, int irq)
@@ -233,6 +366,15 @@ static void so_trata_irq(so_t *self, int irq)
     case IRQ_RELOGIO:
       so_trata_irq_relogio(self);
       break;
+    case IRQ_DISCO:
+      so_trata_irq_disco(self);
+      break;
+    case IRQ_TECLADO:
+      so_trata_irq_terminal(self, D_PIC_ORIGEM_TECLADO, D_TERM_A_TECLADO);
+      break;
+    case IRQ_TELA:
+      so_trata_irq_terminal(self, D_PIC_ORIGEM_TELA, D_TERM_A_TELA);
+      break;
     default:
       so_trata_irq_desconhecida(self, irq);
   }
@@ -253,7 +395,7 @@ static void so_trata_irq_reset(so_t *self)
   processo_t processo = 1; // deveria inicializar um processo...
   int ender = so_carrega_programa(self, processo, "init.maq");
   if (ender != 0) {
-    console_printf("SO: problema na carga do programa inicial");
+    console_log(NIVEL_ERRO, "SO: problema na carga do programa inicial");
     self->erro_interno = true;
     return;
   }
@@ -277,39 +419,105 @@ static void so_trata_irq_err_cpu(so_t *self)
   //   (em geral, matando o processo)
   mem_le(self->mem, IRQ_END_erro, &err_int);
   err_t err = err_int;
-  console_printf("SO: IRQ não tratada -- erro na CPU: %s", err_nome(err));
+  if (err == ERR_PAG_AUSENTE) {
+    // o endereço que causou a falta está no complemento
+    int end_virt;
+    mem_le(self->mem, IRQ_END_complemento, &end_virt);
+    if (so_trata_falta_de_pagina(self, end_virt)) return;
+  }
+  console_log(NIVEL_ERRO, "SO: IRQ não tratada -- erro na CPU: %s", err_nome(err));
   self->erro_interno = true;
 }
 
 // interrupção gerada quando o timer expira
 static void so_trata_irq_relogio(so_t *self)
 {
-  // rearma o interruptor do relógio e reinicializa o timer para a próxima interrupção
-  err_t e1, e2;
-  e1 = es_escreve(self->es, D_RELOGIO_INTERRUPCAO, 0); // desliga o sinalizador de interrupção
-  e2 = es_escreve(self->es, D_RELOGIO_TIMER, INTERVALO_INTERRUPCAO);
-  if (e1 != ERR_OK || e2 != ERR_OK) {
-    console_printf("SO: problema da reinicialização do timer");
+  // desliga o sinalizador de interrupção; o timer se desprogramou ao gerar
+  //   a interrupção, e é programado para o próximo instante no despacho
+  if (es_escreve(self->es, D_RELOGIO_INTERRUPCAO, 0) != ERR_OK) {
+    console_log(NIVEL_ERRO, "SO: problema da reinicialização do timer");
     self->erro_interno = true;
   }
+  self->alarme = 0;
+  // a política de substituição de páginas acompanha o uso das páginas
+  int agora = so_agora(self);
+  quadros_tictac(self->quadros, agora);
+  self->proximo_tictac = agora + INTERVALO_INTERRUPCAO;
   // t1: deveria tratar a interrupção
   //   por exemplo, decrementa o quantum do processo corrente, quando se tem
   //   um escalonador com quantum
-  console_printf("SO: interrupção do relógio (não tratada)");
+  console_log(NIVEL_DETALHE, "SO: interrupção do relógio (não tratada)");
+}
+
+// interrupção gerada quando o disco termina uma ou mais transferências
+static void so_trata_irq_disco(so_t *self)
+{
+  // desliga o sinalizador de interrupção antes de pegar os pedidos atendidos,
+  //   para não perder um que termine depois
+  if (es_escreve(self->es, D_DISCO_INTERRUPCAO, 0) != ERR_OK) {
+    console_log(NIVEL_ERRO, "SO: problema no acesso ao disco");
+    self->erro_interno = true;
+    return;
+  }
+  int id;
+  while (es_le(self->es, D_DISCO_ATENDIDO, &id) == ERR_OK && id != 0) {
+    if (id == self->pedido_esperado) {
+      // a página chegou, o programa pode continuar, reexecutando a instrução
+      //   que causou a falta
+      // t2: com processos, desbloqueia o processo que esperava a página
+      mem_escreve_bloco(self->mem, IRQ_END_PC, self->estado_salvo,
+                        IRQ_TAM_ESTADO);
+      self->pedido_esperado = 0;
+      metricas_pagina_trazida(self->metricas, self->processo_corrente,
+                              so_agora(self) - self->inicio_espera);
+    }
+  }
+}
+
+// funções auxiliares para as chamadas de E/S, que são refeitas quando o
+//   terminal esperado pede interrupção
+static void so_chamada_le(so_t *self);
+static void so_chamada_escr(so_t *self);
+
+// interrupção gerada quando chega entrada em um terminal que estava sem, ou
+//   quando a saída de um terminal volta a aceitar caracteres
+// 'origens' é o dispositivo do controlador de interrupções que informa (e
+//   reconhece) os terminais que pediram; se o programa espera por
+//   'dispositivo' e o terminal dele pediu, o estado do programa é recuperado
+//   e a chamada de sistema é refeita
+static void so_trata_irq_terminal(so_t *self, dispositivo_id_t origens,
+                                  dispositivo_id_t dispositivo)
+{
+  int terminais;
+  if (es_le(self->es, origens, &terminais) != ERR_OK) {
+    console_log(NIVEL_ERRO, "SO: problema no acesso ao controlador de interrupções");
+    self->erro_interno = true;
+    return;
+  }
+  // só o terminal A (origem 0) é usado
+  // t1: com processos, atende os processos bloqueados em cada terminal que
+  //   pediu
+  if ((terminais & 1) == 0 || self->dispositivo_esperado != dispositivo) return;
+  mem_escreve_bloco(self->mem, IRQ_END_PC, self->estado_salvo, IRQ_TAM_ESTADO);
+  self->dispositivo_esperado = -1;
+  if (dispositivo == D_TERM_A_TECLADO) {
+    so_chamada_le(self);
+  } else {
+    so_chamada_escr(self);
+  }
 }
 
 // foi gerada uma interrupção para a qual o SO não está preparado
 static void so_trata_irq_desconhecida(so_t *self, int irq)
 {
-  console_printf("SO: não sei tratar IRQ %d (%s)", irq, irq_nome(irq));
+  console_log(NIVEL_ERRO, "SO: não sei tratar IRQ %d (%s)", irq, irq_nome(irq));
   self->erro_interno = true;
 }
 
 // CHAMADAS DE SISTEMA {{{1
 
 // funções auxiliares para cada chamada de sistema
-static void so_chamada_le(so_t *self);
-static void so_chamada_escr(so_t *self);
+static void so_espera_terminal(so_t *self, dispositivo_id_t dispositivo);
 static void so_chamada_cria_proc(so_t *self);
 static void so_chamada_mata_proc(so_t *self);
 static void so_chamada_espera_proc(so_t *self);
@@ -320,11 +528,12 @@ static void so_trata_irq_chamada_sistema(so_t *self)
   // t1: com processos, o reg A tá no descritor do processo corrente
   int id_chamada;
   if (mem_le(self->mem, IRQ_END_A, &id_chamada) != ERR_OK) {
-    console_printf("SO: erro no acesso ao id da chamada de sistema");
+    console_log(NIVEL_ERRO, "SO: erro no acesso ao id da chamada de sistema");
     self->erro_interno = true;
     return;
   }
-  console_printf("SO: chamada de sistema %d", id_chamada);
+  console_log(NIVEL_DEPURACAO, "SO: chamada de sistema %d", id_chamada);
+  RASTRO(RASTRO_CHAMADA, EV_CHAMADA, id_chamada, self->processo_corrente, 0);
   switch (id_chamada) {
     case SO_LE:
       so_chamada_le(self);
@@ -342,7 +551,7 @@ static void so_trata_irq_chamada_sistema(so_t *self)
       so_chamada_espera_proc(self);
       break;
     default:
-      console_printf("SO: chamada de sistema desconhecida (%d)", id_chamada);
+      console_log(NIVEL_ERRO, "SO: chamada de sistema desconhecida (%d)", id_chamada);
       // t1: deveria matar o processo
       self->erro_interno = true;
   }
@@ -352,32 +561,24 @@ static void so_trata_irq_chamada_sistema(so_t *self)
 // faz a leitura de um dado da entrada corrente do processo, coloca o dado no reg A
 static void so_chamada_le(so_t *self)
 {
-  // implementação com espera ocupada
-  //   T1: deveria realizar a leitura somente se a entrada estiver disponível,
-  //     senão, deveria bloquear o processo.
-  //   no caso de bloqueio do processo, a leitura (e desbloqueio) deverá
-  //     ser feita mais tarde, em tratamentos pendentes em outra interrupção,
-  //     ou diretamente em uma interrupção específica do dispositivo, se for
-  //     o caso
+  // se a entrada não estiver disponível, o programa espera (com a CPU parada)
+  //   a interrupção do teclado, que refaz a chamada
+  //   T1: deveria bloquear o processo, e executar outro enquanto isso
   // implementação lendo direto do terminal A
   //   T1: deveria usar dispositivo de entrada corrente do processo
-  for (;;) {
-    int estado;
-    if (es_le(self->es, D_TERM_A_TECLADO_OK, &estado) != ERR_OK) {
-      console_printf("SO: problema no acesso ao estado do teclado");
-      self->erro_interno = true;
-      return;
-    }
-    if (estado != 0) break;
-    // como não está saindo do SO, a unidade de controle não está executando seu laço.
-    // esta gambiarra faz pelo menos a console ser atualizada
-    // T1: com a implementação de bloqueio de processo, esta gambiarra não
-    //   deve mais existir.
-    console_tictac(self->console);
+  int estado;
+  if (es_le(self->es, D_TERM_A_TECLADO_OK, &estado) != ERR_OK) {
+    console_log(NIVEL_ERRO, "SO: problema no acesso ao estado do teclado");
+    self->erro_interno = true;
+    return;
+  }
+  if (estado == 0) {
+    so_espera_terminal(self, D_TERM_A_TECLADO);
+    return;
   }
   int dado;
   if (es_le(self->es, D_TERM_A_TECLADO, &dado) != ERR_OK) {
-    console_printf("SO: problema no acesso ao teclado");
+    console_log(NIVEL_ERRO, "SO: problema no acesso ao teclado");
     self->erro_interno = true;
     return;
   }
@@ -393,23 +594,20 @@ static void so_chamada_le(so_t *self)
 // escreve o valor do reg X na saída corrente do processo
 static void so_chamada_escr(so_t *self)
 {
-  // implementação com espera ocupada
-  //   T1: deveria bloquear o processo se dispositivo ocupado
+  // se a tela estiver ocupada, o programa espera (com a CPU parada) a
+  //   interrupção da tela, que refaz a chamada
+  //   T1: deveria bloquear o processo, e executar outro enquanto isso
   // implementação escrevendo direto do terminal A
   //   T1: deveria usar o dispositivo de saída corrente do processo
-  for (;;) {
-    int estado;
-    if (es_le(self->es, D_TERM_A_TELA_OK, &estado) != ERR_OK) {
-      console_printf("SO: problema no acesso ao estado da tela");
-      self->erro_interno = true;
-      return;
-    }
-    if (estado != 0) break;
-    // como não está saindo do SO, a unidade de controle não está executando seu laço.
-    // esta gambiarra faz pelo menos a console ser atualizada
-    // T1: não deve mais existir quando houver suporte a processos, porque o SO não poderá
-    //   executar por muito tempo, permitindo a execução do laço da unidade de controle
-    console_tictac(self->console);
+  int estado;
+  if (es_le(self->es, D_TERM_A_TELA_OK, &estado) != ERR_OK) {
+    console_log(NIVEL_ERRO, "SO: problema no acesso ao estado da tela");
+    self->erro_interno = true;
+    return;
+  }
+  if (estado == 0) {
+    so_espera_terminal(self, D_TERM_A_TELA);
+    return;
   }
   int dado;
   // está lendo o valor de X e escrevendo o de A direto onde o processador colocou/vai pegar
@@ -418,13 +616,22 @@ static void so_chamada_escr(so_t *self)
   //   do SO, quando ele verificar que esse acesso já pode ser feito.
   mem_le(self->mem, IRQ_END_X, &dado);
   if (es_escreve(self->es, D_TERM_A_TELA, dado) != ERR_OK) {
-    console_printf("SO: problema no acesso à tela");
+    console_log(NIVEL_ERRO, "SO: problema no acesso à tela");
     self->erro_interno = true;
     return;
   }
   mem_escreve(self->mem, IRQ_END_A, 0);
 }
 
+// o programa passa a esperar pelo 'dispositivo' do terminal: o estado da CPU
+//   é guardado para a chamada ser refeita na interrupção do terminal (ver
+//   so_trata_irq_terminal)
+static void so_espera_terminal(so_t *self, dispositivo_id_t dispositivo)
+{
+  mem_le_bloco(self->mem, IRQ_END_PC, self->estado_salvo, IRQ_TAM_ESTADO);
+  self->dispositivo_esperado = dispositivo;
+}
+
 // implementação da chamada se sistema SO_CRIA_PROC
 // cria um processo
 static void so_chamada_cria_proc(so_t *self)
@@ -460,7 +667,7 @@ static void so_chamada_mata_proc(so_t *self)
 {
   // T1: deveria matar um processo
   // ainda sem suporte a processos, retorna erro -1
-  console_printf("SO: SO_MATA_PROC não implementada");
+  console_log(NIVEL_ERRO, "SO: SO_MATA_PROC não implementada");
   mem_escreve(self->mem, IRQ_END_A, -1);
 }
 
@@ -470,10 +677,116 @@ static void so_chamada_espera_proc(so_t *self)
 {
   // T1: deveria bloquear o processo se for o caso (e desbloquear na morte do esperado)
   // ainda sem suporte a processos, retorna erro -1
-  console_printf("SO: SO_ESPERA_PROC não implementada");
+  console_log(NIVEL_ERRO, "SO: SO_ESPERA_PROC não implementada");
   mem_escreve(self->mem, IRQ_END_A, -1);
 }
 
+// MEMÓRIA VIRTUAL {{{1
+
+// pede ao disco a transferência entre o bloco 'bloco' e o quadro 'quadro'
+// retorna a identificação do pedido, ou 0 em caso de erro
+static int so_pede_transferencia(so_t *self, int comando, int bloco, int quadro)
+{
+  int id;
+  int endereco = quadro * mmu_tam_pagina(self->mmu);
+  if (es_escreve(self->es, D_DISCO_BLOCO, bloco) != ERR_OK
+      || es_escreve(self->es, D_DISCO_ENDERECO, endereco) != ERR_OK
+      || es_escreve(self->es, D_DISCO_COMANDO, comando) != ERR_OK
+      || es_le(self->es, D_DISCO_COMANDO, &id) != ERR_OK) {
+    console_log(NIVEL_ERRO, "SO: erro no pedido ao disco (bloco %d, quadro %d)",
+                bloco, quadro);
+    return 0;
+  }
+  return id;
+}
+
+// libera um quadro escolhido pela política de substituição
+// se a página que está no quadro foi alterada, pede ao disco para copiá-la
+//   para a memória secundária; como o disco atende os pedidos em ordem,
+//   a cópia acontece antes de o quadro receber outra página
+// retorna o quadro, ou -1 se não tiver quadro para liberar
+static int so_libera_quadro(so_t *self)
+{
+  int quadro = quadros_escolhe_vitima(self->quadros, so_agora(self));
+  if (quadro == -1) return -1;
+  int processo = quadros_processo(self->quadros, quadro);
+  int pagina = quadros_pagina(self->quadros, quadro);
+  tabpag_t *tabpag = quadros_tabpag(self->quadros, quadro);
+  // t2: com processos, o bloco é o da página no processo dono do quadro
+  bool alterada = tabpag_bit_alteracao(tabpag, pagina);
+  if (alterada) {
+    if (so_pede_transferencia(self, DISCO_CMD_ESCREVE,
+                              self->bloco_programa + pagina, quadro) == 0) {
+      return -1;
+    }
+  }
+  metricas_pagina_retirada(self->metricas, processo, alterada);
+  tabpag_invalida_pagina(tabpag, pagina);
+  quadros_libera(self->quadros, quadro);
+  so_registra_ocupacao(self);
+  return quadro;
+}
+
+static bool so_trata_falta_de_pagina(so_t *self, int end_virt)
+{
+  int pagina = end_virt / mmu_tam_pagina(self->mmu);
+  if (end_virt < 0 || pagina >= self->num_paginas_programa) return false;
+  metricas_falta_de_pagina(self->metricas, self->processo_corrente);
+  RASTRO(RASTRO_MEMORIA, EV_FALTA_PAGINA, self->processo_corrente, end_virt,
+         pagina);
+
+  int quadro = quadros_livre(self->quadros);
+  if (quadro == -1) quadro = so_libera_quadro(self);
+  if (quadro == -1) return false;
+
+  int id = so_pede_transferencia(self, DISCO_CMD_LE,
+                                 self->bloco_programa + pagina, quadro);
+  if (id == 0) return false;
+  // a página já é mapeada, mas o programa só volta a executar quando ela
+  //   chegar do disco
+  quadros_ocupa(self->quadros, quadro, self->processo_corrente,
+                self->tabpag_global, pagina, so_agora(self));
+  so_registra_ocupacao(self);
+  tabpag_define_quadro(self->tabpag_global, pagina, quadro);
+  console_log(NIVEL_DEPURACAO, "SO: falta de página %d, carregando no quadro %d",
+              pagina, quadro);
+
+  // o programa espera pelo disco
+  mem_le_bloco(self->mem, IRQ_END_PC, self->estado_salvo, IRQ_TAM_ESTADO);
+  self->pedido_esperado = id;
+  self->inicio_espera = so_agora(self);
+  return true;
+}
+
+static int so_agora(so_t *self)
+{
+  int agora;
+  if (es_le(self->es, D_RELOGIO_INSTRUCOES, &agora) != ERR_OK) return 0;
+  return agora;
+}
+
+static void so_registra_ocupacao(so_t *self)
+{
+  metricas_ocupacao(self->metricas, so_agora(self),
+                    quadros_num_ocupados(self->quadros));
+}
+
+// coloca em '*pend_sec' o endereço da memória secundária onde está o
+//   endereço virtual 'end_virt' do programa, e em '*presto' quantos endereços
+//   a partir dele estão na mesma página
+// retorna false se o endereço não pertence ao programa
+static bool so_end_na_memoria_secundaria(so_t *self, int end_virt,
+                                         int *pend_sec, int *presto)
+{
+  int tam_pagina = mmu_tam_pagina(self->mmu);
+  if (end_virt < 0 || end_virt / tam_pagina >= self->num_paginas_programa) {
+    return false;
+  }
+  *pend_sec = self->bloco_programa * tam_pagina + end_virt;
+  *presto = tam_pagina - end_virt % tam_pagina;
+  return true;
+}
+
 // CARGA DE PROGRAMA {{{1
 
 // funções auxiliares
@@ -487,11 +800,11 @@ static int so_carrega_programa_na_memoria_virtual(so_t *self,
 static int so_carrega_programa(so_t *self, processo_t processo,
                                char *nome_do_executavel)
 {
-  console_printf("SO: carga de '%s'", nome_do_executavel);
+  console_log(NIVEL_INFO, "SO: carga de '%s'", nome_do_executavel);
 
   programa_t *programa = prog_cria(nome_do_executavel);
   if (programa == NULL) {
-    console_printf("Erro na leitura do programa '%s'\n", nome_do_executavel);
+    console_log(NIVEL_ERRO, "Erro na leitura do programa '%s'\n", nome_do_executavel);
     return -1;
   }
 
@@ -511,13 +824,13 @@ static int so_carrega_programa_na_memoria_fisica(so_t *self, programa_t *program
   int end_ini = prog_end_carga(programa);
   int end_fim = end_ini + prog_tamanho(programa);
 
-  for (int end = end_ini; end < end_fim; end++) {
-    if (mem_escreve(self->mem, end, prog_dado(programa, end)) != ERR_OK) {
-      console_printf("Erro na carga da memória, endereco %d\n", end);
-      return -1;
-    }
+  if (mem_escreve_bloco(self->mem, end_ini, prog_dados(programa),
+                        prog_tamanho(programa)) != ERR_OK) {
+    console_log(NIVEL_ERRO, "Erro na carga da memória, enderecos %d-%d\n",
+                end_ini, end_fim);
+    return -1;
   }
-  console_printf("carregado na memória física, %d-%d", end_ini, end_fim);
+  console_log(NIVEL_INFO, "carregado na memória física, %d-%d", end_ini, end_fim);
   return end_ini;
 }
 
@@ -525,41 +838,42 @@ static int so_carrega_programa_na_memoria_virtual(so_t *self,
                                                   programa_t *programa,
                                                   processo_t processo)
 {
-  // t2: isto tá furado...
-  // está simplesmente lendo para o próximo quadro que nunca foi ocupado,
-  //   nem testa se tem memória disponível
-  // com memória virtual, a forma mais simples de implementar a carga de um
-  //   programa é carregá-lo para a memória secundária, e mapear todas as páginas
-  //   da tabela de páginas do processo como inválidas. Assim, as páginas serão
-  //   colocadas na memória principal por demanda. Para simplificar ainda mais, a
-  //   memória secundária pode ser alocada da forma como a principal está sendo
-  //   alocada aqui (sem reuso)
+  // o programa é carregado na memória secundária, a partir do próximo bloco
+  //   livre; nenhuma página é colocada na memória principal, a tabela de
+  //   páginas fica sem a página, e elas serão trazidas quando acontecerem
+  //   as faltas de página
+  // o endereço de carga deve estar na primeira página (é 0 para todos os
+  //   programas), o bloco inicial corresponde à página 0
   int end_virt_ini = prog_end_carga(programa);
   int end_virt_fim = end_virt_ini + prog_tamanho(programa) - 1;
-  int pagina_ini = end_virt_ini / TAM_PAGINA;
-  int pagina_fim = end_virt_fim / TAM_PAGINA;
-  int quadro_ini = self->quadro_livre;
-  // mapeia as páginas nos quadros
-  int quadro = quadro_ini;
-  for (int pagina = pagina_ini; pagina <= pagina_fim; pagina++) {
-    //tabpag_define_quadro(self->tabpag_global, pagina, quadro);
-    quadro++;
+  int tam_pagina = mmu_tam_pagina(self->mmu);
+  int num_paginas = end_virt_fim / tam_pagina + 1;
+  int bloco_ini = self->bloco_livre;
+  int end_sec_ini = bloco_ini * tam_pagina + end_virt_ini;
+  int end_sec_fim = end_sec_ini + prog_tamanho(programa) - 1;
+  if (end_virt_ini < 0 || end_virt_ini >= tam_pagina
+      || mem_escreve_bloco(self->mem_secundaria, end_sec_ini,
+                           prog_dados(programa),
+                           prog_tamanho(programa)) != ERR_OK) {
+    console_log(NIVEL_ERRO, "Erro na carga da memória secundária, end virt %d-%d\n",
+                end_virt_ini, end_virt_fim);
+    return -1;
   }
-  self->quadro_livre = quadro;
-
-  // carrega o programa na memória principal
-  int end_fis_ini = quadro_ini * TAM_PAGINA;
-  int end_fis = end_fis_ini;
-  for (int end_virt = end_virt_ini; end_virt <= end_virt_fim; end_virt++) {
-    if (mem_escreve(self->mem, end_fis, prog_dado(programa, end_virt)) != ERR_OK) {
-      console_printf("Erro na carga da memória, end virt %d fís %d\n", end_virt,
-                     end_fis);
-      return -1;
-    }
-    end_fis++;
+  self->bloco_livre += num_paginas;
+
+  // ainda não tem processos, o programa anterior é descartado, junto com os
+  //   quadros que ele ocupa
+  // t2: com processos, isso é feito na morte do processo
+  if (self->processo_corrente != NENHUM_PROCESSO) {
+    quadros_libera_processo(self->quadros, self->processo_corrente);
+    so_registra_ocupacao(self);
   }
-  console_printf("carregado na memória virtual V%d-%d F%d-%d",
-                 end_virt_ini, end_virt_fim, end_fis_ini, end_fis - 1);
+  self->processo_corrente = processo;
+  self->bloco_programa = bloco_ini;
+  self->num_paginas_programa = num_paginas;
+
+  console_log(NIVEL_INFO, "carregado na memória secundária V%d-%d S%d-%d",
+              end_virt_ini, end_virt_fim, end_sec_ini, end_sec_fim);
   return end_virt_ini;
 }
 
@@ -575,19 +889,41 @@ static bool so_copia_str_do_processo(so_t *self, int tam, char str[tam],
                                      int end_virt, processo_t processo)
 {
   if (processo == NENHUM_PROCESSO) return false;
-  for (int indice_str = 0; indice_str < tam; indice_str++) {
-    int caractere;
-    // não tem memória virtual implementada, posso usar a mmu para traduzir
-    //   os endereços e acessar a memória
-    if (mmu_le(self->mmu, end_virt + indice_str, &caractere, usuario) != ERR_OK) {
+  int indice_str = 0;
+  while (indice_str < tam) {
+    // usa a mmu para traduzir os endereços; se a página não estiver na
+    //   memória principal, a cópia dela na memória secundária está atualizada
+    // t2: o acesso à memória secundária deveria esperar pelo disco
+    // lê o que falta da string até o fim da página de uma vez (a string
+    //   pode terminar antes, e a página seguinte pode nem ser válida)
+    int end_fis, resto;
+    mem_t *mem = self->mem;
+    err_t err = mmu_traduz(self->mmu, end_virt + indice_str, &end_fis, &resto,
+                           usuario);
+    if (err == ERR_PAG_AUSENTE) {
+      mem = self->mem_secundaria;
+      if (!so_end_na_memoria_secundaria(self, end_virt + indice_str,
+                                        &end_fis, &resto)) {
+        return false;
+      }
+    } else if (err != ERR_OK) {
       return false;
     }
-    if (caractere < 0 || caractere > 255) {
+    int n = tam - indice_str;
+    if (n > resto) n = resto;
+    int valores[n];
+    if (mem_le_bloco(mem, end_fis, valores, n) != ERR_OK) {
       return false;
     }
-    str[indice_str] = caractere;
-    if (caractere == 0) {
-      return true;
+    for (int i = 0; i < n; i++) {
+      int caractere = valores[i];
+      if (caractere < 0 || caractere > 255) {
+        return false;
+      }
+      str[indice_str++] = caractere;
+      if (caractere == 0) {
+        return true;
+      }
     }
   }
   // estourou o tamanho de str
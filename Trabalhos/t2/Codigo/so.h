@@ -12,12 +12,22 @@ typedef struct so_t so_t;
 #include "mmu.h"
 #include "cpu.h"
 #include "es.h"
-#include "console.h" // só para uma gambiarra
-
-so_t *so_cria(cpu_t *cpu, mem_t *mem, mmu_t *mmu,
-              es_t *es, console_t *console);
+#include "quadros.h"
+#include "console.h" // para as mensagens (console_log)
+
+// cria o SO
+// 'mem_secundaria' é a memória do disco, onde os programas são carregados
+// 'politica' é a política de substituição de páginas
+so_t *so_cria(cpu_t *cpu, mem_t *mem, mmu_t *mmu, mem_t *mem_secundaria,
+              es_t *es, console_t *console, politica_subst_t politica);
 void so_destroi(so_t *self);
 
+// retorna o número de quadros que o SO usa para as páginas dos programas,
+//   com uma memória de 'tam_mem' palavras e páginas de 'tam_pagina' palavras
+// os quadros até o que contém o endereço 99 são reservados (para o hardware
+//   e o SO); retorna 0 (ou menos) se não sobra quadro
+int so_quadros_usuario(int tam_mem, int tam_pagina);
+
 // Chamadas de sistema
 // Uma chamada de sistema é realizada colocando a identificação da
 //   chamada (um dos valores abaixo) no registrador A e executando a
@@ -26,6 +26,8 @@ struct tabpag_t {
   // o último descritor do vetor sempre contém uma página válida
   // pode ser NULL (se tam_tab == 0)
   descritor_t *tabela;
+  // incrementada a cada alteração que invalida traduções já feitas
+  int versao;
 };
 
 tabpag_t *tabpag_cria(void)
@@ -34,6 +36,7 @@ tabpag_t *tabpag_cria(void)
   assert(self != NULL);
   self->tam_tab = 0;
   self->tabela = NULL;
+  self->versao = 0;
   return self;
 }
 
@@ -56,6 +59,7 @@ void tabpag_invalida_pagina(tabpag_t *self, int pagina)
 {
   // página já é inválida -- não faz nada
   if (!tabpag__pagina_valida(self, pagina)) return;
+  self->versao++;
   // página não é a última da tabela -- marca como inválida
   if (pagina < self->tam_tab - 1) {
     self->tabela[pagina].valida = false;
@@ -96,6 +100,7 @@ void tabpag_define_quadro(tabpag_t *self, int pagina, int quadro)
 {
   assert(pagina >= 0);
   tabpag__insere_pagina(self, pagina);
+  self->versao++;
   self->tabela[pagina].quadro = quadro;
   self->tabela[pagina].valida = true;
   self->tabela[pagina].acessada = false;
@@ -135,3 +140,8 @@ err_t tabpag_traduz(tabpag_t *self, int pagina, int *pquadro)
   *pquadro = self->tabela[pagina].quadro;
   return ERR_OK;
 }
+
+int tabpag_versao(tabpag_t *self)
+{
+  return self->versao;
+}
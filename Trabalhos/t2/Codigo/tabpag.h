@@ -46,6 +46,8 @@ void tabpag_marca_bit_acesso(tabpag_t *self, int pagina, bool alteracao);
 
 // zera o bit de acesso à página; não afeta o bit de alteração
 // não faz nada se a página for inválida
+// não altera a versão da tabela: se a tabela estiver em uso por uma MMU, deve
+//   ser usada mmu_zera_bit_acesso, para que a MMU volte a marcar o bit
 void tabpag_zera_bit_acesso(tabpag_t *self, int pagina);
 
 // retorna o valor do bit de acesso à página
@@ -61,4 +63,10 @@ bool tabpag_bit_alteracao(tabpag_t *self, int pagina);
 // retorna ERR_PAG_AUSENTE (e não altera '*pquadro') se a página for inválida
 err_t tabpag_traduz(tabpag_t *self, int pagina, int *pquadro);
 
+// retorna a versão da tabela, um número que muda a cada alteração que pode
+//   invalidar uma tradução guardada fora da tabela (define_quadro,
+//   invalida_pagina)
+// usado pela MMU para saber quando esvaziar a TLB
+int tabpag_versao(tabpag_t *self);
+
 #endif // TABPAG_H
@@ -30,9 +30,21 @@
 //   saída chamando terminal_txt_entrada ou terminal_txt_saida. a console insere
 //   caracteres digitados no terminal chamando terminal_insere_char, e limpa a
 //   linha de saída com terminal_limpa_saida.
+//
+// para execuções sem operador, a entrada pode vir de um arquivo (ou pipe),
+//   com os caracteres "digitados" em um ritmo fixo, medido em tictacs (e não
+//   em tempo real), para que a execução seja reproduzível; e a saída pode ser
+//   copiada para um arquivo.
+//
+// se estiver ligado a um controlador de interrupções, o terminal pede
+//   interrupção de teclado (IRQ_TECLADO) quando chega um caractere na
+//   entrada vazia, e de tela (IRQ_TELA) quando a saída termina de rolar ou
+//   de ser limpa e volta a aceitar caracteres.
 
 #include <stdbool.h>
+#include <stdio.h>
 #include "es.h"
+#include "pic.h"
 
 typedef struct terminal_t terminal_t;
 
@@ -46,6 +58,12 @@ char *terminal_txt_entrada(terminal_t *self);
 
 // retorna a linha de saida do terminal (para uso pela console)
 char *terminal_txt_saida(terminal_t *self);
+// as duas retornam um ponteiro para dentro do terminal (não há cópia), que só
+//   vale até a próxima operação nele
+
+// retorna um número que muda sempre que a linha de entrada ou a de saída
+//   muda (para a console só redesenhar o terminal quando precisa)
+unsigned terminal_versao(terminal_t *self);
 
 // insere um novo caractere na entrada do terminal
 // (para uso pela console, para simular um caractere digitado no teclado)
@@ -54,9 +72,37 @@ void terminal_insere_char(terminal_t *self, char ch);
 // limpa a linha de saída (para uso pela console)
 void terminal_limpa_saida(terminal_t *self);
 
+// faz a entrada do terminal vir do arquivo 'arq' (que pode ser um pipe):
+//   a cada 'intervalo' tictacs, o próximo caractere do arquivo é inserido na
+//   entrada, como se tivesse sido digitado; se 'intervalo' for 0, a cada
+//   tictac são inseridos todos os caracteres que couberem
+// um caractere que não cabe na entrada (o programa não está lendo) espera a
+//   próxima vez, não é perdido; no fim do arquivo, para de inserir
+// a leitura de um pipe bloqueia a simulação até ter dado disponível
+// o terminal passa a ser o dono do arquivo, e o fecha
+void terminal_define_entrada(terminal_t *self, FILE *arq, int intervalo);
+
+// faz com que cada caractere escrito na saída do terminal seja também gravado
+//   no arquivo 'arq'
+// o terminal passa a ser o dono do arquivo, e o fecha
+void terminal_define_saida(terminal_t *self, FILE *arq);
+
+// liga o terminal ao controlador de interrupções 'pic', onde ele pede
+//   interrupções identificando-se como a origem 'origem'
+void terminal_define_pic(terminal_t *self, pic_t *pic, int origem);
+
 // esta função deve ser chamada periodicamente
 void terminal_tictac(terminal_t *self);
 
+// equivale a n chamadas a terminal_tictac
+void terminal_avanca(terminal_t *self, int n);
+
+// retorna quantos tictacs faltam até o terminal pedir interrupção (se nada
+//   mais acontecer com ele nesse tempo), ou 0 se ele não vai pedir
+// para a unidade de controle não avançar os terminais além desse ponto de
+//   uma vez (ver terminal_avanca)
+int terminal_tempo_ate_interrupcao(terminal_t *self);
+
 // Funções para implementar o protocolo de acesso a um dispositivo pelo
 //   controlador de E/S
 // Devem seguir o protocolo f_leitura_t e f_escrita_t declarados em es.h